@@ -143,6 +143,14 @@
 #define RIPPLE_DUMP_LEAKS_ON_EXIT 1
 #endif
 
+/** Config: RIPPLE_COUNT_ALLOCATIONS
+    Replaces the global operator new with one that counts allocations per
+    thread, so benchmarks can report them. Leave this off in production.
+*/
+#ifndef   RIPPLE_COUNT_ALLOCATIONS
+//#define RIPPLE_COUNT_ALLOCATIONS 1
+#endif
+
 //------------------------------------------------------------------------------
 
 // These control whether or not certain functionality gets
@@ -33,6 +33,11 @@ Workers::Workers (
         , m_activeCount (0)
         , m_pauseCount (0)
         , m_runningTaskCount (0)
+        , m_workStealing (false)
+        , m_created (nullptr)
+        , m_pendingTasks (0)
+        , m_sharedTasks (0)
+        , m_idleCount (0)
 {
     setNumberOfThreads (numberOfThreads);
 }
@@ -78,6 +83,7 @@ void Workers::setNumberOfThreads (int numberOfThreads)
                 else
                 {
                     worker = new Worker (*this, m_threadNames);
+                    m_created.store (worker);
                 }
 
                 m_everyone.push_front (worker);
@@ -113,7 +119,59 @@ void Workers::pauseAllThreadsAndWait ()
 
 void Workers::addTask ()
 {
-    m_semaphore.signal ();
+    if (! m_workStealing)
+    {
+        m_semaphore.signal ();
+        return;
+    }
+
+    Worker* const worker (getCurrentWorker ());
+
+    if (worker != nullptr)
+        ++worker->m_localTasks;
+    else
+        ++m_sharedTasks;
+
+    ++m_pendingTasks;
+
+    // Only threads that announced they are about to block need a signal,
+    // the others look for tasks before they block.
+    //
+    if (m_idleCount.load () > 0)
+        m_semaphore.signal ();
+}
+
+void Workers::setWorkStealing (bool workStealing)
+{
+    if (m_created.load () != nullptr || workStealing == m_workStealing)
+        return;
+
+    // No thread exists yet, so tasks added so far are converted
+    // between the semaphore and the shared count.
+    //
+    if (workStealing)
+    {
+        while (m_semaphore.try_wait ())
+        {
+            ++m_sharedTasks;
+            ++m_pendingTasks;
+        }
+    }
+    else
+    {
+        for (; m_sharedTasks.load () > 0; --m_sharedTasks)
+        {
+            --m_pendingTasks;
+            m_semaphore.signal ();
+        }
+    }
+
+    m_workStealing = workStealing;
+}
+
+bool Workers::isWorkStealing () const noexcept
+{
+    return m_workStealing;
 }
 
 int Workers::numberOfCurrentlyRunningTasks () const noexcept
@@ -139,10 +197,85 @@ void Workers::deleteWorkers (LockFreeStack <Worker>& stack)
     }
 }
 
+// Takes one task from the count, if it has any
+bool Workers::takeTask (std::atomic <int>& count)
+{
+    int n = count.load ();
+
+    while (n > 0)
+    {
+        if (count.compare_exchange_weak (n, n - 1))
+            return true;
+    }
+
+    return false;
+}
+
+// Claims a pending pause request
+bool Workers::tryPause ()
+{
+    int pauseCount = m_pauseCount.load ();
+
+    if (pauseCount > 0)
+    {
+        // Try to decrement
+        pauseCount = --m_pauseCount;
+
+        if (pauseCount >= 0)
+        {
+            // We got paused
+            return true;
+        }
+        else
+        {
+            // Undo our decrement
+            ++m_pauseCount;
+        }
+    }
+
+    return false;
+}
+
+// Takes a task for the worker: its own first, then a shared
+// one, and last a task owned by another worker.
+bool Workers::takeTask (Worker& worker)
+{
+    if (takeTask (worker.m_localTasks) || takeTask (m_sharedTasks))
+    {
+        --m_pendingTasks;
+        return true;
+    }
+
+    for (Worker* other = m_created.load (); other != nullptr;
+        other = other->m_nextCreated)
+    {
+        if (other != &worker && takeTask (other->m_localTasks))
+        {
+            --m_pendingTasks;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+Workers::Worker* Workers::getCurrentWorker () const
+{
+    Worker* const worker (dynamic_cast <Worker*> (
+        Thread::getCurrentThread ()));
+
+    if (worker != nullptr && worker->isOwnedBy (*this))
+        return worker;
+
+    return nullptr;
+}
+
 //------------------------------------------------------------------------------
 
 Workers::Worker::Worker (Workers& workers, String const& threadName)
     : Thread (threadName)
+    , m_localTasks (0)
+    , m_nextCreated (workers.m_created.load ())
     , m_workers (workers)
 {
     startThread ();
@@ -163,44 +296,12 @@ void Workers::Worker::run ()
         if (++m_workers.m_activeCount == 1)
             m_workers.m_allPaused.reset ();
 
-        for (;;)
-        {
-            // Acquire a task or "internal task."
-            //
-            m_workers.m_semaphore.wait ();
-
-            // See if there's a pause request. This
-            // counts as an "internal task."
-            //
-            int pauseCount = m_workers.m_pauseCount.load ();
-
-            if (pauseCount > 0)
-            {
-                // Try to decrement
-                pauseCount = --m_workers.m_pauseCount;
-
-                if (pauseCount >= 0)
-                {
-                    // We got paused
-                    break;
-                }
-                else
-                {
-                    // Undo our decrement
-                    ++m_workers.m_pauseCount;
-                }
-            }
-
-            // We couldn't pause so we must have gotten
-            // unblocked in order to process a task.
-            //
-            ++m_workers.m_runningTaskCount;
-            m_workers.m_callback.processTask ();
-            --m_workers.m_runningTaskCount;
-
-            // Put the name back in case the callback changed it
-            Thread::setCurrentThreadName (Thread::getThreadName());
-        }
+        // Process tasks until we get paused
+        //
+        if (m_workers.m_workStealing)
+            runStealing ();
+        else
+            runShared ();
 
         // Any worker that goes into the paused list must
         // guarantee that it will eventually block on its
@@ -227,6 +328,69 @@ void Workers::Worker::run ()
     }
 }
 
+void Workers::Worker::runShared ()
+{
+    for (;;)
+    {
+        // Acquire a task or "internal task."
+        //
+        m_workers.m_semaphore.wait ();
+
+        // See if there's a pause request. This
+        // counts as an "internal task."
+        //
+        if (m_workers.tryPause ())
+            break;
+
+        // We couldn't pause so we must have gotten
+        // unblocked in order to process a task.
+        //
+        ++m_workers.m_runningTaskCount;
+        m_workers.m_callback.processTask ();
+        --m_workers.m_runningTaskCount;
+
+        // Put the name back in case the callback changed it
+        Thread::setCurrentThreadName (Thread::getThreadName());
+    }
+}
+
+void Workers::Worker::runStealing ()
+{
+    for (;;)
+    {
+        // Pause requests come before tasks
+        //
+        if (m_workers.tryPause ())
+            break;
+
+        if (m_workers.takeTask (*this))
+        {
+            ++m_workers.m_runningTaskCount;
+            m_workers.m_callback.processTask ();
+            --m_workers.m_runningTaskCount;
+
+            // Put the name back in case the callback changed it
+            Thread::setCurrentThreadName (Thread::getThreadName());
+            continue;
+        }
+
+        // Announce that we are about to block, then look again so that
+        // a task or pause request added in the meantime is not missed.
+        // The semaphore is only a wakeup here, a signal with nothing
+        // to do sends us around the loop once more.
+        //
+        ++m_workers.m_idleCount;
+
+        if (m_workers.m_pendingTasks.load () <= 0 &&
+            m_workers.m_pauseCount.load () <= 0)
+        {
+            m_workers.m_semaphore.wait ();
+        }
+
+        --m_workers.m_idleCount;
+    }
+}
+
 //------------------------------------------------------------------------------
 
 class Workers_test : public unit_test::suite
@@ -251,6 +415,32 @@ public:
         std::atomic <int> count;
     };
 
+    // Each task adds more tasks from inside processTask
+    struct SpawnCallback : Workers::Callback
+    {
+        SpawnCallback (int count_, int spawn_)
+            : finished (false, count_ == 0)
+            , count (count_)
+            , spawn (spawn_)
+            , workers (nullptr)
+        {
+        }
+
+        void processTask ()
+        {
+            for (int i = 0; i < 2 && --spawn >= 0; ++i)
+                workers->addTask ();
+
+            if (--count == 0)
+                finished.signal ();
+        }
+
+        WaitableEvent finished;
+        std::atomic <int> count;
+        std::atomic <int> spawn;
+        Workers* workers;
+    };
+
     template <class T1, class T2>
     bool
     expectEquals (T1 const& t1, T2 const& t2)
@@ -258,15 +448,19 @@ public:
         return expect (t1 == t2);
     }
 
-    void testThreads (int const threadCount)
+    void testThreads (int const threadCount, bool workStealing)
     {
-        testcase ("threadCount = " + std::to_string (threadCount));
+        testcase ("threadCount = " + std::to_string (threadCount) +
+            (workStealing ? ", work stealing" : ""));
 
         TestCallback cb (threadCount);
 
         Workers w (cb, "Test", 0);
         expect (w.getNumberOfThreads () == 0);
 
+        w.setWorkStealing (workStealing);
+        expect (w.isWorkStealing () == workStealing);
+
         w.setNumberOfThreads (threadCount);
         expect (w.getNumberOfThreads () == threadCount);
 
@@ -286,14 +480,58 @@ public:
         expectEquals (count, 0);
     }
 
+    void testSpawn (int const threadCount, bool workStealing)
+    {
+        testcase ("spawn, threadCount = " + std::to_string (threadCount) +
+            (workStealing ? ", work stealing" : ""));
+
+        int const initial = 16;
+        int const spawned = 10000;
+
+        SpawnCallback cb (initial + spawned, spawned);
+
+        Workers w (cb, "Test", 0);
+        cb.workers = &w;
+
+        // Tasks added before the mode is selected are kept
+        for (int i = 0; i < initial / 2; ++i)
+            w.addTask ();
+
+        w.setWorkStealing (workStealing);
+        w.setNumberOfThreads (threadCount);
+
+        // Selecting a mode once threads exist has no effect
+        w.setWorkStealing (! workStealing);
+        expect (w.isWorkStealing () == workStealing);
+
+        for (int i = 0; i < initial / 2; ++i)
+            w.addTask ();
+
+        bool signaled = cb.finished.wait (10 * 1000);
+
+        expect (signaled, "timed out");
+
+        w.pauseAllThreadsAndWait ();
+
+        expectEquals (cb.count.load (), 0);
+        expect (w.numberOfCurrentlyRunningTasks () == 0);
+    }
+
     void run ()
     {
-        testThreads (0);
-        testThreads (1);
-        testThreads (2);
-        testThreads (4);
-        testThreads (16);
-        testThreads (64);
+        for (bool workStealing : { false, true })
+        {
+            testThreads (0, workStealing);
+            testThreads (1, workStealing);
+            testThreads (2, workStealing);
+            testThreads (4, workStealing);
+            testThreads (16, workStealing);
+            testThreads (64, workStealing);
+
+            testSpawn (1, workStealing);
+            testSpawn (4, workStealing);
+            testSpawn (16, workStealing);
+        }
     }
 };
 
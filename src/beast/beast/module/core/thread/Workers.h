@@ -97,6 +97,24 @@ public:
     */
     void addTask ();
 
+    /** Select work stealing.
+
+        In the default mode every task is handed to whichever thread wakes
+        up first on a shared semaphore. With work stealing, a task added from
+        inside Callback::processTask is owned by the calling thread, which
+        runs it next while its caches are still warm. Threads with nothing
+        left to do take shared tasks first and then steal tasks owned by
+        other threads.
+
+        This has no effect once threads have been created.
+
+        @note This function is not thread-safe.
+    */
+    void setWorkStealing (bool workStealing);
+
+    /** Returns `true` if work stealing is selected. */
+    bool isWorkStealing () const noexcept;
+
     /** Get the number of currently executing calls of Callback::processTask.
         While this function is thread-safe, the value may not stay
         accurate for very long. It's mainly for diagnostic purposes.
@@ -126,8 +144,21 @@ private:
 
         ~Worker ();
 
+        bool isOwnedBy (Workers const& workers) const
+        {
+            return &m_workers == &workers;
+        }
+
+        // Tasks added by this worker which were not yet taken
+        std::atomic <int> m_localTasks;
+
+        // Links every worker ever created, for stealing
+        Worker* m_nextCreated;
+
     private:
         void run ();
+        void runShared ();
+        void runStealing ();
 
     private:
         Workers& m_workers;
@@ -135,6 +166,11 @@ private:
 
 private:
     static void deleteWorkers (LockFreeStack <Worker>& stack);
+    static bool takeTask (std::atomic <int>& count);
+
+    bool tryPause ();
+    bool takeTask (Worker& worker);
+    Worker* getCurrentWorker () const;
 
 private:
     Callback& m_callback;
@@ -147,6 +183,13 @@ private:
     std::atomic <int> m_runningTaskCount;        // how many calls to processTask() active
     LockFreeStack <Worker> m_everyone;           // holds all created workers
     LockFreeStack <Worker, PausedTag> m_paused;  // holds just paused workers
+
+    // Work stealing
+    bool m_workStealing;                         // selected mode
+    std::atomic <Worker*> m_created;             // most recently created worker
+    std::atomic <int> m_pendingTasks;            // tasks not yet taken
+    std::atomic <int> m_sharedTasks;             // tasks not owned by a worker
+    std::atomic <int> m_idleCount;               // threads about to block
 };
 
 } // beast
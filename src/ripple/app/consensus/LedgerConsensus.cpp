@@ -42,6 +42,300 @@
 
 namespace ripple {
 
+//------------------------------------------------------------------------------
+
+/** The result of applying a transaction to a ledger. */
+enum {resultSuccess, resultFail, resultRetry};
+
+// Also marks the signature as good in the hash router
+static
+TransactionEngineParams
+transactionParams (STTx::ref txn, bool openLedger, bool retryAssured)
+{
+    TransactionEngineParams parms = openLedger ? tapOPEN_LEDGER : tapNONE;
+
+    if (retryAssured)
+    {
+        parms = static_cast<TransactionEngineParams> (parms | tapRETRY);
+    }
+
+    if (getApp().getHashRouter ().setFlag (txn->getTransactionID ()
+        , SF_SIGGOOD))
+    {
+        parms = static_cast<TransactionEngineParams>
+            (parms | tapNO_CHECK_SIGN);
+    }
+    WriteLog (lsDEBUG, LedgerConsensus) << "TXN "
+        << txn->getTransactionID ()
+        << (openLedger ? " open" : " closed")
+        << (retryAssured ? "/retry" : "/final");
+    WriteLog (lsTRACE, LedgerConsensus) << txn->getJson (0);
+
+    return parms;
+}
+
+// Returns resultSuccess, resultFail or resultRetry
+static
+int
+transactionResult (TER result, bool didApply)
+{
+    if (didApply)
+    {
+        WriteLog (lsDEBUG, LedgerConsensus)
+        << "Transaction success: " << transHuman (result);
+        return resultSuccess;
+    }
+
+    if (isTefFailure (result) || isTemMalformed (result) ||
+        isTelLocal (result))
+    {
+        // failure
+        WriteLog (lsDEBUG, LedgerConsensus)
+            << "Transaction failure: " << transHuman (result);
+        return resultFail;
+    }
+
+    WriteLog (lsDEBUG, LedgerConsensus)
+        << "Transaction retry: " << transHuman (result);
+    return resultRetry;
+}
+
+/** Apply a transaction to a ledger
+
+  @param engine       The transaction engine containing the ledger.
+  @param txn          The transaction to be applied to ledger.
+  @param openLedger   true if ledger is open
+  @param retryAssured true if the transaction should be retried on failure.
+  @return             One of resultSuccess, resultFail or resultRetry.
+*/
+static
+int
+applyTransaction (TransactionEngine& engine
+    , STTx::ref txn, bool openLedger, bool retryAssured)
+{
+    // Returns false if the transaction has need not be retried.
+    TransactionEngineParams parms = transactionParams (
+        txn, openLedger, retryAssured);
+
+    try
+    {
+        bool didApply;
+        TER result = engine.applyTransaction (*txn, parms, didApply);
+        return transactionResult (result, didApply);
+    }
+    catch (...)
+    {
+        WriteLog (lsWARNING, LedgerConsensus) << "Throws";
+        return resultFail;
+    }
+}
+
+/** Apply the first pass over a set of transactions to a closed ledger.
+
+  Each transaction first runs against the ledger as it stands, in parallel
+  on the job queue. Then they are applied in order: one whose run saw
+  nothing that an earlier transaction wrote is applied from that run, any
+  other runs again. The ledger ends up exactly as if every transaction
+  had been applied in order.
+*/
+static
+void
+applySpeculatively (SHAMap::ref set, TransactionEngine& engine,
+    Ledger::ref checkLedger, CanonicalTXSet& retriableTransactions,
+    JobQueue& jobQueue)
+{
+    std::vector <STTx::pointer> txns;
+    std::vector <TransactionEngineParams> params;
+
+    for (SHAMapItem::pointer item = set->peekFirstItem (); !!item;
+        item = set->peekNextItem (item->getTag ()))
+    {
+        if (!checkLedger->hasTransaction (item->getTag ()))
+        {
+            WriteLog (lsINFO, LedgerConsensus) <<
+                "Processing candidate transaction: " << item->getTag ();
+            try
+            {
+                SerializerIterator sit (item->peekSerializer ());
+                txns.push_back (std::make_shared<STTx>(sit));
+                params.push_back (transactionParams (txns.back (),
+                    false, true));
+            }
+            catch (...)
+            {
+                WriteLog (lsWARNING, LedgerConsensus) << "  Throws";
+            }
+        }
+    }
+
+    // Later transactions from an account depend on its first at least
+    // through the sequence number, so only the first runs ahead. Amendment
+    // and fee changes act on the server as well as the ledger.
+    std::vector <SpeculativeTx> speculative;
+    std::vector <int> index (txns.size (), -1);
+    std::set <Account> accounts;
+
+    for (std::size_t i = 0; i < txns.size (); ++i)
+    {
+        TxType const type = txns[i]->getTxnType ();
+
+        if ((type != ttAMENDMENT) && (type != ttFEE) &&
+            accounts.insert (txns[i]->getSourceAccount ().getAccountID ()).second)
+        {
+            index[i] = speculative.size ();
+            speculative.emplace_back ();
+            speculative.back ().txn = txns[i];
+            speculative.back ().params = params[i];
+        }
+    }
+
+    speculateTransactions (engine.getLedger (), speculative, jobQueue);
+    engine.trackWrites ();
+
+    std::size_t reused = 0;
+
+    for (std::size_t i = 0; i < txns.size (); ++i)
+    {
+        int result;
+
+        try
+        {
+            bool didApply;
+            TER ter;
+
+            if ((index[i] >= 0) && engine.isCurrent (speculative[index[i]]))
+            {
+                ter = engine.applySpeculation (
+                    speculative[index[i]], didApply);
+                ++reused;
+            }
+            else
+            {
+                ter = engine.applyTransaction (*txns[i], params[i], didApply);
+            }
+
+            result = transactionResult (ter, didApply);
+        }
+        catch (...)
+        {
+            WriteLog (lsWARNING, LedgerConsensus) << "Throws";
+            result = resultFail;
+        }
+
+        if (result == resultRetry)
+        {
+            // On failure, stash the failed transaction for
+            // later retry.
+            retriableTransactions.push_back (txns[i]);
+        }
+    }
+
+    WriteLog (lsDEBUG, LedgerConsensus) << "Applied " << reused <<
+        " of " << txns.size () << " transactions from speculative runs";
+}
+
+void applyTransactions (SHAMap::ref set, Ledger::ref applyLedger,
+    Ledger::ref checkLedger, CanonicalTXSet& retriableTransactions,
+    bool openLgr, JobQueue* jobQueue)
+{
+    TransactionEngine engine (applyLedger);
+
+    if (set && jobQueue && !openLgr)
+    {
+        applySpeculatively (set, engine, checkLedger,
+            retriableTransactions, *jobQueue);
+    }
+    else if (set)
+    {
+        for (SHAMapItem::pointer item = set->peekFirstItem (); !!item;
+            item = set->peekNextItem (item->getTag ()))
+        {
+            // If the checkLedger doesn't have the transaction
+            if (!checkLedger->hasTransaction (item->getTag ()))
+            {
+                // Then try to apply the transaction to applyLedger
+                WriteLog (lsINFO, LedgerConsensus) <<
+                    "Processing candidate transaction: " << item->getTag ();
+                try
+                {
+                    SerializerIterator sit (item->peekSerializer ());
+                    STTx::pointer txn
+                        = std::make_shared<STTx>(sit);
+                    if (applyTransaction (engine, txn,
+                                          openLgr, true) == resultRetry)
+                    {
+                        // On failure, stash the failed transaction for
+                        // later retry.
+                        retriableTransactions.push_back (txn);
+                    }
+                }
+                catch (...)
+                {
+                    WriteLog (lsWARNING, LedgerConsensus) << "  Throws";
+                }
+            }
+        }
+    }
+
+    int changes;
+    bool certainRetry = true;
+    // Attempt to apply all of the retriable transactions
+    for (int pass = 0; pass < LEDGER_TOTAL_PASSES; ++pass)
+    {
+        WriteLog (lsDEBUG, LedgerConsensus) << "Pass: " << pass << " Txns: "
+            << retriableTransactions.size ()
+            << (certainRetry ? " retriable" : " final");
+        changes = 0;
+
+        auto it = retriableTransactions.begin ();
+
+        while (it != retriableTransactions.end ())
+        {
+            try
+            {
+                switch (applyTransaction (engine, it->second,
+                        openLgr, certainRetry))
+                {
+                case resultSuccess:
+                    it = retriableTransactions.erase (it);
+                    ++changes;
+                    break;
+
+                case resultFail:
+                    it = retriableTransactions.erase (it);
+                    break;
+
+                case resultRetry:
+                    ++it;
+                }
+            }
+            catch (...)
+            {
+                WriteLog (lsWARNING, LedgerConsensus)
+                    << "Transaction throws";
+                it = retriableTransactions.erase (it);
+            }
+        }
+
+        WriteLog (lsDEBUG, LedgerConsensus) << "Pass: "
+            << pass << " finished " << changes << " changes";
+
+        // A non-retry pass made no changes
+        if (!changes && !certainRetry)
+            return;
+
+        // Stop retriable passes
+        if ((!changes) || (pass >= LEDGER_RETRY_PASSES))
+            certainRetry = false;
+    }
+
+    // If there are any transactions left, we must have
+    // tried them in at least one final pass
+    assert (retriableTransactions.empty() || !certainRetry);
+}
+
+//------------------------------------------------------------------------------
+
 /**
   Provides the implementation for LedgerConsensus.
 
@@ -61,11 +355,6 @@ class LedgerConsensusImp
     , public CountedObject <LedgerConsensusImp>
 {
 public:
-    /**
-     * The result of applying a transaction to a ledger.
-    */
-    enum {resultSuccess, resultFail, resultRetry};
-
     static char const* getCountedObjectName () { return "LedgerConsensus"; }
 
     LedgerConsensusImp(LedgerConsensusImp const&) = delete;
@@ -1049,14 +1338,18 @@ private:
             WriteLog (lsDEBUG, LedgerConsensus)
                 << "Applying consensus set transactions to the"
                 << " last closed ledger";
-            applyTransactions (set, newLCL, newLCL, retriableTransactions, false);
+            applyTransactions (set, newLCL, newLCL, retriableTransactions,
+                false, getConfig ().PARALLEL_APPLY ?
+                    &getApp().getJobQueue () : nullptr);
             newLCL->updateSkipList ();
             newLCL->setClosed ();
 
             int asf = newLCL->peekAccountStateMap ()->flushDirty (
-                hotACCOUNT_NODE, newLCL->getLedgerSeq());
+                hotACCOUNT_NODE, newLCL->getLedgerSeq(),
+                    &getApp().getJobQueue ());
             int tmf = newLCL->peekTransactionMap ()->flushDirty (
-                hotTRANSACTION_NODE, newLCL->getLedgerSeq());
+                hotTRANSACTION_NODE, newLCL->getLedgerSeq(),
+                    &getApp().getJobQueue ());
             WriteLog (lsDEBUG, LedgerConsensus) << "Flushed " << asf << " account and " <<
                 tmf << "transaction nodes";
 
@@ -1451,174 +1744,6 @@ private:
                 msg, protocol::mtHAVE_SET)));
     }
 
-    /** Apply a set of transactions to a ledger
-
-      @param set                   The set of transactions to apply
-      @param applyLedger           The ledger to which the transactions should
-                                   be applied.
-      @param checkLedger           A reference ledger for determining error
-                                   messages (typically new last closed ledger).
-      @param retriableTransactions collect failed transactions in this set
-      @param openLgr               true if applyLedger is open, else false.
-    */
-    void applyTransactions (SHAMap::ref set, Ledger::ref applyLedger,
-        Ledger::ref checkLedger, CanonicalTXSet& retriableTransactions,
-        bool openLgr)
-    {
-        TransactionEngine engine (applyLedger);
-
-        if (set)
-        {
-            for (SHAMapItem::pointer item = set->peekFirstItem (); !!item;
-                item = set->peekNextItem (item->getTag ()))
-            {
-                // If the checkLedger doesn't have the transaction
-                if (!checkLedger->hasTransaction (item->getTag ()))
-                {
-                    // Then try to apply the transaction to applyLedger
-                    WriteLog (lsINFO, LedgerConsensus) <<
-                        "Processing candidate transaction: " << item->getTag ();
-                    try
-                    {
-                        SerializerIterator sit (item->peekSerializer ());
-                        STTx::pointer txn
-                            = std::make_shared<STTx>(sit);
-                        if (applyTransaction (engine, txn,
-                                              openLgr, true) == resultRetry)
-                        {
-                            // On failure, stash the failed transaction for
-                            // later retry.
-                            retriableTransactions.push_back (txn);
-                        }
-                    }
-                    catch (...)
-                    {
-                        WriteLog (lsWARNING, LedgerConsensus) << "  Throws";
-                    }
-                }
-            }
-        }
-
-        int changes;
-        bool certainRetry = true;
-        // Attempt to apply all of the retriable transactions
-        for (int pass = 0; pass < LEDGER_TOTAL_PASSES; ++pass)
-        {
-            WriteLog (lsDEBUG, LedgerConsensus) << "Pass: " << pass << " Txns: "
-                << retriableTransactions.size ()
-                << (certainRetry ? " retriable" : " final");
-            changes = 0;
-
-            auto it = retriableTransactions.begin ();
-
-            while (it != retriableTransactions.end ())
-            {
-                try
-                {
-                    switch (applyTransaction (engine, it->second,
-                            openLgr, certainRetry))
-                    {
-                    case resultSuccess:
-                        it = retriableTransactions.erase (it);
-                        ++changes;
-                        break;
-
-                    case resultFail:
-                        it = retriableTransactions.erase (it);
-                        break;
-
-                    case resultRetry:
-                        ++it;
-                    }
-                }
-                catch (...)
-                {
-                    WriteLog (lsWARNING, LedgerConsensus)
-                        << "Transaction throws";
-                    it = retriableTransactions.erase (it);
-                }
-            }
-
-            WriteLog (lsDEBUG, LedgerConsensus) << "Pass: "
-                << pass << " finished " << changes << " changes";
-
-            // A non-retry pass made no changes
-            if (!changes && !certainRetry)
-                return;
-
-            // Stop retriable passes
-            if ((!changes) || (pass >= LEDGER_RETRY_PASSES))
-                certainRetry = false;
-        }
-
-        // If there are any transactions left, we must have
-        // tried them in at least one final pass
-        assert (retriableTransactions.empty() || !certainRetry);
-    }
-
-    /** Apply a transaction to a ledger
-
-      @param engine       The transaction engine containing the ledger.
-      @param txn          The transaction to be applied to ledger.
-      @param openLedger   true if ledger is open
-      @param retryAssured true if the transaction should be retried on failure.
-      @return             One of resultSuccess, resultFail or resultRetry.
-    */
-    int applyTransaction (TransactionEngine& engine
-        , STTx::ref txn, bool openLedger, bool retryAssured)
-    {
-        // Returns false if the transaction has need not be retried.
-        TransactionEngineParams parms = openLedger ? tapOPEN_LEDGER : tapNONE;
-
-        if (retryAssured)
-        {
-            parms = static_cast<TransactionEngineParams> (parms | tapRETRY);
-        }
-
-        if (getApp().getHashRouter ().setFlag (txn->getTransactionID ()
-            , SF_SIGGOOD))
-        {
-            parms = static_cast<TransactionEngineParams>
-                (parms | tapNO_CHECK_SIGN);
-        }
-        WriteLog (lsDEBUG, LedgerConsensus) << "TXN "
-            << txn->getTransactionID ()
-            << (openLedger ? " open" : " closed")
-            << (retryAssured ? "/retry" : "/final");
-        WriteLog (lsTRACE, LedgerConsensus) << txn->getJson (0);
-
-        try
-        {
-            bool didApply;
-            TER result = engine.applyTransaction (*txn, parms, didApply);
-
-            if (didApply)
-            {
-                WriteLog (lsDEBUG, LedgerConsensus)
-                << "Transaction success: " << transHuman (result);
-                return resultSuccess;
-            }
-
-            if (isTefFailure (result) || isTemMalformed (result) ||
-                isTelLocal (result))
-            {
-                // failure
-                WriteLog (lsDEBUG, LedgerConsensus)
-                    << "Transaction failure: " << transHuman (result);
-                return resultFail;
-            }
-
-            WriteLog (lsDEBUG, LedgerConsensus)
-                << "Transaction retry: " << transHuman (result);
-            return resultRetry;
-        }
-        catch (...)
-        {
-            WriteLog (lsWARNING, LedgerConsensus) << "Throws";
-            return resultFail;
-        }
-    }
-
     /**
       Round the close time to the close time resolution.
 
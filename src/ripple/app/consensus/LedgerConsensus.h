@@ -22,8 +22,10 @@
 
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/ledger/LedgerProposal.h>
+#include <ripple/app/misc/CanonicalTXSet.h>
 #include <ripple/app/misc/FeeVote.h>
 #include <ripple/app/tx/LocalTxs.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/json/json_value.h>
 #include <ripple/overlay/Peer.h>
 #include <ripple/types/RippleLedgerHash.h>
@@ -95,6 +97,25 @@ make_LedgerConsensus (LedgerConsensus::clock_type& clock, LocalTxs& localtx,
     LedgerHash const & prevLCLHash, Ledger::ref previousLedger,
         std::uint32_t closeTime, FeeVote& feeVote);
 
+/** Apply a set of transactions to a ledger
+
+  @param set                   The set of transactions to apply, or null.
+  @param applyLedger           The ledger to which the transactions should
+                               be applied.
+  @param checkLedger           Transactions already in this ledger are
+                               skipped.
+  @param retriableTransactions Transactions to retry, on return those which
+                               could not be applied.
+  @param openLgr               true if applyLedger is open, else false.
+  @param jobQueue              If not null and applyLedger is closed, the
+                               first pass runs the set's transactions in
+                               parallel on the job queue. The result is
+                               the same either way.
+*/
+void applyTransactions (SHAMap::ref set, Ledger::ref applyLedger,
+    Ledger::ref checkLedger, CanonicalTXSet& retriableTransactions,
+    bool openLgr, JobQueue* jobQueue = nullptr);
+
 } // ripple
 
 #endif
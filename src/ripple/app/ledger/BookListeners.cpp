@@ -33,7 +33,7 @@ void BookListeners::removeSubscriber (std::uint64_t seq)
 
 void BookListeners::publish (Json::Value const& jvObj)
 {
-    std::string sObj = to_string (jvObj);
+    InfoSub::Broadcast const message (jvObj);
 
     ScopedLockType sl (mLock);
     NetworkOPs::SubMapType::const_iterator it = mListeners.begin ();
@@ -44,7 +44,7 @@ void BookListeners::publish (Json::Value const& jvObj)
 
         if (p)
         {
-            p->send (jvObj, sObj, true);
+            p->send (message);
             ++it;
         }
         else
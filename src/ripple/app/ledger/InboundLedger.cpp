@@ -38,6 +38,12 @@ enum
 
     // how many timeouts before we get aggressive
     ,ledgerBecomeAggressiveThreshold = 6
+
+    // how many nodes to ask for in each request
+    ,nodesPerRequest = 128
+
+    // least time to wait for a peer to answer a request
+    ,requestTimeoutMinMillis = 250
 };
 
 InboundLedger::InboundLedger (uint256 const& hash, std::uint32_t seq, fcReason reason,
@@ -52,8 +58,10 @@ InboundLedger::InboundLedger (uint256 const& hash, std::uint32_t seq, fcReason r
     , mByHash (true)
     , mSeq (seq)
     , mReason (reason)
+    , mNodesReceived (0)
     , mReceiveDispatched (false)
 {
+    mStart = m_clock.now ();
 
     if (m_journal.trace) m_journal.trace <<
         "Acquiring ledger " << mHash;
@@ -140,7 +148,8 @@ bool InboundLedger::tryLocal ()
         else
         {
             mLedger = std::make_shared<Ledger> (
-                strCopy (node->getData ()), true);
+                std::string (node->getData ().begin (),
+                    node->getData ().end ()), true);
         }
 
         if (mLedger->getHash () != mHash)
@@ -560,15 +569,16 @@ void InboundLedger::trigger (Peer::ptr const& peer)
         {
             std::vector<SHAMapNodeID> nodeIDs;
             std::vector<uint256> nodeHashes;
-            // VFALCO Why 256? Make this a constant
-            nodeIDs.reserve (256);
-            nodeHashes.reserve (256);
+            int const wanted = nodesWanted ();
+            int const max = std::max (wanted, 2 * int (nodesPerRequest));
+            nodeIDs.reserve (max);
+            nodeHashes.reserve (max);
             AccountStateSF filter (mSeq);
 
             // Release the lock while we process the large state map
             sl.unlock();
             mLedger->peekAccountStateMap ()->getMissingNodes (
-                nodeIDs, nodeHashes, 256, &filter);
+                nodeIDs, nodeHashes, max, &filter);
             sl.lock();
 
             // Make sure nothing happened while we released the lock
@@ -588,25 +598,19 @@ void InboundLedger::trigger (Peer::ptr const& peer)
                 }
                 else
                 {
-                    // VFALCO Why 128? Make this a constant
                     if (!mAggressive)
                         filterNodes (nodeIDs, nodeHashes, mRecentASNodes,
-                            128, !isProgress ());
+                            wanted, !isProgress ());
 
                     if (!nodeIDs.empty ())
                     {
                         tmGL.set_itype (protocol::liAS_NODE);
-                        BOOST_FOREACH (SHAMapNodeID const& it, nodeIDs)
-                        {
-                            * (tmGL.add_nodeids ()) = it.getRawString ();
-                        }
                         if (m_journal.trace) m_journal.trace <<
                             "Sending AS node " << nodeIDs.size () <<
-                                " request to " << (
-                                    peer ? "selected peer" : "all peers");
+                                " requests";
                         if (nodeIDs.size () == 1 && m_journal.trace) m_journal.trace <<
                             "AS node: " << nodeIDs[0];
-                        sendRequest (tmGL, peer);
+                        sendNodeRequests (tmGL, nodeIDs, mRecentASNodes);
                         return;
                     }
                     else
@@ -640,11 +644,13 @@ void InboundLedger::trigger (Peer::ptr const& peer)
         {
             std::vector<SHAMapNodeID> nodeIDs;
             std::vector<uint256> nodeHashes;
-            nodeIDs.reserve (256);
-            nodeHashes.reserve (256);
+            int const wanted = nodesWanted ();
+            int const max = std::max (wanted, 2 * int (nodesPerRequest));
+            nodeIDs.reserve (max);
+            nodeHashes.reserve (max);
             TransactionStateSF filter (mSeq);
             mLedger->peekTransactionMap ()->getMissingNodes (
-                nodeIDs, nodeHashes, 256, &filter);
+                nodeIDs, nodeHashes, max, &filter);
 
             if (nodeIDs.empty ())
             {
@@ -662,20 +668,15 @@ void InboundLedger::trigger (Peer::ptr const& peer)
             {
                 if (!mAggressive)
                     filterNodes (nodeIDs, nodeHashes, mRecentTXNodes,
-                        128, !isProgress ());
+                        wanted, !isProgress ());
 
                 if (!nodeIDs.empty ())
                 {
                     tmGL.set_itype (protocol::liTX_NODE);
-                    BOOST_FOREACH (SHAMapNodeID const& it, nodeIDs)
-                    {
-                        * (tmGL.add_nodeids ()) = it.getRawString ();
-                    }
                     if (m_journal.trace) m_journal.trace <<
                         "Sending TX node " << nodeIDs.size () <<
-                        " request to " << (
-                            peer ? "selected peer" : "all peers");
-                    sendRequest (tmGL, peer);
+                        " requests";
+                    sendNodeRequests (tmGL, nodeIDs, mRecentTXNodes);
                     return;
                 }
                 else
@@ -696,6 +697,135 @@ void InboundLedger::trigger (Peer::ptr const& peer)
     }
 }
 
+/** Return how many nodes the peers have room to be asked for
+    Call with a lock
+*/
+int InboundLedger::nodesWanted ()
+{
+    auto const now = m_clock.now ();
+    int requests = 0;
+
+    for (auto const& p : mPeers)
+    {
+        if (!getApp().overlay ().findPeerByShortID (p.first))
+            continue;
+
+        PeerWindow& window = mWindows[p.first];
+        expireRequests (window, now);
+        requests += std::max (0,
+            window.size - static_cast<int> (window.sent.size ()));
+    }
+
+    return requests * nodesPerRequest;
+}
+
+/** Ask the peers for nodes, as many as their windows allow
+    Requests are given to the peers in turn so they are spread over the
+    set. Nodes there is no room for are taken out of recentNodes so they
+    are asked for later.
+    Call with a lock
+*/
+void InboundLedger::sendNodeRequests (protocol::TMGetLedger& tmGL,
+    std::vector<SHAMapNodeID> const& nodeIDs,
+    std::set<SHAMapNodeID>& recentNodes)
+{
+    auto const now = m_clock.now ();
+    auto next = nodeIDs.begin ();
+    int requests = 0;
+    bool sent = true;
+
+    while (sent && (next != nodeIDs.end ()))
+    {
+        sent = false;
+
+        for (auto const& p : mPeers)
+        {
+            if (next == nodeIDs.end ())
+                break;
+
+            PeerWindow& window = mWindows[p.first];
+
+            if (static_cast<int> (window.sent.size ()) >= window.size)
+                continue;
+
+            Peer::ptr peer (getApp().overlay ().findPeerByShortID (p.first));
+
+            if (!peer)
+                continue;
+
+            tmGL.clear_nodeids ();
+
+            for (int i = 0; (i < nodesPerRequest) && (next != nodeIDs.end ());
+                    ++i, ++next)
+                *tmGL.add_nodeids () = next->getRawString ();
+
+            peer->send (std::make_shared<Message> (
+                tmGL, protocol::mtGET_LEDGER));
+            window.sent.push_back (now);
+            sent = true;
+            ++requests;
+        }
+    }
+
+    for (; next != nodeIDs.end (); ++next)
+        recentNodes.erase (*next);
+
+    if (m_journal.trace) m_journal.trace <<
+        "Sent " << requests << " node requests for ledger " << mHash;
+}
+
+/** Forget requests the peer is unlikely to answer
+    A request that takes much longer than the peer usually takes to answer
+    is assumed lost, and the peer's window is halved.
+    Call with a lock
+*/
+void InboundLedger::expireRequests (PeerWindow& window,
+    clock_type::time_point now)
+{
+    auto timeout = std::max <std::chrono::milliseconds> (4 * window.latency,
+        std::chrono::milliseconds (requestTimeoutMinMillis));
+    timeout = std::min <std::chrono::milliseconds> (timeout,
+        std::chrono::milliseconds (ledgerAcquireTimeoutMillis));
+
+    while (!window.sent.empty () && ((now - window.sent.front ()) > timeout))
+    {
+        window.sent.pop_front ();
+        window.size = std::max (1, window.size / 2);
+    }
+}
+
+/** Account for a peer's reply to a request for nodes
+    The peer's window grows while it sends useful nodes.
+    Call with a lock
+*/
+void InboundLedger::gotNodeReply (Peer::ptr const& peer, int useful)
+{
+    auto it = mWindows.find (peer->id ());
+
+    // Replies to requests that expired are still welcome
+    if (useful > 0)
+        mNodesReceived += useful;
+
+    if ((it == mWindows.end ()) || it->second.sent.empty ())
+        return;
+
+    PeerWindow& window = it->second;
+
+    auto const sample = std::chrono::duration_cast <std::chrono::milliseconds> (
+        m_clock.now () - window.sent.front ());
+    window.sent.pop_front ();
+
+    if (window.latency.count () == 0)
+        window.latency = sample;
+    else
+        window.latency = (7 * window.latency + sample) / 8;
+
+    if (useful <= 0)
+        window.size = std::max (1, window.size / 2);
+    else if (window.size < getConfig ().LEDGER_FETCH_WINDOW)
+        ++window.size;
+}
+
 void InboundLedger::filterNodes (std::vector<SHAMapNodeID>& nodeIDs,
     std::vector<uint256>& nodeHashes, std::set<SHAMapNodeID>& recentNodes,
     int max, bool aggressive)
@@ -845,18 +975,16 @@ bool InboundLedger::takeTxNode (const std::list<SHAMapNodeID>& nodeIDs,
             if (!san.isGood())
                 return false;
         }
-        else
-        {
-            san +=  mLedger->peekTransactionMap ()->addKnownNode (
-                *nodeIDit, *nodeDatait, &tFilter);
-            if (!san.isGood())
-                return false;
-        }
 
         ++nodeIDit;
         ++nodeDatait;
     }
 
+    san += mLedger->peekTransactionMap ()->addKnownNodes (
+        nodeIDs, data, &tFilter);
+    if (!san.isGood())
+        return false;
+
     if (!mLedger->peekTransactionMap ()->isSynching ())
     {
         mHaveTransactions = true;
@@ -916,22 +1044,20 @@ bool InboundLedger::takeAsNode (const std::list<SHAMapNodeID>& nodeIDs,
                 return false;
             }
         }
-        else
-        {
-            san += mLedger->peekAccountStateMap ()->addKnownNode (
-                *nodeIDit, *nodeDatait, &tFilter);
-            if (!san.isGood ())
-            {
-                if (m_journal.warning) m_journal.warning <<
-                    "Unable to add AS node";
-                return false;
-            }
-        }
 
         ++nodeIDit;
         ++nodeDatait;
     }
 
+    san += mLedger->peekAccountStateMap ()->addKnownNodes (
+        nodeIDs, data, &tFilter);
+    if (!san.isGood ())
+    {
+        if (m_journal.warning) m_journal.warning <<
+            "Unable to add AS node";
+        return false;
+    }
+
     if (!mLedger->peekAccountStateMap ()->isSynching ())
     {
         mHaveState = true;
@@ -1148,12 +1274,14 @@ int InboundLedger::processData (std::shared_ptr<Peer> peer,
         if (packet.type () == protocol::liTX_NODE)
         {
             takeTxNode (nodeIDs, nodeData, ret);
+            gotNodeReply (peer, ret.getGood ());
             if (m_journal.debug) m_journal.debug <<
                 "Ledger TX node stats: " << ret.get();
         }
         else
         {
             takeAsNode (nodeIDs, nodeData, ret);
+            gotNodeReply (peer, ret.getGood ());
             if (m_journal.debug) m_journal.debug <<
                 "Ledger AS node stats: " << ret.get();
         }
@@ -1230,8 +1358,23 @@ Json::Value InboundLedger::getJson (int)
         ret["failed"] = true;
 
     if (!mComplete && !mFailed)
+    {
         ret["peers"] = static_cast<int>(mPeers.size());
 
+        int inFlight = 0;
+        for (auto const& w : mWindows)
+            inFlight += static_cast<int> (w.second.sent.size ());
+        ret["in_flight"] = inFlight;
+    }
+
+    ret["nodes_received"] = static_cast<Json::UInt> (mNodesReceived);
+
+    auto const elapsed = std::chrono::duration_cast <std::chrono::milliseconds> (
+        m_clock.now () - mStart).count ();
+    if (elapsed > 0)
+        ret["nodes_per_second"] = static_cast<Json::UInt> (
+            mNodesReceived * 1000 / elapsed);
+
     ret["have_header"] = mHaveHeader;
 
     if (mHaveHeader)
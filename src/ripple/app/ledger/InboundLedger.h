@@ -21,6 +21,7 @@
 #define RIPPLE_INBOUNDLEDGER_H
 
 #include <ripple/app/peers/PeerSet.h>
+#include <deque>
 #include <set>
 
 namespace ripple {
@@ -106,6 +107,19 @@ public:
     void runData ();
 
 private:
+    // The requests for nodes outstanding to one peer
+    struct PeerWindow
+    {
+        // The most requests to keep outstanding
+        int size = 1;
+
+        // When each outstanding request was sent, oldest first
+        std::deque <clock_type::time_point> sent;
+
+        // Smoothed time the peer takes to answer a request
+        std::chrono::milliseconds latency = std::chrono::milliseconds (0);
+    };
+
     void done ();
 
     void onTimer (bool progress, ScopedLockType& peerSetLock);
@@ -132,6 +146,13 @@ private:
                      SHAMapAddNode&);
     bool takeAsRootNode (Blob const& data, SHAMapAddNode&);
 
+    int nodesWanted ();
+    void sendNodeRequests (protocol::TMGetLedger& tmGL,
+        std::vector<SHAMapNodeID> const& nodeIDs,
+        std::set<SHAMapNodeID>& recentNodes);
+    void expireRequests (PeerWindow& window, clock_type::time_point now);
+    void gotNodeReply (Peer::ptr const& peer, int useful);
+
 private:
     Ledger::pointer    mLedger;
     bool               mHaveHeader;
@@ -146,6 +167,9 @@ private:
     std::set <SHAMapNodeID> mRecentTXNodes;
     std::set <SHAMapNodeID> mRecentASNodes;
 
+    hash_map <Peer::id_t, PeerWindow> mWindows;
+    clock_type::time_point mStart;
+    std::size_t mNodesReceived;
 
     // Data we have received from peers
     PeerSet::LockType mReceivedDataLock;
@@ -255,7 +255,8 @@ public:
                     return;
 
                 SHAMapTreeNode newNode(
-                    Blob (node.nodedata().begin(), node.nodedata().end()),
+                    const_byte_view (reinterpret_cast<std::uint8_t const*> (
+                        node.nodedata().data()), node.nodedata().size()),
                     0, snfWIRE, uZero, false);
 
                 s.erase();
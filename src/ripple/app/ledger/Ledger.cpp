@@ -616,7 +616,7 @@ uint256 Ledger::getHash ()
     return mHash;
 }
 
-bool Ledger::saveValidatedLedger (bool current)
+bool Ledger::saveValidatedLedger (bool current, bool wait)
 {
     // TODO(tom): Fix this hard-coded SQL!
     WriteLog (lsTRACE, Ledger)
@@ -624,22 +624,11 @@ bool Ledger::saveValidatedLedger (bool current)
         << (current ? "" : "fromAcquire ") << getLedgerSeq ();
     static boost::format deleteLedger (
         "DELETE FROM Ledgers WHERE LedgerSeq = %u;");
-    static boost::format deleteTrans1 (
-        "DELETE FROM Transactions WHERE LedgerSeq = %u;");
-    static boost::format deleteTrans2 (
-        "DELETE FROM AccountTransactions WHERE LedgerSeq = %u;");
-    static boost::format deleteAcctTrans (
-        "DELETE FROM AccountTransactions WHERE TransID = '%s';");
     static boost::format transExists (
         "SELECT Status FROM Transactions WHERE TransID = '%s';");
     static boost::format updateTx (
         "UPDATE Transactions SET LedgerSeq = %u, Status = '%c', TxnMeta = %s "
         "WHERE TransID = '%s';");
-    static boost::format addLedger (
-        "INSERT OR REPLACE INTO Ledgers "
-        "(LedgerHash,LedgerSeq,PrevHash,TotalCoins,ClosingTime,PrevClosingTime,"
-        "CloseTimeRes,CloseFlags,AccountSetHash,TransSetHash) VALUES "
-        "('%s','%u','%s','%s','%u','%u','%d','%u','%s','%s');");
 
     if (!getAccountHash ().isNonZero ())
     {
@@ -691,80 +680,31 @@ bool Ledger::saveValidatedLedger (bool current)
             boost::str (deleteLedger % mLedgerSeq));
     }
 
+    // Ledgers saved while another is being written share its commit
+    if (wait)
     {
-        auto db = getApp().getTxnDB ().getDB ();
-        auto dbLock (getApp().getTxnDB ().lock ());
-        db->executeSQL ("BEGIN TRANSACTION;");
-
-        db->executeSQL (boost::str (deleteTrans1 % getLedgerSeq ()));
-        db->executeSQL (boost::str (deleteTrans2 % getLedgerSeq ()));
-
-        std::string const ledgerSeq (std::to_string (getLedgerSeq ()));
-
-        for (auto const& vt : aLedger->getMap ())
-        {
-            uint256 transactionID = vt.second->getTransactionID ();
-
-            getApp().getMasterTransaction ().inLedger (
-                transactionID, getLedgerSeq ());
-
-            std::string const txnId (to_string (transactionID));
-            std::string const txnSeq (std::to_string (vt.second->getTxnSeq ()));
-
-            db->executeSQL (boost::str (deleteAcctTrans % transactionID));
-
-            auto const& accts = vt.second->getAffected ();
-
-            if (!accts.empty ())
-            {
-                std::string sql ("INSERT INTO AccountTransactions "
-                                 "(TransID, Account, LedgerSeq, TxnSeq) VALUES ");
+        bool const committed =
+            getApp().getTxnDBWriter ().writeAndWait (aLedger);
+        finishSave (committed);
+        return committed;
+    }
 
-                // Try to make an educated guess on how much space we'll need
-                // for our arguments. In argument order we have:
-                // 64 + 34 + 10 + 10 = 118 + 10 extra = 128 bytes
-                sql.reserve (sql.length () + (accts.size () * 128));
+    getApp().getTxnDBWriter ().write (aLedger,
+        std::bind (&Ledger::finishSave, shared_from_this (),
+                   std::placeholders::_1));
+    return true;
+}
 
-                bool first = true;
-                for (auto const& it : accts)
-                {
-                    if (!first)
-                        sql += ", ('";
-                    else
-                    {
-                        sql += "('";
-                        first = false;
-                    }
-
-                    sql += txnId;
-                    sql += "','";
-                    sql += it.humanAccountID ();
-                    sql += "',";
-                    sql += ledgerSeq;
-                    sql += ",";
-                    sql += txnSeq;
-                    sql += ")";
-                }
-                sql += ";";
-                if (ShouldLog (lsTRACE, Ledger))
-                {
-                    WriteLog (lsTRACE, Ledger) << "ActTx: " << sql;
-                }
-                db->executeSQL (sql);
-            }
-            else
-                WriteLog (lsWARNING, Ledger)
-                    << "Transaction in ledger " << mLedgerSeq
-                    << " affects no accounts";
-
-            db->executeSQL (
-                STTx::getMetaSQLInsertReplaceHeader () +
-                vt.second->getTxn ()->getMetaSQL (
-                    getLedgerSeq (), vt.second->getEscMeta ()) + ";");
-        }
-        db->executeSQL ("COMMIT TRANSACTION;");
-    }
+/** Record the ledger once its transactions are in the database. */
+void Ledger::finishSave (bool committed)
+{
+    static boost::format addLedger (
+        "INSERT OR REPLACE INTO Ledgers "
+        "(LedgerHash,LedgerSeq,PrevHash,TotalCoins,ClosingTime,PrevClosingTime,"
+        "CloseTimeRes,CloseFlags,AccountSetHash,TransSetHash) VALUES "
+        "('%s','%u','%s','%s','%u','%u','%d','%u','%s','%s');");
 
+    if (committed)
     {
         auto sl (getApp().getLedgerDB ().lock ());
 
@@ -775,6 +715,11 @@ bool Ledger::saveValidatedLedger (bool current)
                 mParentCloseTime % mCloseResolution % mCloseFlags %
                 to_string (mAccountHash) % to_string (mTransHash)));
     }
+    else
+    {
+        WriteLog (lsWARNING, Ledger)
+            << "Transactions of ledger " << mLedgerSeq << " were not saved";
+    }
 
     {
         // Clients can now trust the database for information about this ledger
@@ -782,7 +727,6 @@ bool Ledger::saveValidatedLedger (bool current)
         StaticScopedLockType sl (sPendingSaveLock);
         sPendingSaves.erase(getLedgerSeq());
     }
-    return true;
 }
 
 #ifndef NO_SQLITE3_PREPARE
@@ -1124,22 +1068,28 @@ void Ledger::addJson (Json::Value& ret, int options)
     ret[jss::ledger] = getJson (options);
 }
 
-static void stateItemTagAppender(Json::Value& value, SHAMapItem::ref smi)
+Json::Value Ledger::getJson (int options) const
 {
-    value.append (to_string (smi->getTag ()));
-}
+    Json::Value ledger = getHeaderJson (options);
 
-static void stateItemFullAppender(Json::Value& value, SLE::ref sle)
-{
-    value.append (sle->getJson (0));
+    Json::Value txns (Json::arrayValue);
+    if (visitTransactionsJson (options,
+            [&txns](Json::Value const& tx) { txns.append (tx); }))
+        ledger[jss::transactions].swap (txns);
+
+    Json::Value state (Json::arrayValue);
+    if (visitStateJson (options,
+            [&state](Json::Value const& entry) { state.append (entry); }))
+        ledger[jss::accountState].swap (state);
+
+    return ledger;
 }
 
-Json::Value Ledger::getJson (int options) const
+Json::Value Ledger::getHeaderJson (int options) const
 {
     Json::Value ledger (Json::objectValue);
 
     bool const bFull (options & LEDGER_JSON_FULL);
-    bool const bExpand (options & LEDGER_JSON_EXPAND);
 
     // DEPRECATED
     ledger[jss::seqNum]
@@ -1183,61 +1133,83 @@ Json::Value Ledger::getJson (int options) const
         ledger[jss::closed] = false;
     }
 
-    if (mTransactionMap && (bFull || options & LEDGER_JSON_DUMP_TXRP))
-    {
-        Json::Value& txns = (ledger[jss::transactions] = Json::arrayValue);
-        SHAMapTreeNode::TNType type;
+    return ledger;
+}
 
-        for (auto item = mTransactionMap->peekFirstItem (type); item;
-             item = mTransactionMap->peekNextItem (item->getTag (), type))
+bool Ledger::visitTransactionsJson (int options,
+    std::function<void (Json::Value const&)> const& f) const
+{
+    bool const bFull (options & LEDGER_JSON_FULL);
+    bool const bExpand (options & LEDGER_JSON_EXPAND);
+
+    if (!mTransactionMap || !(bFull || options & LEDGER_JSON_DUMP_TXRP))
+        return false;
+
+    SHAMapTreeNode::TNType type;
+
+    for (auto item = mTransactionMap->peekFirstItem (type); item;
+         item = mTransactionMap->peekNextItem (item->getTag (), type))
+    {
+        if (bFull || bExpand)
         {
-            if (bFull || bExpand)
+            if (type == SHAMapTreeNode::tnTRANSACTION_NM)
             {
-                if (type == SHAMapTreeNode::tnTRANSACTION_NM)
-                {
-                    SerializerIterator sit (item->peekSerializer ());
-                    STTx txn (sit);
-                    txns.append (txn.getJson (0));
-                }
-                else if (type == SHAMapTreeNode::tnTRANSACTION_MD)
-                {
-                    SerializerIterator sit (item->peekSerializer ());
-                    Serializer sTxn (sit.getVL ());
+                SerializerIterator sit (item->peekSerializer ());
+                STTx txn (sit);
+                f (txn.getJson (0));
+            }
+            else if (type == SHAMapTreeNode::tnTRANSACTION_MD)
+            {
+                SerializerIterator sit (item->peekSerializer ());
+                Serializer sTxn (sit.getVL ());
 
-                    SerializerIterator tsit (sTxn);
-                    STTx txn (tsit);
+                SerializerIterator tsit (sTxn);
+                STTx txn (tsit);
 
-                    TransactionMetaSet meta (
-                        item->getTag (), mLedgerSeq, sit.getVL ());
-                    Json::Value txJson = txn.getJson (0);
-                    txJson[jss::metaData] = meta.getJson (0);
-                    txns.append (txJson);
-                }
-                else
-                {
-                    Json::Value error = Json::objectValue;
-                    error[to_string (item->getTag ())] = type;
-                    txns.append (error);
-                }
+                TransactionMetaSet meta (
+                    item->getTag (), mLedgerSeq, sit.getVL ());
+                Json::Value txJson = txn.getJson (0);
+                txJson[jss::metaData] = meta.getJson (0);
+                f (txJson);
+            }
+            else
+            {
+                Json::Value error = Json::objectValue;
+                error[to_string (item->getTag ())] = type;
+                f (error);
             }
-            else txns.append (to_string (item->getTag ()));
         }
-
+        else f (Json::Value (to_string (item->getTag ())));
     }
 
-    if (mAccountStateMap && (bFull || options & LEDGER_JSON_DUMP_STATE))
+    return true;
+}
+
+bool Ledger::visitStateJson (int options,
+    std::function<void (Json::Value const&)> const& f) const
+{
+    bool const bFull (options & LEDGER_JSON_FULL);
+    bool const bExpand (options & LEDGER_JSON_EXPAND);
+
+    if (!mAccountStateMap || !(bFull || options & LEDGER_JSON_DUMP_STATE))
+        return false;
+
+    if (bFull || bExpand)
     {
-        Json::Value& state = (ledger[jss::accountState] = Json::arrayValue);
-        if (bFull || bExpand)
-            visitStateItems(std::bind(stateItemFullAppender, std::ref(state),
-                                      std::placeholders::_1));
-        else
-            mAccountStateMap->visitLeaves(
-                std::bind(stateItemTagAppender, std::ref(state),
-                          std::placeholders::_1));
+        visitStateItems ([&f](SLE::ref sle)
+        {
+            f (sle->getJson (0));
+        });
+    }
+    else
+    {
+        mAccountStateMap->visitLeaves ([&f](SHAMapItem::ref smi)
+        {
+            f (Json::Value (to_string (smi->getTag ())));
+        });
     }
 
-    return ledger;
+    return true;
 }
 
 void Ledger::setAcquiring (void)
@@ -1330,7 +1302,20 @@ SLE::pointer Ledger::getSLEi (uint256 const& uId) const
 {
     uint256 hash;
 
-    SHAMapItem::pointer node = mAccountStateMap->peekItem (uId, hash);
+    // An immutable map is read without locking or copying node pointers,
+    // the ledger holding the map keeps its nodes alive.
+    SHAMapItem::pointer item;
+    SHAMapItem const* node;
+
+    if (mAccountStateMap->isImmutable ())
+    {
+        node = SHAMap::ReadView (*mAccountStateMap).peekItem (uId, hash);
+    }
+    else
+    {
+        item = mAccountStateMap->peekItem (uId, hash);
+        node = item.get ();
+    }
 
     if (!node)
         return SLE::pointer ();
@@ -1501,18 +1486,25 @@ uint256 Ledger::getLastLedgerIndex () const
 
 uint256 Ledger::getNextLedgerIndex (uint256 const& uHash) const
 {
+    if (mAccountStateMap->isImmutable ())
+    {
+        SHAMapItem const* node =
+            SHAMap::ReadView (*mAccountStateMap).peekNextItem (uHash);
+        return node ? node->getTag () : uint256 ();
+    }
+
     SHAMapItem::pointer node = mAccountStateMap->peekNextItem (uHash);
     return node ? node->getTag () : uint256 ();
 }
 
 uint256 Ledger::getNextLedgerIndex (uint256 const& uHash, uint256 const& uEnd) const
 {
-    SHAMapItem::pointer node = mAccountStateMap->peekNextItem (uHash);
+    uint256 const next = getNextLedgerIndex (uHash);
 
-    if ((!node) || (node->getTag () > uEnd))
+    if (next > uEnd)
         return uint256 ();
 
-    return node->getTag ();
+    return next;
 }
 
 uint256 Ledger::getPrevLedgerIndex (uint256 const& uHash) const
@@ -1877,7 +1869,7 @@ bool Ledger::pendSaveValidated (bool isSynchronous, bool isCurrent)
 
     if (isSynchronous)
     {
-        return saveValidatedLedger(isCurrent);
+        return saveValidatedLedger(isCurrent, true);
     }
     else if (isCurrent)
     {
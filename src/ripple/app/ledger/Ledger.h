@@ -422,6 +422,18 @@ public:
     Json::Value getJson (int options) const;
     void addJson (Json::Value&, int options);
 
+    /** Returns getJson without the transactions and state arrays. */
+    Json::Value getHeaderJson (int options) const;
+
+    /** Call a function with each element of the transactions or state
+        array of getJson in turn, without building the array.
+        Returns false if the options don't include that array.
+    */
+    bool visitTransactionsJson (int options,
+        std::function<void (Json::Value const&)> const& f) const;
+    bool visitStateJson (int options,
+        std::function<void (Json::Value const&)> const& f) const;
+
     bool walkLedger () const;
     bool assertSane () const;
 
@@ -434,9 +446,10 @@ protected:
 
     void saveValidatedLedgerAsync(Job&, bool current)
     {
-        saveValidatedLedger(current);
+        saveValidatedLedger(current, false);
     }
-    bool saveValidatedLedger (bool current);
+    bool saveValidatedLedger (bool current, bool wait);
+    void finishSave (bool committed);
 
 private:
     void initializeFees ();
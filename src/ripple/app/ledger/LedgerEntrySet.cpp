@@ -48,7 +48,7 @@ void LedgerEntrySet::clear ()
 
 LedgerEntrySet LedgerEntrySet::duplicate () const
 {
-    return LedgerEntrySet (mLedger, mEntries, mSet, mSeq + 1);
+    return LedgerEntrySet (mLedger, mEntries, mSet, mSeq + 1, mReads);
 }
 
 void LedgerEntrySet::swapWith (LedgerEntrySet& e)
@@ -58,6 +58,7 @@ void LedgerEntrySet::swapWith (LedgerEntrySet& e)
     mSet.swap (e.mSet);
     std::swap (mParams, e.mParams);
     std::swap (mSeq, e.mSeq);
+    std::swap (mReads, e.mReads);
 }
 
 // Find an entry in the set.  If it has the wrong sequence number, copy it and update the sequence number.
@@ -104,6 +105,10 @@ SLE::pointer LedgerEntrySet::entryCache (LedgerEntryType letType, uint256 const&
         if (!sleEntry)
         {
             assert (action != taaDELETE);
+
+            if (mReads)
+                mReads->keys.push_back (index);
+
             sleEntry = mImmutable ? mLedger->getSLEi (index) : mLedger->getSLE (index);
 
             if (sleEntry)
@@ -989,6 +994,16 @@ bool LedgerEntrySet::dirNext (
 }
 
 uint256 LedgerEntrySet::getNextLedgerIndex (uint256 const& uHash)
+{
+    uint256 const next = findNextLedgerIndex (uHash);
+
+    if (mReads)
+        mReads->ranges.emplace_back (uHash, next);
+
+    return next;
+}
+
+uint256 LedgerEntrySet::findNextLedgerIndex (uint256 const& uHash)
 {
     // find next node in ledger that isn't deleted by LES
     uint256 ledgerNext = uHash;
@@ -1017,7 +1032,12 @@ uint256 LedgerEntrySet::getNextLedgerIndex (uint256 const& uHash)
 uint256 LedgerEntrySet::getNextLedgerIndex (
     uint256 const& uHash, uint256 const& uEnd)
 {
-    uint256 next = getNextLedgerIndex (uHash);
+    uint256 next = findNextLedgerIndex (uHash);
+
+    // Keys past uEnd cannot change the answer
+    if (mReads)
+        mReads->ranges.emplace_back (uHash,
+            (next.isZero () || next > uEnd) ? uEnd : next);
 
     if (next > uEnd)
         return uint256 ();
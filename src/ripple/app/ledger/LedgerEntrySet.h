@@ -89,6 +89,19 @@ class LedgerEntrySet
 public:
     static char const* getCountedObjectName () { return "LedgerEntrySet"; }
 
+    /** What a set and its copies looked up in the ledger.
+
+        Every key fetched from the ledger is listed, whether or not the
+        ledger held it. A scan for the next key records the range whose
+        contents decided the answer: keys above `first` up to and including
+        `second`, or without an upper bound when `second` is zero.
+    */
+    struct Reads
+    {
+        std::vector <uint256> keys;
+        std::vector <std::pair <uint256, uint256>> ranges;
+    };
+
     LedgerEntrySet (
         Ledger::ref ledger, TransactionEngineParams tep, bool immutable = false)
         : mLedger (ledger), mParams (tep), mSeq (0), mImmutable (immutable)
@@ -130,6 +143,15 @@ public:
         ++mSeq;
     }
 
+    /** Record ledger lookups in `reads`, or stop recording if null.
+
+        Copies and duplicates made afterwards record into the same object.
+    */
+    void trackReads (std::shared_ptr <Reads> const& reads)
+    {
+        mReads = reads;
+    }
+
     void init (Ledger::ref ledger, uint256 const& transactionID,
                std::uint32_t ledgerID, TransactionEngineParams params);
 
@@ -292,14 +314,18 @@ private:
     TransactionEngineParams mParams;
     int mSeq;
     bool mImmutable;
+    std::shared_ptr <Reads> mReads;
 
     LedgerEntrySet (
         Ledger::ref ledger, const std::map<uint256, LedgerEntrySetEntry>& e,
-        const TransactionMetaSet & s, int m) :
+        const TransactionMetaSet & s, int m,
+        std::shared_ptr <Reads> const& reads) :
         mLedger (ledger), mEntries (e), mSet (s), mParams (tapNONE), mSeq (m),
-        mImmutable (false)
+        mImmutable (false), mReads (reads)
     {}
 
+    uint256 findNextLedgerIndex (uint256 const& uHash);
+
     SLE::pointer getForMod (
         uint256 const& node, Ledger::ref ledger,
         NodeToLedgerEntry& newMods);
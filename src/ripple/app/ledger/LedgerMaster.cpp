@@ -382,6 +382,60 @@ public:
         return result;
     }
 
+    void doTransactions (std::vector <OpenLedgerTx>& txns)
+    {
+        Ledger::pointer ledger;
+
+        while (1)
+        {
+            ScopedLockType sl (m_mutex);
+            ledger = mCurrentLedger.getMutable ();
+
+            TransactionEngine engine (ledger);
+            bool failed = false;
+
+            for (auto& tx : txns)
+            {
+                tx.didApply = false;
+
+                if (tx.error)
+                    continue;
+
+                try
+                {
+                    tx.result = engine.applyTransaction (
+                        *tx.txn, tx.params, tx.didApply);
+                }
+                catch (...)
+                {
+                    // The ledger may hold part of this transaction, so
+                    // start over from a fresh copy without it
+                    tx.error = std::current_exception ();
+                    failed = true;
+                    break;
+                }
+            }
+
+            if (!failed)
+                break;
+        }
+
+        bool const didApply = std::any_of (txns.begin (), txns.end (),
+            [](OpenLedgerTx const& tx) { return tx.didApply; });
+
+        if (didApply)
+        {
+            mCurrentLedger.set (ledger);
+
+            for (auto const& tx : txns)
+            {
+                if (tx.didApply)
+                    getApp().getOPs ().pubProposedTransaction (
+                        ledger, tx.txn, tx.result);
+            }
+        }
+    }
+
     bool haveLedgerRange (std::uint32_t from, std::uint32_t to)
     {
         ScopedLockType sl (mCompleteLock);
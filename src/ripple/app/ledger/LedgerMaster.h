@@ -25,6 +25,8 @@
 #include <beast/insight/Collector.h>
 #include <beast/threads/Stoppable.h>
 #include <beast/threads/UnlockGuard.h>
+#include <exception>
+#include <vector>
 
 namespace ripple {
 
@@ -76,6 +78,25 @@ public:
         STTx::ref txn,
             TransactionEngineParams params, bool& didApply) = 0;
 
+    /** A transaction to apply to the open ledger, and its outcome. */
+    struct OpenLedgerTx
+    {
+        STTx::pointer txn;
+        TransactionEngineParams params;
+        TER result = temUNCERTAIN;
+        bool didApply = false;
+        std::exception_ptr error;
+    };
+
+    /** Apply transactions to the open ledger, in order.
+
+        The open ledger is copied and replaced once for the whole batch
+        instead of once per transaction. A transaction which throws gets
+        the exception in its error member; the others are applied again
+        without it, as if it had never been submitted.
+    */
+    virtual void doTransactions (std::vector <OpenLedgerTx>& txns) = 0;
+
     virtual int getMinValidations () = 0;
 
     virtual void setMinValidations (int v) = 0;
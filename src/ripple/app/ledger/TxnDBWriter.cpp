@@ -0,0 +1,243 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Log.h>
+#include <future>
+
+namespace ripple {
+
+TxnDBWriter::TxnDBWriter (DatabaseCon& db, std::size_t maxLedgers)
+    : m_db (db)
+    , m_maxLedgers (maxLedgers)
+    , m_writing (false)
+    , m_begin (db.getDB ()->getSqliteDB (), "BEGIN TRANSACTION;")
+    , m_commit (db.getDB ()->getSqliteDB (), "COMMIT TRANSACTION;")
+    , m_rollback (db.getDB ()->getSqliteDB (), "ROLLBACK TRANSACTION;")
+    , m_deleteTransactions (db.getDB ()->getSqliteDB (),
+        "DELETE FROM Transactions WHERE LedgerSeq = ?;")
+    , m_deleteLedgerAccounts (db.getDB ()->getSqliteDB (),
+        "DELETE FROM AccountTransactions WHERE LedgerSeq = ?;")
+    , m_deleteAccounts (db.getDB ()->getSqliteDB (),
+        "DELETE FROM AccountTransactions WHERE TransID = ?;")
+    , m_insertAccount (db.getDB ()->getSqliteDB (),
+        "INSERT INTO AccountTransactions "
+        "(TransID, Account, LedgerSeq, TxnSeq) VALUES (?, ?, ?, ?);")
+    , m_insertTransaction (db.getDB ()->getSqliteDB (),
+        "INSERT OR REPLACE INTO Transactions "
+        "(TransID, TransType, FromAcct, FromSeq, LedgerSeq, Status, RawTxn, "
+        "TxnMeta) VALUES (?, ?, ?, ?, ?, ?, ?, ?);")
+{
+}
+
+TxnDBWriter::~TxnDBWriter ()
+{
+    assert (! m_writing);
+}
+
+void
+TxnDBWriter::write (AcceptedLedger::pointer const& ledger, Callback callback)
+{
+    {
+        std::lock_guard <std::mutex> lock (m_mutex);
+
+        Entry entry;
+        entry.ledger = ledger;
+        entry.callback = std::move (callback);
+        m_queue.push_back (std::move (entry));
+
+        if (m_writing)
+            return;
+
+        m_writing = true;
+    }
+
+    writeQueued ();
+}
+
+bool
+TxnDBWriter::writeAndWait (AcceptedLedger::pointer const& ledger)
+{
+    std::promise <bool> committed;
+    std::future <bool> result = committed.get_future ();
+
+    write (ledger, [&committed](bool success)
+    {
+        committed.set_value (success);
+    });
+
+    return result.get ();
+}
+
+void
+TxnDBWriter::writeQueued ()
+{
+    std::vector <Entry> batch;
+
+    for (;;)
+    {
+        batch.clear ();
+
+        {
+            std::lock_guard <std::mutex> lock (m_mutex);
+
+            if (m_queue.empty ())
+            {
+                m_writing = false;
+                return;
+            }
+
+            while (! m_queue.empty () && batch.size () < m_maxLedgers)
+            {
+                batch.push_back (std::move (m_queue.front ()));
+                m_queue.pop_front ();
+            }
+        }
+
+        bool success = false;
+
+        try
+        {
+            success = writeBatch (batch);
+        }
+        catch (std::exception const& e)
+        {
+            WriteLog (lsWARNING, TxnDBWriter) <<
+                "Exception writing ledgers: " << e.what ();
+        }
+
+        for (auto const& entry : batch)
+            entry.callback (success);
+    }
+}
+
+bool
+TxnDBWriter::writeBatch (std::vector <Entry> const& batch)
+{
+    auto sl (m_db.lock ());
+
+    if (! step (m_begin))
+        return false;
+
+    for (auto const& entry : batch)
+    {
+        if (! writeLedger (*entry.ledger))
+        {
+            step (m_rollback);
+            return false;
+        }
+    }
+
+    if (! step (m_commit))
+    {
+        step (m_rollback);
+        return false;
+    }
+
+    WriteLog (lsTRACE, TxnDBWriter) <<
+        "Committed " << batch.size () << " ledgers";
+    return true;
+}
+
+bool
+TxnDBWriter::writeLedger (AcceptedLedger const& ledger)
+{
+    std::uint32_t const ledgerSeq = ledger.getLedgerSeq ();
+    std::string const status (1, TXN_SQL_VALIDATED);
+
+    m_deleteTransactions.bind (1, ledgerSeq);
+    if (! step (m_deleteTransactions))
+        return false;
+
+    m_deleteLedgerAccounts.bind (1, ledgerSeq);
+    if (! step (m_deleteLedgerAccounts))
+        return false;
+
+    for (auto const& vt : ledger.getMap ())
+    {
+        AcceptedLedgerTx const& tx = *vt.second;
+        uint256 const transactionID = tx.getTransactionID ();
+
+        getApp().getMasterTransaction ().inLedger (transactionID, ledgerSeq);
+
+        std::string const txnId (to_string (transactionID));
+
+        m_deleteAccounts.bind (1, txnId);
+        if (! step (m_deleteAccounts))
+            return false;
+
+        auto const& accounts = tx.getAffected ();
+
+        if (accounts.empty ())
+        {
+            WriteLog (lsWARNING, TxnDBWriter)
+                << "Transaction in ledger " << ledgerSeq
+                << " affects no accounts";
+        }
+
+        for (auto const& account : accounts)
+        {
+            m_insertAccount.bind (1, txnId);
+            m_insertAccount.bind (2, account.humanAccountID ());
+            m_insertAccount.bind (3, ledgerSeq);
+            m_insertAccount.bind (4, tx.getTxnSeq ());
+            if (! step (m_insertAccount))
+                return false;
+        }
+
+        STTx const& txn = *tx.getTxn ();
+        auto const format = TxFormats::getInstance ().findByType (
+            txn.getTxnType ());
+        assert (format != nullptr);
+
+        Serializer rawTxn;
+        txn.add (rawTxn);
+        Blob const& rawMeta = tx.getRawMeta ();
+        assert (! rawMeta.empty ());
+
+        // The BLOBs stay alive until the statement has stepped
+        m_insertTransaction.bind (1, txnId);
+        m_insertTransaction.bind (2, format->getName ());
+        m_insertTransaction.bind (3, txn.getSourceAccount ().humanAccountID ());
+        m_insertTransaction.bind (4, txn.getSequence ());
+        m_insertTransaction.bind (5, ledgerSeq);
+        m_insertTransaction.bindStatic (6, status);
+        m_insertTransaction.bindStatic (7, rawTxn.peekData ());
+        m_insertTransaction.bindStatic (8, rawMeta);
+        if (! step (m_insertTransaction))
+            return false;
+    }
+
+    return true;
+}
+
+bool
+TxnDBWriter::step (SqliteStatement& statement)
+{
+    int const result = statement.step ();
+    statement.reset ();
+
+    if (statement.isDone (result))
+        return true;
+
+    WriteLog (lsWARNING, TxnDBWriter) <<
+        "Transaction database error: " << statement.getError (result);
+    return false;
+}
+
+} // ripple
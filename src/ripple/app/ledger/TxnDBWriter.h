@@ -0,0 +1,92 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_TXNDBWRITER_H_INCLUDED
+#define RIPPLE_APP_TXNDBWRITER_H_INCLUDED
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace ripple {
+
+/** Writes the transactions of validated ledgers to the transaction database.
+
+    Rows are written with prepared statements that live as long as the
+    writer, and the raw transaction and metadata are bound as BLOBs instead
+    of being hex-escaped into SQL text. Ledgers which arrive while another
+    thread is writing are queued, and the writing thread commits up to
+    maxLedgers of them in each SQLite transaction.
+*/
+class TxnDBWriter
+{
+public:
+    /** Called once the ledger is committed, or with false on failure. */
+    typedef std::function <void (bool success)> Callback;
+
+    TxnDBWriter (DatabaseCon& db, std::size_t maxLedgers);
+    ~TxnDBWriter ();
+
+    /** Queue the transactions of a ledger for writing.
+
+        If no other thread is writing, the calling thread writes the queue,
+        including this ledger, before returning. Otherwise the ledger joins
+        the next batch of the writing thread and this returns at once.
+    */
+    void write (AcceptedLedger::pointer const& ledger, Callback callback);
+
+    /** Write the transactions of a ledger and wait for the commit.
+        @return true if the ledger was committed.
+    */
+    bool writeAndWait (AcceptedLedger::pointer const& ledger);
+
+private:
+    struct Entry
+    {
+        AcceptedLedger::pointer ledger;
+        Callback callback;
+    };
+
+    void writeQueued ();
+    bool writeBatch (std::vector <Entry> const& batch);
+    bool writeLedger (AcceptedLedger const& ledger);
+    bool step (SqliteStatement& statement);
+
+    DatabaseCon& m_db;
+    std::size_t const m_maxLedgers;
+
+    std::mutex m_mutex;
+    std::deque <Entry> m_queue;
+    bool m_writing;
+
+    // Only used by the writing thread while it holds the database lock
+    SqliteStatement m_begin;
+    SqliteStatement m_commit;
+    SqliteStatement m_rollback;
+    SqliteStatement m_deleteTransactions;
+    SqliteStatement m_deleteLedgerAccounts;
+    SqliteStatement m_deleteAccounts;
+    SqliteStatement m_insertAccount;
+    SqliteStatement m_insertTransaction;
+};
+
+} // ripple
+
+#endif
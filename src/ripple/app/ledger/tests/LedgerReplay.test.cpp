@@ -0,0 +1,329 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/consensus/LedgerConsensus.h>
+#include <ripple/app/data/DatabaseCon.h>
+#include <ripple/app/data/DBInit.h>
+#include <ripple/app/ledger/AcceptedLedger.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/TxnDBWriter.h>
+#include <ripple/app/misc/CanonicalTXSet.h>
+#include <ripple/app/shamap/SHAMapSyncFilter.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <beast/unit_test/suite.h>
+#include <beast/insight/NullCollector.h>
+#include <beast/threads/Stoppable.h>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace ripple {
+
+/** Replays stored ledgers to measure the cost of closing them.
+
+    The ledger before the first replayed one is loaded from a NodeStore
+    directory, then each following ledger is built again from its
+    transactions the way consensus builds it, and checked against the
+    stored ledger. The time of each phase is reported:
+
+    - apply: the transactions are applied through TransactionEngine.
+    - flush: the modified nodes of both maps are hashed and written.
+    - hash:  the ledger is accepted and its header hash is computed.
+    - save:  the transactions are written to a transaction database.
+
+    Parameters give the NodeStore backend, the hash of the last ledger to
+    replay, and how many ledgers to replay before it, for example:
+
+        type=rocksdb,path=/var/lib/rippled/db/rocksdb,hash=<hash>,count=100
+
+    'threads' sets the job queue threads used to flush, and 'parallel=1'
+    also uses them to apply the transactions.
+*/
+class LedgerReplay_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    static double
+    millis (clock_type::time_point start)
+    {
+        return std::chrono::duration <double, std::milli> (
+            clock_type::now () - start).count ();
+    }
+
+    // Supplies the nodes of the maps being loaded from the backend
+    class BackendFilter : public SHAMapSyncFilter
+    {
+    public:
+        explicit BackendFilter (NodeStore::Backend& backend)
+            : backend_ (backend)
+        {
+        }
+
+        void gotNode (bool, SHAMapNodeID const&, uint256 const&,
+            Blob&, SHAMapTreeNode::TNType) override
+        {
+        }
+
+        bool haveNode (SHAMapNodeID const&, uint256 const& nodeHash,
+            Blob& nodeData) override
+        {
+            NodeObject::Ptr object;
+            if (backend_.fetch (nodeHash.begin (), &object) != NodeStore::ok)
+                return false;
+            auto const data = object->getData ();
+            nodeData.assign (data.begin (), data.end ());
+            return true;
+        }
+
+    private:
+        NodeStore::Backend& backend_;
+    };
+
+    struct Times
+    {
+        double apply = 0;
+        double flush = 0;
+        double hash = 0;
+        double save = 0;
+        std::size_t txns = 0;
+
+        Times& operator+= (Times const& other)
+        {
+            apply += other.apply;
+            flush += other.flush;
+            hash += other.hash;
+            save += other.save;
+            txns += other.txns;
+            return *this;
+        }
+    };
+
+    Ledger::pointer
+    loadHeader (NodeStore::Backend& backend, uint256 const& hash)
+    {
+        NodeObject::Ptr object;
+        if (backend.fetch (hash.begin (), &object) != NodeStore::ok)
+            return Ledger::pointer ();
+        return std::make_shared <Ledger> (object->getData (), true);
+    }
+
+    // Brings every node of the map into memory
+    bool
+    loadMap (SHAMap& map, uint256 const& hash, SHAMapSyncFilter& filter)
+    {
+        if (hash.isNonZero ())
+        {
+            if (! map.fetchRoot (hash, &filter))
+                return false;
+
+            std::vector <SHAMapNodeID> nodeIDs;
+            std::vector <uint256> hashes;
+            map.getMissingNodes (nodeIDs, hashes, 1, &filter);
+            if (! nodeIDs.empty ())
+                return false;
+        }
+
+        map.clearSynching ();
+        return true;
+    }
+
+    // Consensus applies a set of bare transactions, a stored ledger's
+    // tree holds them with their metadata.
+    SHAMap::pointer
+    makeSet (Ledger const& ledger, std::size_t& count)
+    {
+        auto set = std::make_shared <SHAMap> (smtTRANSACTION,
+            getApp().getFullBelowCache (), getApp().getTreeNodeCache ());
+        SHAMap::ref txns = ledger.peekTransactionMap ();
+
+        for (auto it = txns->peekFirstItem (); it != nullptr;
+             it = txns->peekNextItem (it->getTag ()))
+        {
+            Serializer s;
+            ledger.getTransaction (it->getTag ())->
+                getSTransaction ()->add (s);
+            set->addItem (SHAMapItem (it->getTag (), s.peekData ()),
+                true, false);
+            ++count;
+        }
+
+        return set;
+    }
+
+    Ledger::pointer
+    close (Ledger& parent, Ledger const& stored, JobQueue& jobQueue,
+        bool parallel, TxnDBWriter& writer, Times& times)
+    {
+        SHAMap::pointer const set = makeSet (stored, times.txns);
+        auto ledger = std::make_shared <Ledger> (false, parent);
+        CanonicalTXSet retriableTransactions (set->getHash ());
+
+        auto start = clock_type::now ();
+        applyTransactions (set, ledger, ledger, retriableTransactions,
+            false, parallel ? &jobQueue : nullptr);
+        ledger->updateSkipList ();
+        ledger->setClosed ();
+        times.apply = millis (start);
+
+        start = clock_type::now ();
+        ledger->peekAccountStateMap ()->flushDirty (
+            hotACCOUNT_NODE, ledger->getLedgerSeq (), &jobQueue);
+        ledger->peekTransactionMap ()->flushDirty (
+            hotTRANSACTION_NODE, ledger->getLedgerSeq (), &jobQueue);
+        times.flush = millis (start);
+
+        start = clock_type::now ();
+        ledger->setAccepted (stored.getCloseTimeNC (),
+            stored.getCloseResolution (), stored.getCloseAgree ());
+        times.hash = millis (start);
+
+        start = clock_type::now ();
+        writer.writeAndWait (AcceptedLedger::makeAcceptedLedger (ledger));
+        times.save = millis (start);
+
+        return ledger;
+    }
+
+    void
+    report (std::string const& name, Times const& times)
+    {
+        std::stringstream ss;
+        ss << std::setprecision (2) << std::fixed;
+        ss << std::left << std::setw (10) << name <<
+            std::setw (6) << times.txns << " txns  " <<
+            "apply " << std::setw (10) << times.apply << "ms  " <<
+            "flush " << std::setw (10) << times.flush << "ms  " <<
+            "hash " << std::setw (8) << times.hash << "ms  " <<
+            "save " << std::setw (10) << times.save << "ms";
+        log << ss.str ();
+    }
+
+    void
+    replay (NodeStore::Backend& backend, uint256 hash, int count,
+        JobQueue& jobQueue, bool parallel)
+    {
+        testcase ("load");
+
+        // Walk back from the last ledger to the one the replay starts from
+        std::vector <Ledger::pointer> ledgers (count + 1);
+        for (int i = count; i >= 0; --i)
+        {
+            ledgers[i] = loadHeader (backend, hash);
+            if (! expect (ledgers[i] != nullptr, "Missing ledger header"))
+                return;
+            hash = ledgers[i]->getParentHash ();
+        }
+
+        BackendFilter filter (backend);
+
+        auto start = clock_type::now ();
+        Ledger::pointer parent = ledgers[0];
+        if (! expect (loadMap (*parent->peekAccountStateMap (),
+                parent->getAccountHash (), filter), "Missing state nodes"))
+            return;
+        parent->setClosed ();
+        parent->setImmutable ();
+        log << "Loaded the state of ledger " << parent->getLedgerSeq () <<
+            " in " << millis (start) << "ms";
+
+        for (int i = 1; i <= count; ++i)
+        {
+            if (! expect (loadMap (*ledgers[i]->peekTransactionMap (),
+                    ledgers[i]->getTransHash (), filter),
+                    "Missing transaction nodes"))
+                return;
+        }
+
+        testcase ("replay");
+
+        DatabaseCon::Setup setup;
+        setup.standAlone = true;
+        DatabaseCon db (setup, "transaction.db", TxnDBInit, TxnDBCount);
+        TxnDBWriter writer (db, 1);
+
+        Times total;
+        for (int i = 1; i <= count; ++i)
+        {
+            Ledger& stored = *ledgers[i];
+            Times times;
+
+            parent = close (*parent, stored, jobQueue, parallel, writer, times);
+
+            std::stringstream name;
+            name << stored.getLedgerSeq ();
+            report (name.str (), times);
+            total += times;
+
+            if (! expect (parent->getHash () == stored.getHash (),
+                    "Replayed ledger does not match"))
+                return;
+        }
+
+        report ("total", total);
+    }
+
+    void run ()
+    {
+        auto params = parseDelimitedKeyValueString (arg (), ',');
+
+        uint256 hash;
+        if (! expect (hash.SetHex (params["hash"].toStdString ()),
+                "Invalid or missing hash"))
+            return;
+
+        if (params["type"].isEmpty ())
+            params.set ("type", "rocksdb");
+
+        int count = 10;
+        if (! params["count"].isEmpty ())
+            count = params["count"].getIntValue ();
+
+        int threads = std::max (2u, std::thread::hardware_concurrency ());
+        if (! params["threads"].isEmpty ())
+            threads = params["threads"].getIntValue ();
+
+        bool const parallel = params["parallel"] == "1";
+
+        auto manager = NodeStore::make_Manager ();
+        NodeStore::DummyScheduler scheduler;
+        beast::Journal journal;
+        auto backend = manager->make_Backend (params, scheduler, journal);
+
+        beast::RootStoppable root ("root");
+        auto jobQueue (make_JobQueue (
+            beast::insight::NullCollector::New (), root, journal));
+        jobQueue->setThreadCount (threads, false, false);
+        root.prepare ();
+        root.start ();
+
+        replay (*backend, hash, count, *jobQueue, parallel);
+
+        root.stop (journal);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(LedgerReplay,bench,ripple);
+
+} // ripple
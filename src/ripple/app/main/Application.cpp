@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/app/consensus/LedgerConsensus.h>
 #include <ripple/app/impl/BasicApp.h>
 #include <ripple/app/main/Tuning.h>
 #include <ripple/app/misc/ProofOfWorkFactory.h>
@@ -27,6 +28,7 @@
 #include <ripple/basics/seconds_clock.h>
 #include <ripple/basics/make_SSLContext.h>
 #include <ripple/app/misc/SHAMapStore.h>
+#include <ripple/app/misc/SigVerifier.h>
 #include <ripple/core/LoadFeeTrack.h>
 #include <ripple/net/SNTPClient.h>
 #include <ripple/nodestore/Database.h>
@@ -41,7 +43,9 @@
 #include <beast/asio/io_latency_probe.h>
 #include <beast/module/core/thread/DeadlineTimer.h>
 #include <boost/asio/signal_set.hpp>
+#include <chrono>
 #include <fstream>
+#include <thread>
 
 namespace ripple {
 
@@ -187,6 +191,7 @@ public:
     std::unique_ptr <AmendmentTable> m_amendmentTable;
     std::unique_ptr <LoadFeeTrack> mFeeTrack;
     std::unique_ptr <IHashRouter> mHashRouter;
+    std::unique_ptr <SigVerifier> mSigVerifier;
     std::unique_ptr <Validations> mValidations;
     std::unique_ptr <ProofOfWorkFactory> mProofOfWorkFactory;
     std::unique_ptr <LoadManager> m_loadManager;
@@ -194,6 +199,7 @@ public:
 
     std::unique_ptr <DatabaseCon> mRpcDB;
     std::unique_ptr <DatabaseCon> mTxnDB;
+    std::unique_ptr <TxnDBWriter> m_txnDBWriter;
     std::unique_ptr <DatabaseCon> mLedgerDB;
     std::unique_ptr <DatabaseCon> mWalletDB;
     std::unique_ptr <Overlay> m_overlay;
@@ -258,10 +264,12 @@ public:
             m_logs.journal("TaggedCache"))
 
         , m_treeNodeCache ("TreeNodeCache", 65536, 60, get_seconds_clock (),
-            deprecatedLogs().journal("TaggedCache"))
+            deprecatedLogs().journal("TaggedCache"),
+                beast::insight::NullCollector::New (), defaultCachePartitions)
 
         , m_sleCache ("LedgerEntryCache", 4096, 120, get_seconds_clock (),
-            m_logs.journal("TaggedCache"))
+            m_logs.journal("TaggedCache"),
+                beast::insight::NullCollector::New (), defaultCachePartitions)
 
         , m_collectorManager (CollectorManager::New (
             getConfig().insightSettings, m_logs.journal("Collector")))
@@ -330,6 +338,12 @@ public:
 
         , mHashRouter (IHashRouter::New (IHashRouter::getDefaultHoldTime ()))
 
+        // Leaves at least two job threads for everything else
+        , mSigVerifier (make_SigVerifier (*m_jobQueue, *mHashRouter,
+            std::min (4, static_cast <int> (
+                std::thread::hardware_concurrency ())),
+            m_logs.journal("SigVerifier")))
+
         , mValidations (make_Validations ())
 
         , mProofOfWorkFactory (make_ProofOfWorkFactory ())
@@ -498,6 +512,11 @@ public:
         return *mHashRouter;
     }
 
+    SigVerifier& getSigVerifier ()
+    {
+        return *mSigVerifier;
+    }
+
     Validations& getValidations ()
     {
         return *mValidations;
@@ -543,6 +562,11 @@ public:
         assert (mTxnDB.get() != nullptr);
         return *mTxnDB;
     }
+    TxnDBWriter& getTxnDBWriter ()
+    {
+        assert (m_txnDBWriter.get() != nullptr);
+        return *m_txnDBWriter;
+    }
     DatabaseCon& getLedgerDB ()
     {
         assert (mLedgerDB.get() != nullptr);
@@ -573,6 +597,8 @@ public:
                 RpcDBCount);
         mTxnDB = std::make_unique <DatabaseCon> (setup, "transaction.db",
                 TxnDBInit, TxnDBCount);
+        m_txnDBWriter = std::make_unique <TxnDBWriter> (*mTxnDB,
+                txnDBWriterBatchLedgers);
         mLedgerDB = std::make_unique <DatabaseCon> (setup, "ledger.db",
                 LedgerDBInit, LedgerDBCount);
         mWalletDB = std::make_unique <DatabaseCon> (setup, "wallet.db",
@@ -625,7 +651,8 @@ public:
     void setup ()
     {
         // VFALCO NOTE: 0 means use heuristics to determine the thread count.
-        m_jobQueue->setThreadCount (0, getConfig ().RUN_STANDALONE);
+        m_jobQueue->setThreadCount (0, getConfig ().RUN_STANDALONE,
+            getConfig ().WORK_STEALING);
 
         m_signals.async_wait(std::bind(&ApplicationImp::signalled, this,
                                       std::placeholders::_1,
@@ -755,7 +782,8 @@ public:
         {
             if (! port.websockets())
                 continue;
-            auto door = make_WSDoor(port, *m_resourceManager, getOPs());
+            auto door = make_WSDoor(port, *m_resourceManager, getOPs(),
+                m_collectorManager->group ("ws." + port.name));
             if (door == nullptr)
             {
                 m_journal.fatal << "Could not create Websocket for [" <<
@@ -983,6 +1011,7 @@ private:
     void startNewLedger ();
     bool loadOldLedger (
         std::string const& ledgerID, bool replay, bool isFilename);
+    void checkReplay (Ledger::ref parent, Ledger::ref replayLedger);
 
     void onAnnounceAddress ();
 };
@@ -1214,6 +1243,9 @@ bool ApplicationImp::loadOldLedger (
         m_ledgerMaster->forceValid(loadLedger);
         m_networkOPs->setLastCloseTime (loadLedger->getCloseTimeNC ());
 
+        if (replay)
+            checkReplay (loadLedger, replayLedger);
+
         if (replay)
         {
             // inject transaction(s) from the replayLedger into our open ledger
@@ -1253,6 +1285,66 @@ bool ApplicationImp::loadOldLedger (
     return true;
 }
 
+// Closes the replayed ledger again from its parent, once applying the
+// transactions serially and once in parallel, and reports the times taken
+// and whether each gave the replayed ledger's state and transaction trees.
+void ApplicationImp::checkReplay (Ledger::ref parent, Ledger::ref replayLedger)
+{
+    // Consensus applies a set of bare transactions, the replayed
+    // ledger's tree holds them with their metadata.
+    auto set = std::make_shared <SHAMap> (smtTRANSACTION,
+        getFullBelowCache (), getTreeNodeCache ());
+    SHAMap::ref txns = replayLedger->peekTransactionMap ();
+    std::size_t count = 0;
+
+    for (auto it = txns->peekFirstItem (); it != nullptr;
+         it = txns->peekNextItem (it->getTag ()))
+    {
+        Serializer s;
+        replayLedger->getTransaction (it->getTag ())->
+            getSTransaction ()->add (s);
+        set->addItem (SHAMapItem (it->getTag (), s.peekData ()), true, false);
+        ++count;
+    }
+
+    auto close = [&](JobQueue* jobQueue, double& seconds)
+    {
+        auto ledger = std::make_shared <Ledger> (false, *parent);
+        CanonicalTXSet retriableTransactions (set->getHash ());
+
+        auto const start = std::chrono::steady_clock::now ();
+        applyTransactions (set, ledger, ledger, retriableTransactions,
+            false, jobQueue);
+        ledger->updateSkipList ();
+        seconds = std::chrono::duration <double> (
+            std::chrono::steady_clock::now () - start).count ();
+
+        return ledger;
+    };
+
+    double serialTime, parallelTime;
+    Ledger::pointer const serial = close (nullptr, serialTime);
+    Ledger::pointer const parallel = close (m_jobQueue.get (), parallelTime);
+
+    auto report = [&](char const* name, Ledger::ref ledger, double seconds)
+    {
+        bool const same =
+            (ledger->peekAccountStateMap ()->getHash () ==
+                replayLedger->getAccountHash ()) &&
+            (ledger->peekTransactionMap ()->getHash () ==
+                replayLedger->getTransHash ());
+
+        (same ? m_journal.info : m_journal.warning) <<
+            "Replay " << name << ": " << count <<
+            " transactions in " << seconds << "s, " <<
+            (same ? "matches" : "DOES NOT MATCH") << " ledger " <<
+            replayLedger->getLedgerSeq ();
+    };
+
+    report ("serial", serial, serialTime);
+    report ("parallel", parallel, parallelTime);
+}
+
 bool serverOkay (std::string& reason)
 {
     if (!getConfig ().ELB_SUPPORT)
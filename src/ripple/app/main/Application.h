@@ -53,8 +53,10 @@ class OrderBookDB;
 class Overlay;
 class PathRequests;
 class ProofOfWorkFactory;
+class SigVerifier;
 class STLedgerEntry;
 class TransactionMaster;
+class TxnDBWriter;
 class Validations;
 
 class DatabaseCon;
@@ -109,6 +111,7 @@ public:
     virtual LoadManager&            getLoadManager () = 0;
     virtual Overlay&                overlay () = 0;
     virtual ProofOfWorkFactory&     getProofOfWorkFactory () = 0;
+    virtual SigVerifier&            getSigVerifier () = 0;
     virtual UniqueNodeList&         getUNL () = 0;
     virtual Validations&            getValidations () = 0;
     virtual NodeStore::Database&    getNodeStore () = 0;
@@ -124,6 +127,7 @@ public:
 
     virtual DatabaseCon& getRpcDB () = 0;
     virtual DatabaseCon& getTxnDB () = 0;
+    virtual TxnDBWriter& getTxnDBWriter () = 0;
     virtual DatabaseCon& getLedgerDB () = 0;
 
     virtual std::chrono::milliseconds getIOLatency () = 0;
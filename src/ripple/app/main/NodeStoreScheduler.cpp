@@ -62,10 +62,11 @@ void NodeStoreScheduler::doTask (NodeStore::Task& task, Job&)
 
 void NodeStoreScheduler::onFetch (NodeStore::FetchReport const& report)
 {
+    // A batch counts as one event per object, sharing the elapsed time
     if (report.wentToDisk)
         m_jobQueue->addLoadEvents (
             report.isAsync ? jtNS_ASYNC_READ : jtNS_SYNC_READ,
-                1, report.elapsed);
+                report.fetchCount, report.elapsed);
 }
 
 void NodeStoreScheduler::onBatchWrite (NodeStore::BatchWriteReport const& report)
@@ -31,6 +31,12 @@ enum
     ,defaultCacheTargetSize = 0
 
     ,defaultCacheExpirationSeconds = 120
+
+    // Number of independently locked partitions in the busiest caches
+    ,defaultCachePartitions = 16
+
+    // Most validated ledgers written in one transaction database commit
+    ,txnDBWriterBatchLedgers = 16
 };
 
 }
@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/misc/AccountTxPaging.h>
+#include <boost/format.hpp>
+
+namespace ripple {
+
+std::string
+accountTxPageSQL (std::string const& selection, std::string const& account,
+    std::uint32_t minLedger, std::uint32_t maxLedger, bool forward,
+    std::uint32_t findLedger, std::uint32_t findSeq, std::uint32_t limit)
+{
+    std::string resumeClause;
+
+    if (findLedger != 0)
+    {
+        // Rows of the marker's ledger which come before the marker are
+        // excluded here; the rows of earlier ledgers never get read
+        // because the ledger range starts at the marker.
+        if (forward)
+            minLedger = findLedger;
+        else
+            maxLedger = findLedger;
+
+        resumeClause = boost::str (boost::format (
+            "AND (AccountTransactions.LedgerSeq %s %u "
+            "OR AccountTransactions.TxnSeq %s %u) ")
+                % (forward ? ">" : "<") % findLedger
+                % (forward ? ">=" : "<=") % findSeq);
+    }
+
+    char const* const order = forward ? "ASC" : "DESC";
+
+    return boost::str (boost::format
+        ("SELECT %s FROM AccountTransactions INNER JOIN Transactions "
+         "ON Transactions.TransID = AccountTransactions.TransID "
+         "WHERE AccountTransactions.Account = '%s' "
+         "AND AccountTransactions.LedgerSeq BETWEEN %u AND %u "
+         "%s"
+         "ORDER BY AccountTransactions.LedgerSeq %s, "
+         "AccountTransactions.TxnSeq %s, AccountTransactions.TransID %s "
+         "LIMIT %u;")
+            % selection
+            % account
+            % minLedger
+            % maxLedger
+            % resumeClause
+            % order % order % order
+            % limit);
+}
+
+}
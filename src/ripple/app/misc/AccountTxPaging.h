@@ -0,0 +1,47 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_ACCOUNTTXPAGING_H_INCLUDED
+#define RIPPLE_APP_ACCOUNTTXPAGING_H_INCLUDED
+
+#include <cstdint>
+#include <string>
+
+namespace ripple {
+
+/** Returns the SQL which selects one page of an account's transactions.
+
+    Rows are ordered by (LedgerSeq, TxnSeq), ascending when forward is set
+    and descending otherwise. If findLedger is not zero the page resumes at
+    the row (findLedger, findSeq), inclusive. The resume point is expressed
+    as a range on AcctTxIndex (Account, LedgerSeq, TxnSeq) so SQLite seeks
+    straight to it instead of reading and discarding the rows before it.
+
+    @param selection The columns to select.
+    @param account The human readable account ID.
+    @param limit The maximum number of rows to return.
+*/
+std::string
+accountTxPageSQL (std::string const& selection, std::string const& account,
+    std::uint32_t minLedger, std::uint32_t maxLedger, bool forward,
+    std::uint32_t findLedger, std::uint32_t findSeq, std::uint32_t limit);
+
+}
+
+#endif
@@ -18,7 +18,9 @@
 //==============================================================================
 
 #include <ripple/app/book/Quality.h>
+#include <ripple/app/misc/AccountTxPaging.h>
 #include <ripple/app/misc/FeeVote.h>
+#include <ripple/app/misc/SigVerifier.h>
 #include <ripple/basics/Time.h>
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/basics/UptimeTimer.h>
@@ -37,6 +39,10 @@
 #include <beast/module/core/system/SystemStats.h>
 #include <beast/cxx14/memory.h> // <memory>
 #include <boost/foreach.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
 #include <tuple>
 
 namespace ripple {
@@ -82,10 +88,13 @@ public:
         , mLastValidationTime (0)
         , mFetchPack ("FetchPack", 65536, 45, clock,
             deprecatedLogs().journal("TaggedCache"))
+        , mBuiltFetchPacks ("BuiltFetchPack", 128, 60, clock,
+            deprecatedLogs().journal("TaggedCache"))
         , mFetchSeq (0)
         , mLastLoadBase (256)
         , mLastLoadFactor (256)
         , m_job_queue (job_queue)
+        , mApplyingBatch (false)
         , m_standalone (standalone)
         , m_network_quorum (network_quorum)
     {
@@ -188,6 +197,7 @@ public:
     void submitTransaction (
         Job&, STTx::pointer,
         stCallback callback = stCallback ());
+    void submitVerified (STTx::pointer const&, stCallback callback);
 
     Transaction::pointer submitTransactionSync (
         Transaction::ref tpTrans,
@@ -287,6 +297,28 @@ public:
     int getFetchSize ();
     void sweepFetchPack ();
 
+private:
+    /** A fetch pack built for peers that have a particular ledger.
+
+        The pack is kept as a series of serialized messages so it can be
+        sent to every peer that asks for it. Peers that ask while the pack
+        is still being built receive each message as it is made.
+    */
+    struct BuiltFetchPack
+    {
+        std::mutex mutex;
+        std::vector <Message::pointer> messages;
+        std::vector <std::weak_ptr <Peer>> peers;
+        bool complete = false;
+    };
+
+    void buildFetchPack (BuiltFetchPack& pack, Ledger::pointer haveLedger,
+        Ledger::pointer wantLedger, uint256 const& haveLedgerHash);
+    void sendFetchPack (BuiltFetchPack& pack, Peer::ptr const& peer);
+    void addFetchPackMessage (BuiltFetchPack& pack,
+        protocol::TMGetObjectByHash& reply);
+
+public:
     // network state machine
 
     // VFALCO TODO Try to make all these private since they seem to be...private
@@ -505,6 +537,21 @@ private:
 
     std::string getHostId (bool forAdmin);
 
+    // A signature-checked transaction waiting for the open ledger
+    struct PendingTx
+    {
+        Transaction::pointer trans;
+        bool bAdmin;
+        bool bLocal;
+        bool bFailHard;
+        stCallback callback;
+        std::exception_ptr error;
+        bool done;
+    };
+
+    void applyBatch (std::vector <PendingTx*> const& batch);
+    void applyResult (PendingTx& pending, TER r, bool didApply);
+
 private:
     clock_type& m_clock;
 
@@ -565,6 +612,7 @@ private:
     SubMapType mSubRTTransactions;     // all proposed and accepted transactions
 
     TaggedCache<uint256, Blob>  mFetchPack;
+    TaggedCache<uint256, BuiltFetchPack> mBuiltFetchPacks;
     std::uint32_t mFetchSeq;
 
     std::uint32_t mLastLoadBase;
@@ -572,6 +620,13 @@ private:
 
     JobQueue& m_job_queue;
 
+    // Transactions are applied to the open ledger in batches. While one
+    // batch is applied, the transactions that arrive form the next one.
+    std::mutex mBatchMutex;
+    std::condition_variable mBatchCond;
+    std::vector <PendingTx*> mPendingTxs;
+    bool mApplyingBatch;
+
     // Whether we are in standalone mode
     bool const m_standalone;
 
@@ -861,24 +916,24 @@ void NetworkOPsImp::submitTransaction (
 
     if ((flags & SF_SIGGOOD) == 0)
     {
-        try
-        {
-            if (!passesLocalChecks (*trans) || !trans->checkSign ())
+        getApp().getSigVerifier ().verify (trans,
+            [this, callback](STTx::pointer const& trans, bool good)
             {
-                m_journal.warning << "Submitted transaction has bad signature";
-                getApp().getHashRouter ().setFlag (suppress, SF_BAD);
-                return;
-            }
-
-            getApp().getHashRouter ().setFlag (suppress, SF_SIGGOOD);
-        }
-        catch (...)
-        {
-            m_journal.warning << "Exception checking transaction " << suppress;
-            return;
-        }
+                if (good)
+                    submitVerified (trans, callback);
+                else
+                    m_journal.warning <<
+                        "Submitted transaction has bad signature";
+            });
+        return;
     }
 
+    submitVerified (trans, callback);
+}
+
+void NetworkOPsImp::submitVerified (
+    STTx::pointer const& trans, stCallback callback)
+{
     m_job_queue.addJob (jtTRANSACTION, "submitTxn",
         std::bind (&NetworkOPsImp::processTransactionCbVoid,
                    this,
@@ -957,100 +1012,180 @@ Transaction::pointer NetworkOPsImp::processTransactionCb (
         getApp().getHashRouter ().setFlag (trans->getID (), SF_SIGGOOD);
     }
 
+    PendingTx pending {trans, bAdmin, bLocal, bFailHard, callback,
+        std::exception_ptr (), false};
+
     {
-        auto lock = getApp().masterLock();
+        std::unique_lock <std::mutex> lock (mBatchMutex);
+        mPendingTxs.push_back (&pending);
+
+        while (!pending.done)
+        {
+            if (mApplyingBatch)
+            {
+                mBatchCond.wait (lock);
+                continue;
+            }
 
-        bool didApply;
-        TER r = m_ledgerMaster.doTransaction (
-            trans->getSTransaction (),
-            bAdmin ? (tapOPEN_LEDGER | tapNO_CHECK_SIGN | tapADMIN)
-            : (tapOPEN_LEDGER | tapNO_CHECK_SIGN), didApply);
-        trans->setResult (r);
+            // Apply everything that is waiting, including our transaction
+            std::vector <PendingTx*> batch;
+            batch.swap (mPendingTxs);
+            mApplyingBatch = true;
 
-        if (isTemMalformed (r)) // malformed, cache bad
-            getApp().getHashRouter ().setFlag (trans->getID (), SF_BAD);
+            lock.unlock ();
 
-#ifdef BEAST_DEBUG
-        if (r != tesSUCCESS)
-        {
-            std::string token, human;
-            if (transResultInfo (r, token, human))
-                m_journal.info << "TransactionResult: "
-                               << token << ": " << human;
+            try
+            {
+                applyBatch (batch);
+            }
+            catch (...)
+            {
+                for (auto p : batch)
+                    p->error = std::current_exception ();
+            }
+
+            lock.lock ();
+
+            for (auto p : batch)
+                p->done = true;
+
+            mApplyingBatch = false;
+            mBatchCond.notify_all ();
         }
+    }
 
-#endif
+    if (pending.error)
+        std::rethrow_exception (pending.error);
 
-        if (callback)
-            callback (trans, r);
+    return pending.trans;
+}
 
+void NetworkOPsImp::applyBatch (std::vector <PendingTx*> const& batch)
+{
+    std::vector <LedgerMaster::OpenLedgerTx> txns (batch.size ());
 
-        if (r == tefFAILURE)
-            throw Fault (IO_ERROR);
+    for (std::size_t i = 0; i < batch.size (); ++i)
+    {
+        txns[i].txn = batch[i]->trans->getSTransaction ();
+        txns[i].params = batch[i]->bAdmin
+            ? (tapOPEN_LEDGER | tapNO_CHECK_SIGN | tapADMIN)
+            : (tapOPEN_LEDGER | tapNO_CHECK_SIGN);
+    }
 
-        bool addLocal = bLocal;
+    auto lock = getApp().masterLock();
 
-        if (r == tesSUCCESS)
-        {
-            m_journal.info << "Transaction is now included in open ledger";
-            trans->setStatus (INCLUDED);
+    m_ledgerMaster.doTransactions (txns);
 
-            // VFALCO NOTE The value of trans can be changed here!
-            getApp().getMasterTransaction ().canonicalize (&trans);
-        }
-        else if (r == tefPAST_SEQ)
+    if (batch.size () > 1)
+        m_journal.debug << "Applied " << batch.size () <<
+            " transactions to the open ledger together";
+
+    for (std::size_t i = 0; i < batch.size (); ++i)
+    {
+        try
         {
-            // duplicate or conflict
-            m_journal.info << "Transaction is obsolete";
-            trans->setStatus (OBSOLETE);
+            if (txns[i].error)
+                std::rethrow_exception (txns[i].error);
+
+            applyResult (*batch[i], txns[i].result, txns[i].didApply);
         }
-        else if (isTerRetry (r))
+        catch (...)
         {
-            if (bFailHard)
-                addLocal = false;
-            else
-            {
-                // transaction should be held
-                m_journal.debug << "Transaction should be held: " << r;
-                trans->setStatus (HELD);
-                getApp().getMasterTransaction ().canonicalize (&trans);
-                m_ledgerMaster.addHeldTransaction (trans);
-            }
+            batch[i]->error = std::current_exception ();
         }
+    }
+}
+
+// Called with the master lock held
+void NetworkOPsImp::applyResult (PendingTx& pending, TER r, bool didApply)
+{
+    Transaction::pointer& trans = pending.trans;
+    bool const bLocal = pending.bLocal;
+    bool const bFailHard = pending.bFailHard;
+
+    trans->setResult (r);
+
+    if (isTemMalformed (r)) // malformed, cache bad
+        getApp().getHashRouter ().setFlag (trans->getID (), SF_BAD);
+
+#ifdef BEAST_DEBUG
+    if (r != tesSUCCESS)
+    {
+        std::string token, human;
+        if (transResultInfo (r, token, human))
+            m_journal.info << "TransactionResult: "
+                           << token << ": " << human;
+    }
+
+#endif
+
+    if (pending.callback)
+        pending.callback (trans, r);
+
+
+    if (r == tefFAILURE)
+        throw Fault (IO_ERROR);
+
+    bool addLocal = bLocal;
+
+    if (r == tesSUCCESS)
+    {
+        m_journal.info << "Transaction is now included in open ledger";
+        trans->setStatus (INCLUDED);
+
+        // VFALCO NOTE The value of trans can be changed here!
+        getApp().getMasterTransaction ().canonicalize (&trans);
+    }
+    else if (r == tefPAST_SEQ)
+    {
+        // duplicate or conflict
+        m_journal.info << "Transaction is obsolete";
+        trans->setStatus (OBSOLETE);
+    }
+    else if (isTerRetry (r))
+    {
+        if (bFailHard)
+            addLocal = false;
         else
         {
-            m_journal.debug << "Status other than success " << r;
-            trans->setStatus (INVALID);
+            // transaction should be held
+            m_journal.debug << "Transaction should be held: " << r;
+            trans->setStatus (HELD);
+            getApp().getMasterTransaction ().canonicalize (&trans);
+            m_ledgerMaster.addHeldTransaction (trans);
         }
+    }
+    else
+    {
+        m_journal.debug << "Status other than success " << r;
+        trans->setStatus (INVALID);
+    }
 
-        if (addLocal)
-        {
-            addLocalTx (m_ledgerMaster.getCurrentLedger (),
-                        trans->getSTransaction ());
-        }
+    if (addLocal)
+    {
+        addLocalTx (m_ledgerMaster.getCurrentLedger (),
+                    trans->getSTransaction ());
+    }
 
-        if (didApply || ((mMode != omFULL) && !bFailHard && bLocal))
-        {
-            std::set<Peer::id_t> peers;
+    if (didApply || ((mMode != omFULL) && !bFailHard && bLocal))
+    {
+        std::set<Peer::id_t> peers;
 
-            if (getApp().getHashRouter ().swapSet (
-                    trans->getID (), peers, SF_RELAYED))
-            {
-                protocol::TMTransaction tx;
-                Serializer s;
-                trans->getSTransaction ()->add (s);
-                tx.set_rawtransaction (&s.getData ().front (), s.getLength ());
-                tx.set_status (protocol::tsCURRENT);
-                tx.set_receivetimestamp (getNetworkTimeNC ());
-                // FIXME: This should be when we received it
-                getApp ().overlay ().foreach (send_if_not (
-                    std::make_shared<Message> (tx, protocol::mtTRANSACTION),
-                    peer_in_set(peers)));
-            }
+        if (getApp().getHashRouter ().swapSet (
+                trans->getID (), peers, SF_RELAYED))
+        {
+            protocol::TMTransaction tx;
+            Serializer s;
+            trans->getSTransaction ()->add (s);
+            tx.set_rawtransaction (&s.getData ().front (), s.getLength ());
+            tx.set_status (protocol::tsCURRENT);
+            tx.set_receivetimestamp (getNetworkTimeNC ());
+            // FIXME: This should be when we received it
+            getApp ().overlay ().foreach (send_if_not (
+                std::make_shared<Message> (tx, protocol::mtTRANSACTION),
+                peer_in_set(peers)));
         }
     }
-
-    return trans;
 }
 
 Transaction::pointer NetworkOPsImp::findTransactionByID (
@@ -1729,7 +1864,7 @@ void NetworkOPsImp::pubServer ()
         jvObj [jss::load_factor]   =
                 (mLastLoadFactor = getApp().getFeeTrack ().getLoadFactor ());
 
-        std::string sObj = to_string (jvObj);
+        InfoSub::Broadcast const message (jvObj, true);
 
 
         for (auto i = mSubServer.begin (); i != mSubServer.end (); )
@@ -1741,7 +1876,7 @@ void NetworkOPsImp::pubServer ()
             //             sending of JSON data.
             if (p)
             {
-                p->send (jvObj, sObj, true);
+                p->send (message);
                 ++i;
             }
             else
@@ -1982,21 +2117,17 @@ NetworkOPsImp::AccountTxs NetworkOPsImp::getTxsAccount (
     AccountTxs ret;
 
     std::uint32_t NONBINARY_PAGE_LENGTH = 200;
-    std::uint32_t EXTRA_LENGTH = 100;
-
-    bool foundResume = token.isNull() || !token.isObject();
 
-    std::uint32_t numberOfResults, queryLimit;
+    std::uint32_t numberOfResults;
     if (limit <= 0)
         numberOfResults = NONBINARY_PAGE_LENGTH;
     else if (!bAdmin && (limit > NONBINARY_PAGE_LENGTH))
         numberOfResults = NONBINARY_PAGE_LENGTH;
     else
         numberOfResults = limit;
-    queryLimit = numberOfResults + 1 + (foundResume ? 0 : EXTRA_LENGTH);
 
     std::uint32_t findLedger = 0, findSeq = 0;
-    if (!foundResume)
+    if (token.isObject ())
     {
         try
         {
@@ -2015,35 +2146,18 @@ NetworkOPsImp::AccountTxs NetworkOPsImp::getTxsAccount (
     //         outputs, so we need to clear it in between.
     token = Json::nullValue;
 
-    std::string sql = boost::str (boost::format
-        ("SELECT AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,"
-         "Status,RawTxn,TxnMeta "
-         "FROM AccountTransactions INNER JOIN Transactions "
-         "ON Transactions.TransID = AccountTransactions.TransID "
-         "WHERE AccountTransactions.Account = '%s' "
-         "AND AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u' "
-         "ORDER BY AccountTransactions.LedgerSeq %s, "
-         "AccountTransactions.TxnSeq %s, AccountTransactions.TransID %s "
-         "LIMIT %u;")
-             % account.humanAccountID()
-             % ((forward && (findLedger != 0)) ? findLedger : minLedger)
-             % ((!forward && (findLedger != 0)) ? findLedger: maxLedger)
-             % (forward ? "ASC" : "DESC")
-             % (forward ? "ASC" : "DESC")
-             % (forward ? "ASC" : "DESC")
-             % queryLimit);
+    std::string sql = accountTxPageSQL (
+        "AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,"
+        "Status,RawTxn,TxnMeta",
+        account.humanAccountID (), minLedger, maxLedger, forward,
+        findLedger, findSeq, numberOfResults + 1);
     {
         auto db = getApp().getTxnDB ().getDB ();
         auto sl (getApp().getTxnDB ().lock ());
 
         SQL_FOREACH (db, sql)
         {
-            if (!foundResume)
-            {
-                foundResume = (findLedger == db->getInt("LedgerSeq") &&
-                               findSeq == db->getInt("TxnSeq"));
-            }
-            else if (numberOfResults == 0)
+            if (numberOfResults == 0)
             {
                 token = Json::objectValue;
                 token[jss::ledger] = db->getInt("LedgerSeq");
@@ -2051,43 +2165,40 @@ NetworkOPsImp::AccountTxs NetworkOPsImp::getTxsAccount (
                 break;
             }
 
-            if (foundResume)
-            {
-                auto txn = Transaction::transactionFromSQL (db, Validate::NO);
+            auto txn = Transaction::transactionFromSQL (db, Validate::NO);
+
+            Serializer rawMeta;
+            int metaSize = 2048;
+            rawMeta.resize (metaSize);
+            metaSize = db->getBinary (
+                "TxnMeta", &*rawMeta.begin (), rawMeta.getLength ());
 
-                Serializer rawMeta;
-                int metaSize = 2048;
+            if (metaSize > rawMeta.getLength ())
+            {
                 rawMeta.resize (metaSize);
-                metaSize = db->getBinary (
+                db->getBinary (
                     "TxnMeta", &*rawMeta.begin (), rawMeta.getLength ());
+            }
+            else
+                rawMeta.resize (metaSize);
 
-                if (metaSize > rawMeta.getLength ())
-                {
-                    rawMeta.resize (metaSize);
-                    db->getBinary (
-                        "TxnMeta", &*rawMeta.begin (), rawMeta.getLength ());
-                }
-                else
-                    rawMeta.resize (metaSize);
-
-                if (rawMeta.getLength() == 0)
-                {
-                    // Work around a bug that could leave the metadata missing
-                    auto seq = static_cast<std::uint32_t>(
-                        db->getBigInt("LedgerSeq"));
-                    m_journal.warning << "Recovering ledger " << seq
-                                      << ", txn " << txn->getID();
-                    Ledger::pointer ledger = getLedgerBySeq(seq);
-                    if (ledger)
-                        ledger->pendSaveValidated(false, false);
-                }
+            if (rawMeta.getLength() == 0)
+            {
+                // Work around a bug that could leave the metadata missing
+                auto seq = static_cast<std::uint32_t>(
+                    db->getBigInt("LedgerSeq"));
+                m_journal.warning << "Recovering ledger " << seq
+                                  << ", txn " << txn->getID();
+                Ledger::pointer ledger = getLedgerBySeq(seq);
+                if (ledger)
+                    ledger->pendSaveValidated(false, false);
+            }
 
-                --numberOfResults;
+            --numberOfResults;
 
-                ret.emplace_back (std::move (txn),
-                    std::make_shared<TransactionMetaSet> (
-                        txn->getID (), txn->getLedger (), rawMeta.getData ()));
-            }
+            ret.emplace_back (std::move (txn),
+                std::make_shared<TransactionMetaSet> (
+                    txn->getID (), txn->getLedger (), rawMeta.getData ()));
         }
     }
 
@@ -2102,21 +2213,17 @@ NetworkOPsImp::MetaTxsList NetworkOPsImp::getTxsAccountB (
     MetaTxsList ret;
 
     std::uint32_t BINARY_PAGE_LENGTH = 500;
-    std::uint32_t EXTRA_LENGTH = 100;
-
-    bool foundResume = token.isNull() || !token.isObject();
 
-    std::uint32_t numberOfResults, queryLimit;
+    std::uint32_t numberOfResults;
     if (limit <= 0)
         numberOfResults = BINARY_PAGE_LENGTH;
     else if (!bAdmin && (limit > BINARY_PAGE_LENGTH))
         numberOfResults = BINARY_PAGE_LENGTH;
     else
         numberOfResults = limit;
-    queryLimit = numberOfResults + 1 + (foundResume ? 0 : EXTRA_LENGTH);
 
     std::uint32_t findLedger = 0, findSeq = 0;
-    if (!foundResume)
+    if (token.isObject ())
     {
         try
         {
@@ -2133,38 +2240,18 @@ NetworkOPsImp::MetaTxsList NetworkOPsImp::getTxsAccountB (
 
     token = Json::nullValue;
 
-    std::string sql = boost::str (boost::format
-        ("SELECT AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,"
-         "Status,RawTxn,TxnMeta "
-         "FROM AccountTransactions INNER JOIN Transactions "
-         "ON Transactions.TransID = AccountTransactions.TransID "
-         "WHERE AccountTransactions.Account = '%s' "
-         "AND AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u' "
-         "ORDER BY AccountTransactions.LedgerSeq %s, "
-         "AccountTransactions.TxnSeq %s, AccountTransactions.TransID %s "
-         "LIMIT %u;")
-             % account.humanAccountID()
-             % ((forward && (findLedger != 0)) ? findLedger : minLedger)
-             % ((!forward && (findLedger != 0)) ? findLedger: maxLedger)
-             % (forward ? "ASC" : "DESC")
-             % (forward ? "ASC" : "DESC")
-             % (forward ? "ASC" : "DESC")
-             % queryLimit);
+    std::string sql = accountTxPageSQL (
+        "AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,"
+        "Status,RawTxn,TxnMeta",
+        account.humanAccountID (), minLedger, maxLedger, forward,
+        findLedger, findSeq, numberOfResults + 1);
     {
         auto db = getApp().getTxnDB ().getDB ();
         auto sl (getApp().getTxnDB ().lock ());
 
         SQL_FOREACH (db, sql)
         {
-            if (!foundResume)
-            {
-                if (findLedger == db->getInt("LedgerSeq") &&
-                    findSeq == db->getInt("TxnSeq"))
-                {
-                    foundResume = true;
-                }
-            }
-            else if (numberOfResults == 0)
+            if (numberOfResults == 0)
             {
                 token = Json::objectValue;
                 token[jss::ledger] = db->getInt("LedgerSeq");
@@ -2172,40 +2259,37 @@ NetworkOPsImp::MetaTxsList NetworkOPsImp::getTxsAccountB (
                 break;
             }
 
-            if (foundResume)
-            {
-                int txnSize = 2048;
-                Blob rawTxn (txnSize);
-                txnSize = db->getBinary ("RawTxn", &rawTxn[0], rawTxn.size ());
-
-                if (txnSize > rawTxn.size ())
-                {
-                    rawTxn.resize (txnSize);
-                    db->getBinary ("RawTxn", &*rawTxn.begin (), rawTxn.size ());
-                }
-                else
-                    rawTxn.resize (txnSize);
+            int txnSize = 2048;
+            Blob rawTxn (txnSize);
+            txnSize = db->getBinary ("RawTxn", &rawTxn[0], rawTxn.size ());
 
-                int metaSize = 2048;
-                Blob rawMeta (metaSize);
-                metaSize = db->getBinary (
-                    "TxnMeta", &rawMeta[0], rawMeta.size ());
+            if (txnSize > rawTxn.size ())
+            {
+                rawTxn.resize (txnSize);
+                db->getBinary ("RawTxn", &*rawTxn.begin (), rawTxn.size ());
+            }
+            else
+                rawTxn.resize (txnSize);
 
-                if (metaSize > rawMeta.size ())
-                {
-                    rawMeta.resize (metaSize);
-                    db->getBinary (
-                        "TxnMeta", &*rawMeta.begin (), rawMeta.size ());
-                }
-                else
-                {
-                    rawMeta.resize (metaSize);
-                }
+            int metaSize = 2048;
+            Blob rawMeta (metaSize);
+            metaSize = db->getBinary (
+                "TxnMeta", &rawMeta[0], rawMeta.size ());
 
-                ret.emplace_back (strHex (rawTxn), strHex (rawMeta),
-                                  db->getInt ("LedgerSeq"));
-                --numberOfResults;
+            if (metaSize > rawMeta.size ())
+            {
+                rawMeta.resize (metaSize);
+                db->getBinary (
+                    "TxnMeta", &*rawMeta.begin (), rawMeta.size ());
             }
+            else
+            {
+                rawMeta.resize (metaSize);
+            }
+
+            ret.emplace_back (strHex (rawTxn), strHex (rawMeta),
+                              db->getInt ("LedgerSeq"));
+            --numberOfResults;
         }
     }
 
@@ -2452,6 +2536,7 @@ void NetworkOPsImp::pubProposedTransaction (
     Ledger::ref lpCurrent, STTx::ref stTxn, TER terResult)
 {
     Json::Value jvObj   = transJson (*stTxn, terResult, false, lpCurrent);
+    InfoSub::Broadcast const message (jvObj);
 
     {
         ScopedLockType sl (mLock);
@@ -2463,7 +2548,7 @@ void NetworkOPsImp::pubProposedTransaction (
 
             if (p)
             {
-                p->send (jvObj, true);
+                p->send (message);
                 ++it;
             }
             else
@@ -2512,13 +2597,15 @@ void NetworkOPsImp::pubLedger (Ledger::ref accepted)
                         = getApp().getLedgerMaster ().getCompleteLedgers ();
             }
 
+            InfoSub::Broadcast const message (jvObj, true);
+
             auto it = mSubLedger.begin ();
             while (it != mSubLedger.end ())
             {
                 InfoSub::pointer p = it->second.lock ();
                 if (p)
                 {
-                    p->send (jvObj, true);
+                    p->send (message);
                     ++it;
                 }
                 else
@@ -2607,7 +2694,7 @@ void NetworkOPsImp::pubValidatedTransaction (
         *alTx.getTxn (), alTx.getResult (), true, alAccepted);
     jvObj[jss::meta] = alTx.getMeta ()->getJson (0);
 
-    std::string sObj = to_string (jvObj);
+    InfoSub::Broadcast const message (jvObj);
 
     {
         ScopedLockType sl (mLock);
@@ -2619,7 +2706,7 @@ void NetworkOPsImp::pubValidatedTransaction (
 
             if (p)
             {
-                p->send (jvObj, sObj, true);
+                p->send (message);
                 ++it;
             }
             else
@@ -2634,7 +2721,7 @@ void NetworkOPsImp::pubValidatedTransaction (
 
             if (p)
             {
-                p->send (jvObj, sObj, true);
+                p->send (message);
                 ++it;
             }
             else
@@ -2719,11 +2806,11 @@ void NetworkOPsImp::pubAccountTransaction (
         if (alTx.isApplied ())
             jvObj[jss::meta] = alTx.getMeta ()->getJson (0);
 
-        std::string sObj = to_string (jvObj);
+        InfoSub::Broadcast const message (jvObj);
 
         BOOST_FOREACH (InfoSub::ref isrListener, notify)
         {
-            isrListener->send (jvObj, sObj, true);
+            isrListener->send (message);
         }
     }
 }
@@ -3346,6 +3433,15 @@ static void fpAppender (
     newObj.set_data (&blob[0], blob.size ());
 }
 
+// A fetch pack is sent as messages of about this many objects
+static std::size_t const fetchPackMessageObjects = 256;
+
+// Building a fetch pack stops once it has this many objects
+static std::size_t const fetchPackMaxObjects = 2048;
+
+// or once this much time has been spent building it
+static std::chrono::seconds const fetchPackMaxTime (2);
+
 void NetworkOPsImp::makeFetchPack (
     Job&, std::weak_ptr<Peer> wPeer,
     std::shared_ptr<protocol::TMGetObjectByHash> request,
@@ -3357,6 +3453,23 @@ void NetworkOPsImp::makeFetchPack (
         return;
     }
 
+    Peer::ptr peer = wPeer.lock ();
+
+    if (!peer)
+        return;
+
+    // Packs that were already built, or are being built, are cheap to
+    // send so they are served even when we are too busy to build one.
+    std::shared_ptr <BuiltFetchPack> pack =
+        mBuiltFetchPacks.fetch (haveLedgerHash);
+
+    if (pack)
+    {
+        m_journal.debug << "Sending cached fetch pack";
+        sendFetchPack (*pack, peer);
+        return;
+    }
+
     if (getApp().getFeeTrack ().isLoadedLocal () ||
         (m_ledgerMaster.getValidatedLedgerAge() > 40))
     {
@@ -3364,11 +3477,6 @@ void NetworkOPsImp::makeFetchPack (
         return;
     }
 
-    Peer::ptr peer = wPeer.lock ();
-
-    if (!peer)
-        return;
-
     Ledger::pointer haveLedger = getLedgerByHash (haveLedgerHash);
 
     if (!haveLedger)
@@ -3407,26 +3515,44 @@ void NetworkOPsImp::makeFetchPack (
         return;
     }
 
-    try
+    pack = std::make_shared <BuiltFetchPack> ();
+    pack->peers.push_back (peer);
+
+    if (mBuiltFetchPacks.canonicalize (haveLedgerHash, pack))
     {
-        protocol::TMGetObjectByHash reply;
-        reply.set_query (false);
+        // Another job started building this pack first
+        sendFetchPack (*pack, peer);
+        return;
+    }
 
-        if (request->has_seq ())
-            reply.set_seq (request->seq ());
+    buildFetchPack (*pack, std::move (haveLedger), std::move (wantLedger),
+        haveLedgerHash);
+}
 
-        reply.set_ledgerhash (request->ledgerhash ());
-        reply.set_type (protocol::TMGetObjectByHash::otFETCH_PACK);
+void NetworkOPsImp::buildFetchPack (BuiltFetchPack& pack,
+    Ledger::pointer haveLedger, Ledger::pointer wantLedger,
+    uint256 const& haveLedgerHash)
+{
+    auto const start = m_clock.now ();
+    std::size_t objects = 0;
 
+    protocol::TMGetObjectByHash reply;
+    reply.set_query (false);
+    reply.set_ledgerhash (haveLedgerHash.begin (), haveLedgerHash.size ());
+    reply.set_type (protocol::TMGetObjectByHash::otFETCH_PACK);
+
+    try
+    {
         // Building a fetch pack:
         //  1. Add the header for the requested ledger.
         //  2. Add the nodes for the AccountStateMap of that ledger.
         //  3. If there are transactions, add the nodes for the
         //     transactions of the ledger.
-        //  4. If the FetchPack now contains greater than or equal to
-        //     256 entries then stop.
-        //  5. If not very much time has elapsed, then loop back and repeat
-        //     the same process adding the previous ledger to the FetchPack.
+        //  4. If the current message is large enough, send it to the
+        //     waiting peers and start a new one.
+        //  5. If the pack is not yet too large and not very much time has
+        //     elapsed, then loop back and repeat the same process adding
+        //     the previous ledger to the FetchPack.
         do
         {
             std::uint32_t lSeq = wantLedger->getLedgerSeq ();
@@ -3450,30 +3576,87 @@ void NetworkOPsImp::makeFetchPack (
                     std::bind (fpAppender, &reply, lSeq, std::placeholders::_1,
                                std::placeholders::_2));
 
-            if (reply.objects ().size () >= 256)
+            if (reply.objects_size () >= fetchPackMessageObjects)
+            {
+                objects += reply.objects_size ();
+                addFetchPackMessage (pack, reply);
+            }
+
+            if (objects + reply.objects_size () >= fetchPackMaxObjects)
                 break;
 
             // move may save a ref/unref
             haveLedger = std::move (wantLedger);
             wantLedger = getLedgerByHash (haveLedger->getParentHash ());
         }
-        while (wantLedger &&
-               UptimeTimer::getInstance ().getElapsedSeconds () <= uUptime + 1);
-
-        m_journal.info
-            << "Built fetch pack with " << reply.objects ().size () << " nodes";
-        auto msg = std::make_shared<Message> (reply, protocol::mtGET_OBJECTS);
-        peer->send (msg);
+        while (wantLedger && (m_clock.now () - start) < fetchPackMaxTime);
     }
     catch (...)
     {
-        m_journal.warning << "Exception building fetch pach";
+        m_journal.warning << "Exception building fetch pack";
+    }
+
+    objects += reply.objects_size ();
+
+    if (reply.objects_size () != 0)
+        addFetchPackMessage (pack, reply);
+
+    std::size_t messages;
+    {
+        std::lock_guard <std::mutex> lock (pack.mutex);
+        messages = pack.messages.size ();
+        pack.peers.clear ();
+        pack.complete = true;
+    }
+
+    if (messages == 0)
+        mBuiltFetchPacks.del (haveLedgerHash, false);
+
+    m_journal.info
+        << "Built fetch pack with " << objects << " nodes in "
+        << messages << " messages";
+}
+
+void NetworkOPsImp::sendFetchPack (BuiltFetchPack& pack, Peer::ptr const& peer)
+{
+    std::vector <Message::pointer> messages;
+    {
+        std::lock_guard <std::mutex> lock (pack.mutex);
+        messages = pack.messages;
+
+        // The rest of the pack is sent as it is built
+        if (!pack.complete)
+            pack.peers.push_back (peer);
+    }
+
+    for (auto const& message : messages)
+        peer->send (message);
+}
+
+void NetworkOPsImp::addFetchPackMessage (BuiltFetchPack& pack,
+    protocol::TMGetObjectByHash& reply)
+{
+    auto message = std::make_shared<Message> (reply, protocol::mtGET_OBJECTS);
+    reply.clear_objects ();
+
+    std::vector <std::weak_ptr <Peer>> peers;
+    {
+        std::lock_guard <std::mutex> lock (pack.mutex);
+        pack.messages.push_back (message);
+        peers = pack.peers;
+    }
+
+    for (auto const& wPeer : peers)
+    {
+        if (auto peer = wPeer.lock ())
+            peer->send (message);
     }
 }
 
 void NetworkOPsImp::sweepFetchPack ()
 {
     mFetchPack.sweep ();
+    mBuiltFetchPacks.sweep ();
 }
 
 void NetworkOPsImp::addFetchPack (
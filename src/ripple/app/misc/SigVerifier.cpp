@@ -0,0 +1,171 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/misc/SigVerifier.h>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+class SigVerifierImp : public SigVerifier
+{
+private:
+    // The most transactions a job takes from the queue at once
+    static std::size_t const batchSize = 64;
+
+    struct Item
+    {
+        STTx::pointer txn;
+        Callback callback;
+    };
+
+    JobQueue& jobQueue_;
+    IHashRouter& router_;
+    int const threads_;
+    beast::Journal journal_;
+
+    std::mutex mutex_;
+    std::deque <Item> queue_;
+    int running_ = 0;
+
+public:
+    SigVerifierImp (JobQueue& jobQueue, IHashRouter& router, int threads,
+            beast::Journal journal)
+        : jobQueue_ (jobQueue)
+        , router_ (router)
+        , threads_ (std::max (threads, 1))
+        , journal_ (journal)
+    {
+    }
+
+    void verify (STTx::pointer const& txn, Callback callback)
+    {
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            queue_.push_back ({txn, std::move (callback)});
+
+            // A running job picks up everything queued behind it, so
+            // another is only needed while the queue outgrows them
+            if (running_ >= threads_ ||
+                    queue_.size () <= running_ * batchSize)
+                return;
+
+            ++running_;
+        }
+
+        jobQueue_.addJob (jtTXN_VERIFY, "verifyTxnSigs",
+            std::bind (&SigVerifierImp::run, this, std::placeholders::_1));
+    }
+
+    std::size_t size ()
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        return queue_.size ();
+    }
+
+private:
+    bool check (STTx const& txn)
+    {
+        uint256 const id = txn.getTransactionID ();
+        int const flags = router_.getFlags (id);
+
+        if (flags & SF_BAD)
+            return false;
+
+        if (flags & SF_SIGGOOD)
+            return true;
+
+        bool good = false;
+
+        try
+        {
+            good = passesLocalChecks (txn) && txn.checkSign ();
+        }
+        catch (...)
+        {
+            journal_.warning << "Exception checking signature of " << id;
+        }
+
+        router_.setFlag (id, good ? SF_SIGGOOD : SF_BAD);
+        return good;
+    }
+
+    void run (Job&)
+    {
+        std::vector <Item> batch;
+        batch.reserve (batchSize);
+
+        while (1)
+        {
+            {
+                std::lock_guard <std::mutex> lock (mutex_);
+
+                if (queue_.empty ())
+                {
+                    --running_;
+                    return;
+                }
+
+                std::size_t const count = (queue_.size () < batchSize) ?
+                    queue_.size () : batchSize;
+                std::move (queue_.begin (), queue_.begin () + count,
+                    std::back_inserter (batch));
+                queue_.erase (queue_.begin (), queue_.begin () + count);
+            }
+
+            std::vector <char> results;
+            results.reserve (batch.size ());
+
+            // Record every result before handing any of the batch on, so
+            // a duplicate that arrives meanwhile finds its flags set
+            for (auto const& item : batch)
+                results.push_back (check (*item.txn));
+
+            for (std::size_t i = 0; i < batch.size (); ++i)
+            {
+                try
+                {
+                    batch[i].callback (batch[i].txn, results[i] != 0);
+                }
+                catch (...)
+                {
+                    journal_.warning << "Exception processing " <<
+                        batch[i].txn->getTransactionID ();
+                }
+            }
+
+            batch.clear ();
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+
+std::unique_ptr <SigVerifier>
+make_SigVerifier (JobQueue& jobQueue, IHashRouter& router, int threads,
+    beast::Journal journal)
+{
+    return std::make_unique <SigVerifierImp> (
+        jobQueue, router, threads, journal);
+}
+
+}
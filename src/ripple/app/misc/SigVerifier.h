@@ -0,0 +1,67 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_SIGVERIFIER_H_INCLUDED
+#define RIPPLE_APP_SIGVERIFIER_H_INCLUDED
+
+#include <ripple/app/misc/IHashRouter.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/protocol/STTx.h>
+#include <beast/utility/Journal.h>
+#include <beast/cxx14/memory.h> // <memory>
+#include <functional>
+
+namespace ripple {
+
+/** Checks transaction signatures ahead of the apply stage.
+
+    Transactions are queued and verified in batches by a fixed number of
+    jtTXN_VERIFY jobs, so a burst of relayed transactions occupies at most
+    that many job threads. A transaction is good if it passes the local
+    checks and its signature verifies. Each result is recorded in the
+    HashRouter as SF_SIGGOOD or SF_BAD before the callback runs, so later
+    stages do not check the signature again.
+*/
+class SigVerifier
+{
+public:
+    /** Called with the transaction and whether its signature is good. */
+    using Callback = std::function <void (STTx::pointer const&, bool)>;
+
+    virtual ~SigVerifier () = default;
+
+    /** Queue a transaction for verification.
+
+        The callback is invoked once, from a job thread. A transaction whose
+        hash is already flagged SF_SIGGOOD or SF_BAD is not checked again.
+    */
+    virtual void verify (STTx::pointer const& txn, Callback callback) = 0;
+
+    /** Returns the number of transactions waiting to be verified. */
+    virtual std::size_t size () = 0;
+};
+
+/** Create a verifier which runs at most `threads` jobs at a time. */
+std::unique_ptr <SigVerifier>
+make_SigVerifier (JobQueue& jobQueue, IHashRouter& router, int threads,
+    beast::Journal journal);
+
+}
+
+#endif
@@ -0,0 +1,333 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/data/DBInit.h>
+#include <ripple/app/data/SqliteDatabase.h>
+#include <ripple/app/misc/AccountTxPaging.h>
+#include <ripple/basics/StringUtilities.h>
+#include <beast/module/core/core.h>
+#include <beast/unit_test/suite.h>
+#include <boost/format.hpp>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace ripple {
+
+/** Compares offset and marker paging of account_tx.
+
+    Builds a transaction database with the production schema, holding
+    num_rows AccountTransactions rows. Half of the rows belong to a single
+    busy account, the other half are spread over other accounts. Pages at
+    increasing depth are fetched with LIMIT offset (account_tx_old) and
+    with a (LedgerSeq, TxnSeq) marker (account_tx), then every page of the
+    busy account is walked in both directions with markers to check that
+    no row is skipped or repeated.
+
+    Parameters, for example:
+
+        num_rows=1000000,page_size=200,ledger_size=50
+*/
+class AccountTxPaging_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    std::string const busyAccount = "rBusyAccount";
+
+    std::uint32_t ledgers_ = 0;
+    std::uint32_t busyRows_ = 0;
+
+    static std::string
+    transID (std::uint32_t i)
+    {
+        return boost::str (boost::format ("%064X") % i);
+    }
+
+    static std::string
+    otherAccount (std::uint32_t i)
+    {
+        return boost::str (boost::format ("rOtherAccount%u") % (i % 1000));
+    }
+
+    // Every transaction affects the busy account and one other account
+    void populate (SqliteDatabase& db, std::uint32_t numRows,
+        std::uint32_t ledgerSize)
+    {
+        for (int i = 0; i < TxnDBCount; ++i)
+            db.executeSQL (TxnDBInit[i], true);
+
+        SqliteStatement txn (&db,
+            "INSERT INTO Transactions "
+            "(TransID,TransType,FromAcct,FromSeq,LedgerSeq,Status,RawTxn,TxnMeta)"
+            " VALUES (?,'Payment',?,?,?,'V',?,?);");
+        SqliteStatement acct (&db,
+            "INSERT INTO AccountTransactions (TransID,Account,LedgerSeq,TxnSeq)"
+            " VALUES (?,?,?,?);");
+
+        Blob const raw (150, 0xAB);
+        Blob const meta (300, 0xCD);
+
+        std::uint32_t const numTxns = numRows / 2;
+
+        db.executeSQL ("BEGIN TRANSACTION;", false);
+        for (std::uint32_t i = 0; i < numTxns; ++i)
+        {
+            std::string const id = transID (i);
+            std::string const other = otherAccount (i);
+            std::uint32_t const ledgerSeq = 2 + i / ledgerSize;
+            std::uint32_t const txnSeq = i % ledgerSize;
+
+            txn.bind (1, id);
+            txn.bind (2, busyAccount);
+            txn.bind (3, i);
+            txn.bind (4, ledgerSeq);
+            txn.bindStatic (5, raw);
+            txn.bindStatic (6, meta);
+            txn.step ();
+            txn.reset ();
+
+            for (auto const& account : { busyAccount, other })
+            {
+                acct.bind (1, id);
+                acct.bind (2, account);
+                acct.bind (3, ledgerSeq);
+                acct.bind (4, txnSeq);
+                acct.step ();
+                acct.reset ();
+            }
+        }
+        db.executeSQL ("COMMIT TRANSACTION;", false);
+
+        ledgers_ = 2 + (numTxns - 1) / ledgerSize;
+        busyRows_ = numTxns;
+
+        Database* const base = &db;
+        std::uint32_t rows = 0;
+        SQL_FOREACH (base, "SELECT COUNT(*) FROM AccountTransactions;")
+            rows = base->getInt (0);
+        expect (rows == 2 * numTxns, "Wrong number of rows");
+    }
+
+    static std::string
+    selection ()
+    {
+        return "AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,"
+            "Status,RawTxn,TxnMeta";
+    }
+
+    std::string
+    offsetSQL (std::uint32_t offset, std::uint32_t pageSize)
+    {
+        return boost::str (boost::format (
+            "SELECT %s FROM "
+            "AccountTransactions INNER JOIN Transactions "
+            "ON Transactions.TransID = AccountTransactions.TransID "
+            "WHERE Account = '%s' "
+            "ORDER BY AccountTransactions.LedgerSeq ASC, "
+            "AccountTransactions.TxnSeq ASC, AccountTransactions.TransID ASC "
+            "LIMIT %u, %u;")
+                % selection () % busyAccount % offset % pageSize);
+    }
+
+    struct Row
+    {
+        std::uint32_t ledger;
+        std::uint32_t seq;
+    };
+
+    // Returns the rows selected by the query, reading every column
+    static std::vector <Row>
+    fetch (Database* db, std::string const& sql)
+    {
+        std::vector <Row> rows;
+        SQL_FOREACH (db, sql)
+        {
+            Blob const raw = db->getBinary ("RawTxn");
+            Blob const meta = db->getBinary ("TxnMeta");
+            rows.push_back ({
+                static_cast <std::uint32_t> (db->getInt ("LedgerSeq")),
+                static_cast <std::uint32_t> (db->getInt ("TxnSeq"))});
+        }
+        return rows;
+    }
+
+    template <class Function>
+    static double
+    millis (Function f)
+    {
+        auto const start = clock_type::now ();
+        f ();
+        return std::chrono::duration <double, std::milli> (
+            clock_type::now () - start).count ();
+    }
+
+    void testDepth (SqliteDatabase& db, std::uint32_t pageSize)
+    {
+        testcase ("page depth");
+
+        std::stringstream ss;
+        ss << std::setprecision (2) << std::fixed;
+        ss << std::setw (10) << "Offset" << std::setw (14) << "LIMIT ms" <<
+            std::setw (14) << "Marker ms" << std::endl;
+
+        for (auto const fraction : { 0.0, 0.1, 0.5, 0.9 })
+        {
+            std::uint32_t const offset = static_cast <std::uint32_t> (
+                fraction * (busyRows_ - pageSize));
+
+            std::vector <Row> byOffset;
+            double const offsetMs = millis ([&]
+            {
+                byOffset = fetch (&db, offsetSQL (offset, pageSize));
+            });
+
+            if (! expect (! byOffset.empty (), "Empty page"))
+                return;
+
+            std::vector <Row> byMarker;
+            double const markerMs = millis ([&]
+            {
+                byMarker = fetch (&db, accountTxPageSQL (selection (),
+                    busyAccount, 0, ledgers_, true, byOffset.front ().ledger,
+                        byOffset.front ().seq, pageSize));
+            });
+
+            expect (byMarker.size () == byOffset.size (), "Page size mismatch");
+            expect (std::equal (byMarker.begin (), byMarker.end (),
+                byOffset.begin (), [](Row const& a, Row const& b)
+                {
+                    return a.ledger == b.ledger && a.seq == b.seq;
+                }), "Page contents mismatch");
+
+            ss << std::setw (10) << offset << std::setw (14) << offsetMs <<
+                std::setw (14) << markerMs << std::endl;
+        }
+
+        log << ss.str ();
+    }
+
+    void testWalk (SqliteDatabase& db, std::uint32_t pageSize, bool forward)
+    {
+        testcase (forward ? "walk forward" : "walk backward");
+
+        std::uint32_t findLedger = 0;
+        std::uint32_t findSeq = 0;
+        std::uint32_t total = 0;
+        std::uint32_t pages = 0;
+        bool ordered = true;
+        Row last = { 0, 0 };
+
+        double const ms = millis ([&]
+        {
+            for (;;)
+            {
+                std::vector <Row> rows = fetch (&db, accountTxPageSQL (
+                    selection (), busyAccount, 0, ledgers_, forward,
+                        findLedger, findSeq, pageSize + 1));
+
+                ++pages;
+                if (rows.size () > pageSize)
+                {
+                    findLedger = rows.back ().ledger;
+                    findSeq = rows.back ().seq;
+                    rows.pop_back ();
+                }
+                else
+                {
+                    findLedger = 0;
+                }
+
+                for (auto const& row : rows)
+                {
+                    if (total != 0)
+                    {
+                        bool const after = (row.ledger != last.ledger) ?
+                            (row.ledger > last.ledger) : (row.seq > last.seq);
+                        if (after != forward)
+                            ordered = false;
+                    }
+                    last = row;
+                    ++total;
+                }
+
+                if (findLedger == 0)
+                    break;
+            }
+        });
+
+        expect (ordered, "Rows out of order");
+        expect (total == busyRows_, "Wrong number of rows");
+
+        std::stringstream ss;
+        ss << std::setprecision (2) << std::fixed;
+        ss << pages << " pages, " << total << " rows in " << ms << " ms";
+        log << ss.str ();
+    }
+
+    void run ()
+    {
+        auto params = parseDelimitedKeyValueString (arg (), ',');
+
+        std::uint32_t numRows = 1000000;
+        if (! params["num_rows"].isEmpty ())
+            numRows = params["num_rows"].getIntValue ();
+
+        std::uint32_t pageSize = 200;
+        if (! params["page_size"].isEmpty ())
+            pageSize = params["page_size"].getIntValue ();
+
+        std::uint32_t ledgerSize = 50;
+        if (! params["ledger_size"].isEmpty ())
+            ledgerSize = params["ledger_size"].getIntValue ();
+
+        beast::UnitTestUtilities::TempDirectory dir ("txn_db");
+        beast::File const directory (dir.getFullPathName ());
+        directory.createDirectory ();
+        std::string const path = directory.getChildFile (
+            "transaction.db").getFullPathName ().toStdString ();
+
+        testcase ("populate");
+
+        SqliteDatabase db (path.c_str ());
+        db.connect ();
+
+        double const ms = millis ([&]
+        {
+            populate (db, numRows, ledgerSize);
+        });
+
+        std::stringstream ss;
+        ss << std::setprecision (2) << std::fixed;
+        ss << numRows << " rows in " << ledgers_ << " ledgers, " <<
+            busyRows_ << " for the busy account, built in " << ms << " ms";
+        log << ss.str ();
+
+        testDepth (db, pageSize);
+        testWalk (db, pageSize, true);
+        testWalk (db, pageSize, false);
+
+        db.disconnect ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(AccountTxPaging,bench,ripple);
+
+}
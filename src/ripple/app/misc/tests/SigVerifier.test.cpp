@@ -0,0 +1,235 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/misc/SigVerifier.h>
+#include <ripple/basics/StringUtilities.h>
+#include <beast/unit_test/suite.h>
+#include <beast/insight/NullCollector.h>
+#include <beast/threads/Stoppable.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace ripple {
+
+class SigVerifierTestBase : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    /** Returns serialized transactions signed by one account. */
+    static std::vector <Blob>
+    makeTransactions (std::size_t count)
+    {
+        RippleAddress seed;
+        seed.setSeedRandom ();
+        RippleAddress generator = RippleAddress::createGeneratorPublic (seed);
+        RippleAddress publicAcct = RippleAddress::createAccountPublic (generator, 1);
+        RippleAddress privateAcct = RippleAddress::createAccountPrivate (generator, seed, 1);
+
+        std::vector <Blob> result;
+        result.reserve (count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            STTx txn (ttACCOUNT_SET);
+            txn.setSourceAccount (publicAcct);
+            txn.setSigningPubKey (publicAcct);
+            txn.setSequence (static_cast <std::uint32_t> (i + 1));
+            txn.sign (privateAcct);
+
+            Serializer s;
+            txn.add (s);
+            result.push_back (s.getData ());
+        }
+
+        return result;
+    }
+
+    static STTx::pointer
+    parse (Blob const& blob)
+    {
+        Serializer s (blob);
+        SerializerIterator sit (s);
+        return std::make_shared <STTx> (std::ref (sit));
+    }
+
+    /** Verifies the transactions and waits for every callback.
+
+        @return The results, in the order of the transactions.
+    */
+    static std::vector <int>
+    verifyAll (SigVerifier& verifier, std::vector <STTx::pointer> const& txns)
+    {
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::size_t remaining = txns.size ();
+
+        // 1 is good, 0 is bad, -1 means the callback never ran
+        std::vector <int> results (txns.size (), -1);
+
+        for (std::size_t i = 0; i < txns.size (); ++i)
+        {
+            verifier.verify (txns[i],
+                [&, i](STTx::pointer const&, bool good)
+                {
+                    std::lock_guard <std::mutex> lock (mutex);
+                    results[i] = good ? 1 : 0;
+                    if (--remaining == 0)
+                        cond.notify_all ();
+                });
+        }
+
+        std::unique_lock <std::mutex> lock (mutex);
+        cond.wait (lock, [&] { return remaining == 0; });
+        return results;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+class SigVerifier_test : public SigVerifierTestBase
+{
+public:
+    void run ()
+    {
+        beast::Journal journal;
+        beast::RootStoppable root ("root");
+        auto jobQueue (make_JobQueue (
+            beast::insight::NullCollector::New (), root, journal));
+        jobQueue->setThreadCount (2, false, false);
+        root.prepare ();
+        root.start ();
+
+        std::unique_ptr <IHashRouter> router (
+            IHashRouter::New (IHashRouter::getDefaultHoldTime ()));
+        auto verifier = make_SigVerifier (*jobQueue, *router, 2, journal);
+
+        auto const blobs = makeTransactions (200);
+
+        std::vector <STTx::pointer> txns;
+        for (auto const& blob : blobs)
+            txns.push_back (parse (blob));
+
+        // Every third transaction gets another's signature
+        for (std::size_t i = 0; i < txns.size (); i += 3)
+            txns[i]->setFieldVL (sfTxnSignature,
+                txns[(i + 1) % txns.size ()]->getFieldVL (sfTxnSignature));
+
+        // A hash already known to be bad is not checked again
+        router->setFlag (txns[1]->getTransactionID (), SF_BAD);
+
+        auto const results = verifyAll (*verifier, txns);
+
+        for (std::size_t i = 0; i < txns.size (); ++i)
+        {
+            bool const good = (i % 3 != 0) && (i != 1);
+            int const flags = router->getFlags (txns[i]->getTransactionID ());
+
+            expect (results[i] == (good ? 1 : 0), "Wrong result");
+            expect ((flags & SF_SIGGOOD) == (good ? SF_SIGGOOD : 0),
+                "Wrong SF_SIGGOOD flag");
+            expect ((flags & SF_BAD) == (good ? 0 : SF_BAD),
+                "Wrong SF_BAD flag");
+        }
+
+        expect (verifier->size () == 0, "Transactions left in the queue");
+
+        root.stop (journal);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SigVerifier,app,ripple);
+
+//------------------------------------------------------------------------------
+
+/** Measures signature verifications per second against the thread count.
+
+    The same signed transactions are parsed afresh and verified once for
+    each thread count from 1 up to 'threads', which defaults to the number
+    of cores. 'num_txns' sets the number of transactions, default 5000.
+*/
+class SigVerify_test : public SigVerifierTestBase
+{
+public:
+    void run ()
+    {
+        auto params = parseDelimitedKeyValueString (arg (), ',');
+
+        std::size_t numTxns = 5000;
+        if (! params["num_txns"].isEmpty ())
+            numTxns = params["num_txns"].getIntValue ();
+
+        int maxThreads = std::max (1u, std::thread::hardware_concurrency ());
+        if (! params["threads"].isEmpty ())
+            maxThreads = params["threads"].getIntValue ();
+
+        testcase ("verify");
+
+        beast::Journal journal;
+        beast::RootStoppable root ("root");
+        auto jobQueue (make_JobQueue (
+            beast::insight::NullCollector::New (), root, journal));
+        jobQueue->setThreadCount (maxThreads, false, false);
+        root.prepare ();
+        root.start ();
+
+        auto const blobs = makeTransactions (numTxns);
+
+        for (int threads = 1; threads <= maxThreads; ++threads)
+        {
+            std::unique_ptr <IHashRouter> router (
+                IHashRouter::New (IHashRouter::getDefaultHoldTime ()));
+            auto verifier = make_SigVerifier (
+                *jobQueue, *router, threads, journal);
+
+            // Parsed for each pass since an STTx caches its result
+            std::vector <STTx::pointer> txns;
+            txns.reserve (blobs.size ());
+            for (auto const& blob : blobs)
+                txns.push_back (parse (blob));
+
+            auto const start = clock_type::now ();
+            auto const results = verifyAll (*verifier, txns);
+            std::chrono::duration <double> const elapsed =
+                clock_type::now () - start;
+
+            expect (std::count (results.begin (), results.end (), 1) ==
+                static_cast <std::ptrdiff_t> (txns.size ()),
+                    "Signature check failed");
+
+            std::stringstream ss;
+            ss << std::setprecision (0) << std::fixed;
+            ss << threads << " threads: " <<
+                (txns.size () / elapsed.count ()) << " verifications/s";
+            log << ss.str ();
+        }
+
+        root.stop (journal);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SigVerify,bench,ripple);
+
+}
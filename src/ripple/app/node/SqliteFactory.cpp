@@ -198,7 +198,8 @@ public:
         statement.bind(1, to_string (object->getHash()));
         statement.bind(2, type);
         statement.bind(3, object->getLedgerIndex());
-        statement.bindStatic(4, object->getData());
+        statement.bindStatic(4, object->getData().data(),
+            object->getData().size());
     }
 
     NodeObjectType getTypeFromString (std::string const& s)
@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/core/JobQueue.h>
+#include <beast/unit_test/suite.h>
+#include <beast/chrono/manual_clock.h>
+#include <beast/insight/NullCollector.h>
+#include <beast/module/core/maths/Random.h>
+#include <beast/threads/Stoppable.h>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace ripple {
+
+/** Measures the time to hash and flush a modified state map.
+
+    A map of random items is built three times from the same seed:
+
+    - eager: the root hash is recomputed after every insertion, which is
+      what a map did before inner node hashes were deferred.
+    - serial: hashes are deferred and the map is flushed on this thread.
+    - parallel: hashes are deferred and the branches of the root are
+      flushed on the job queue.
+
+    Parameters, for example:
+
+        num_items=1000000,threads=8
+*/
+class SHAMapFlush_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    static double
+    millis (clock_type::time_point start)
+    {
+        return std::chrono::duration <double, std::milli> (
+            clock_type::now () - start).count ();
+    }
+
+    struct Result
+    {
+        uint256 hash;
+        double build;
+        double flush;
+        int flushed;
+    };
+
+    Result
+    buildAndFlush (std::int64_t numItems, bool eager, JobQueue* jobQueue)
+    {
+        beast::manual_clock <std::chrono::steady_clock> clock;
+        beast::Journal const j;
+
+        FullBelowCache fullBelowCache ("test.full_below", clock);
+        TreeNodeCache treeNodeCache ("test.tree_node_cache", 65536, 60, clock, j);
+
+        SHAMap map (smtFREE, fullBelowCache, treeNodeCache);
+        map.setUnbacked ();
+
+        Result result;
+        beast::Random r (numItems);
+
+        auto start = clock_type::now ();
+        for (std::int64_t i = 0; i < numItems; ++i)
+        {
+            auto const item = RadixMap::make_random_item (r);
+            map.addItem (*item, false, false);
+            if (eager)
+                map.getHash ();
+        }
+        result.build = millis (start);
+
+        start = clock_type::now ();
+        result.flushed = map.flushDirty (hotACCOUNT_NODE, 1, jobQueue);
+        result.hash = map.getHash ();
+        result.flush = millis (start);
+
+        return result;
+    }
+
+    void report (std::string const& name, Result const& result)
+    {
+        std::stringstream ss;
+        ss << std::setprecision (2) << std::fixed;
+        ss << std::left << std::setw (10) << name <<
+            "build " << std::setw (10) << result.build << "ms  " <<
+            "flush " << std::setw (10) << result.flush << "ms  " <<
+            result.flushed << " nodes";
+        log << ss.str ();
+    }
+
+    void run ()
+    {
+        auto params = parseDelimitedKeyValueString (arg (), ',');
+
+        std::int64_t numItems = 100000;
+        if (! params["num_items"].isEmpty ())
+            numItems = params["num_items"].getIntValue ();
+
+        int threads = std::max (2u, std::thread::hardware_concurrency ());
+        if (! params["threads"].isEmpty ())
+            threads = params["threads"].getIntValue ();
+
+        testcase ("flush");
+
+        beast::Journal journal;
+        beast::RootStoppable root ("root");
+        auto jobQueue (make_JobQueue (
+            beast::insight::NullCollector::New (), root, journal));
+        jobQueue->setThreadCount (threads, false, false);
+        root.prepare ();
+        root.start ();
+
+        Result const eager = buildAndFlush (numItems, true, nullptr);
+        Result const serial = buildAndFlush (numItems, false, nullptr);
+        Result const parallel = buildAndFlush (numItems, false, jobQueue.get ());
+
+        root.stop (journal);
+
+        expect (serial.hash == eager.hash, "Serial flush hash mismatch");
+        expect (parallel.hash == eager.hash, "Parallel flush hash mismatch");
+        expect (parallel.flushed == serial.flushed, "Flushed count mismatch");
+
+        report ("eager", eager);
+        report ("serial", serial);
+        report ("parallel", parallel);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SHAMapFlush,bench,ripple);
+
+} // ripple
@@ -0,0 +1,155 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/StringUtilities.h>
+#include <beast/unit_test/suite.h>
+#include <beast/chrono/manual_clock.h>
+#include <beast/module/core/maths/Random.h>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace ripple {
+
+/** Measures concurrent lookups in an immutable map.
+
+    Each reader thread looks up random items of the same map, first through
+    SHAMap::peekItem, which takes the child lock and copies shared pointers
+    at every level, then through a SHAMap::ReadView. The number of readers
+    doubles until it reaches the thread count.
+
+    Parameters, for example:
+
+        num_items=1000000,lookups=1000000,threads=16
+*/
+class SHAMapRead_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    // Runs the lookup function on each reader, returns lookups per second
+    template <class Lookup>
+    double
+    measure (int readers, std::int64_t lookups,
+        std::vector <uint256> const& keys, Lookup const& lookup)
+    {
+        std::atomic <std::int64_t> found (0);
+        std::vector <std::thread> threads;
+        threads.reserve (readers);
+
+        auto const start = clock_type::now ();
+        for (int t = 0; t < readers; ++t)
+        {
+            threads.emplace_back ([&, t]()
+            {
+                beast::Random r (t + 1);
+                std::int64_t n = 0;
+                for (std::int64_t i = 0; i < lookups; ++i)
+                {
+                    if (lookup (keys[r.nextInt (static_cast <int> (
+                            keys.size ()))]))
+                        ++n;
+                }
+                found += n;
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join ();
+
+        double const seconds = std::chrono::duration <double> (
+            clock_type::now () - start).count ();
+
+        expect (found == readers * lookups, "Missing items");
+        return (readers * lookups) / seconds;
+    }
+
+    void run ()
+    {
+        auto params = parseDelimitedKeyValueString (arg (), ',');
+
+        std::int64_t numItems = 100000;
+        if (! params["num_items"].isEmpty ())
+            numItems = params["num_items"].getIntValue ();
+
+        std::int64_t lookups = 1000000;
+        if (! params["lookups"].isEmpty ())
+            lookups = params["lookups"].getIntValue ();
+
+        int threads = std::max (2u, std::thread::hardware_concurrency ());
+        if (! params["threads"].isEmpty ())
+            threads = params["threads"].getIntValue ();
+
+        testcase ("read");
+
+        beast::manual_clock <std::chrono::steady_clock> clock;
+        beast::Journal const j;
+
+        FullBelowCache fullBelowCache ("test.full_below", clock);
+        TreeNodeCache treeNodeCache ("test.tree_node_cache", 65536, 60, clock, j);
+
+        SHAMap map (smtFREE, fullBelowCache, treeNodeCache);
+        map.setUnbacked ();
+
+        std::vector <uint256> keys;
+        keys.reserve (numItems);
+
+        beast::Random r (numItems);
+        for (std::int64_t i = 0; i < numItems; ++i)
+        {
+            auto const item = RadixMap::make_random_item (r);
+            if (map.addItem (*item, false, false))
+                keys.push_back (item->getTag ());
+        }
+
+        map.flushDirty (hotACCOUNT_NODE, 1);
+        SHAMap::pointer const snapshot = map.snapShot (false);
+        SHAMap::ReadView const view (*snapshot);
+
+        std::stringstream ss;
+        ss << std::setprecision (0) << std::fixed;
+
+        for (int readers = 1; readers <= threads; readers *= 2)
+        {
+            double const locked = measure (readers, lookups, keys,
+                [&snapshot](uint256 const& key)
+                {
+                    return snapshot->peekItem (key) != nullptr;
+                });
+
+            double const viewed = measure (readers, lookups, keys,
+                [&view](uint256 const& key)
+                {
+                    return view.peekItem (key) != nullptr;
+                });
+
+            ss << std::setw (4) << readers << " readers  " <<
+                "peekItem " << std::setw (12) << locked << "/s  " <<
+                "ReadView " << std::setw (12) << viewed << "/s" << std::endl;
+        }
+
+        log << ss.str ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SHAMapRead,bench,ripple);
+
+} // ripple
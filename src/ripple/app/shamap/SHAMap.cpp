@@ -18,9 +18,17 @@
 //==============================================================================
 
 #include <ripple/basics/Log.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/nodestore/Database.h>
 #include <beast/unit_test/suite.h>
 #include <beast/chrono/manual_clock.h>
+#include <beast/insight/NullCollector.h>
+#include <beast/module/core/maths/Random.h>
+#include <beast/threads/Stoppable.h>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
 
 namespace ripple {
 
@@ -135,7 +143,7 @@ SHAMap::dirtyUp (SharedPtrNodeStack& stack,
                  uint256 const& target, SHAMapTreeNode::pointer child)
 {
     // walk the tree up from through the inner nodes to the root
-    // update hashes and links
+    // update links, the hashes are computed when they are needed
     // stack is a path of inner nodes up to, but not including, child
     // child can be an inner node or a leaf
 
@@ -153,17 +161,7 @@ SHAMap::dirtyUp (SharedPtrNodeStack& stack,
         assert (branch >= 0);
 
         unshareNode (node, nodeID);
-
-        if (! node->setChild (branch, child->getNodeHash(), child))
-        {
-            WriteLog (lsFATAL, SHAMap) << "dirtyUp terminates early";
-            assert (false);
-            return;
-        }
-
-#ifdef ST_DEBUG
-        WriteLog (lsTRACE, SHAMap) << "dirtyUp sets branch " << branch << " to " << prevHash;
-#endif
+        node->setDirtyChild (branch, child);
         child = std::move (node);
     }
 }
@@ -678,6 +676,143 @@ bool SHAMap::hasItem (uint256 const& id)
     return (leaf != nullptr);
 }
 
+//------------------------------------------------------------------------------
+
+SHAMap::ReadView::ReadView (SHAMap& map)
+    : mMap (map)
+{
+    assert (map.mState == smsImmutable);
+}
+
+SHAMapTreeNode*
+SHAMap::ReadView::descend (SHAMapTreeNode* parent, int branch) const
+{
+    SHAMapTreeNode* node = parent->peekChildPointer (branch);
+
+    // A child that isn't hooked up yet is loaded through the map
+    if (!node)
+        node = mMap.descendThrow (parent, branch);
+
+    return node;
+}
+
+SHAMapTreeNode*
+SHAMap::ReadView::walkTo (uint256 const& id) const
+{
+    SHAMapTreeNode* node = mMap.root.get ();
+    SHAMapNodeID nodeID;
+
+    while (node->isInner ())
+    {
+        int branch = nodeID.selectBranch (id);
+
+        if (node->isEmptyBranch (branch))
+            return nullptr;
+
+        node = descend (node, branch);
+        nodeID = nodeID.getChildNodeID (branch);
+    }
+
+    return (node->getTag () == id) ? node : nullptr;
+}
+
+SHAMapTreeNode*
+SHAMap::ReadView::firstBelow (SHAMapTreeNode* node) const
+{
+    while (!node->hasItem ())
+    {
+        int branch = 0;
+        while ((branch < 16) && node->isEmptyBranch (branch))
+            ++branch;
+
+        if (branch == 16)
+            return nullptr;
+
+        node = descend (node, branch);
+    }
+
+    return node;
+}
+
+bool SHAMap::ReadView::hasItem (uint256 const& id) const
+{
+    return walkTo (id) != nullptr;
+}
+
+SHAMapItem const* SHAMap::ReadView::peekItem (uint256 const& id) const
+{
+    SHAMapTreeNode* leaf = walkTo (id);
+
+    if (!leaf)
+        return nullptr;
+
+    return leaf->peekItem ().get ();
+}
+
+SHAMapItem const*
+SHAMap::ReadView::peekItem (uint256 const& id, uint256& hash) const
+{
+    SHAMapTreeNode* leaf = walkTo (id);
+
+    if (!leaf)
+        return nullptr;
+
+    hash = leaf->getNodeHash ();
+    return leaf->peekItem ().get ();
+}
+
+SHAMapItem const* SHAMap::ReadView::peekNextItem (uint256 const& id) const
+{
+    // The inner nodes on the path to the id, and the branch taken from each
+    SHAMapTreeNode* path[64];
+    int branches[64];
+    int depth = 0;
+
+    SHAMapTreeNode* node = mMap.root.get ();
+    SHAMapNodeID nodeID;
+
+    while (node && node->isInner ())
+    {
+        int branch = nodeID.selectBranch (id);
+        path[depth] = node;
+        branches[depth] = branch;
+        ++depth;
+
+        if (node->isEmptyBranch (branch))
+            node = nullptr;
+        else
+        {
+            node = descend (node, branch);
+            nodeID = nodeID.getChildNodeID (branch);
+        }
+    }
+
+    if (node && (node->peekItem ()->getTag () > id))
+        return node->peekItem ().get ();
+
+    // Walk back up, looking for the first item to the right of the path
+    while (depth-- > 0)
+    {
+        for (int i = branches[depth] + 1; i < 16; ++i)
+        {
+            if (!path[depth]->isEmptyBranch (i))
+            {
+                node = firstBelow (descend (path[depth], i));
+
+                if (!node || node->isInner ())
+                    throw (std::runtime_error ("missing/corrupt node"));
+
+                return node->peekItem ().get ();
+            }
+        }
+    }
+
+    // must be last item
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+
 bool SHAMap::delItem (uint256 const& id)
 {
     // delete the item with this ID
@@ -961,39 +1096,58 @@ void SHAMap::preFlushNode (SHAMapTreeNode::pointer& node)
 
 int SHAMap::unshare ()
 {
-    return walkSubTree (false, hotUNKNOWN, 0);
+    return walkSubTree (false, hotUNKNOWN, 0, nullptr);
 }
 
 /** Convert all modified nodes to shared nodes */
 // If requested, write them to the node store
-int SHAMap::flushDirty (NodeObjectType t, std::uint32_t seq)
+int SHAMap::flushDirty (NodeObjectType t, std::uint32_t seq, JobQueue* jobQueue)
 {
-    return walkSubTree (true, t, seq);
+    return walkSubTree (true, t, seq, jobQueue);
 }
 
-int SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
+int SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq,
+    JobQueue* jobQueue)
 {
-    int flushed = 0;
-    Serializer s;
-
     if (!root || (root->getSeq() == 0) || root->isEmpty ())
-        return flushed;
+        return 0;
 
-    if (root->isLeaf())
-    { // special case -- root is leaf
-        preFlushNode (root);
+    SHAMapTreeNode::pointer node = root;
+    preFlushNode (node);
+
+    int const flushed = (jobQueue && node->isInner ())
+        ? flushBranches (node, doWrite, t, seq, *jobQueue)
+        : flushSubTree (node, doWrite, t, seq);
+
+    // Last inner node is the new root
+    root = std::move (node);
+
+    return flushed;
+}
+
+int SHAMap::flushSubTree (SHAMapTreeNode::pointer& top, bool doWrite,
+    NodeObjectType t, std::uint32_t seq)
+{
+    if (top->isLeaf ())
+    {
         if (doWrite && mBacked)
-            writeNode (t, seq, root);
+            writeNode (t, seq, top);
         return 1;
     }
 
+    // A flushed map owns every modified node, so the whole modified
+    // subtree can be hashed up front, one level at a time.
+    if (doWrite && top->mHashStale)
+        top->updateHashDeep ();
+
+    int flushed = 0;
+
     // Stack of {parent,index,child} pointers representing
     // inner nodes we are in the process of flushing
     using StackEntry = std::pair <SHAMapTreeNode::pointer, int>;
     std::stack <StackEntry, std::vector<StackEntry>> stack;
 
-    SHAMapTreeNode::pointer node = root;
-    preFlushNode (node);
+    SHAMapTreeNode::pointer node = std::move (top);
 
     int pos = 0;
 
@@ -1045,6 +1199,10 @@ int SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
             }
         }
 
+        // Our children are final, so our hash can be computed
+        if (node->mHashStale)
+            node->updateHashDeep ();
+
         // This inner node can now be shared
         if (doWrite && mBacked)
             writeNode (t, seq, node);
@@ -1067,12 +1225,106 @@ int SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
         ++pos;
     }
 
-    // Last inner node is the new root
-    root = std::move (node);
+    top = std::move (node);
 
     return flushed;
 }
 
+int SHAMap::flushBranches (SHAMapTreeNode::pointer& node, bool doWrite,
+    NodeObjectType t, std::uint32_t seq, JobQueue& jobQueue)
+{
+    // The modified branches of an inner node share no modified nodes, so
+    // each one is hashed and written on its own. The calling thread takes
+    // branches too, which guarantees progress even if no job runs.
+    struct State
+    {
+        std::vector <std::pair <int, SHAMapTreeNode::pointer>> branches;
+        std::atomic <std::size_t> next;
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::size_t finished = 0;
+        int flushed = 0;
+        std::exception_ptr error;
+    };
+
+    auto state = std::make_shared <State> ();
+    state->next = 0;
+
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        if (node->isEmptyBranch (branch))
+            continue;
+
+        SHAMapTreeNode::pointer child = node->getChild (branch);
+
+        if (child && (child->getSeq() != 0))
+            state->branches.emplace_back (branch, std::move (child));
+    }
+
+    std::size_t const count = state->branches.size ();
+
+    if (count < 2)
+        return flushSubTree (node, doWrite, t, seq);
+
+    // Jobs which start after every branch was taken do nothing, so they
+    // never touch the map after we return.
+    auto work = [this, state, doWrite, t, seq] ()
+    {
+        std::size_t i;
+        while ((i = state->next++) < state->branches.size ())
+        {
+            int flushed = 0;
+            std::exception_ptr error;
+
+            try
+            {
+                SHAMapTreeNode::pointer& child = state->branches[i].second;
+                preFlushNode (child);
+                flushed = flushSubTree (child, doWrite, t, seq);
+            }
+            catch (...)
+            {
+                error = std::current_exception ();
+            }
+
+            std::lock_guard <std::mutex> lock (state->mutex);
+            state->flushed += flushed;
+            if (error)
+                state->error = error;
+            if (++state->finished == state->branches.size ())
+                state->cond.notify_all ();
+        }
+    };
+
+    for (std::size_t i = 1; i < count; ++i)
+        jobQueue.addJob (jtFLUSH_MAP, "SHAMap::flush",
+            [work] (Job&) { work (); });
+
+    work ();
+
+    int flushed;
+    {
+        std::unique_lock <std::mutex> lock (state->mutex);
+        state->cond.wait (lock, [&] { return state->finished == count; });
+
+        if (state->error)
+            std::rethrow_exception (state->error);
+
+        flushed = state->flushed;
+    }
+
+    for (auto& branch : state->branches)
+        node->shareChild (branch.first, branch.second);
+
+    if (node->mHashStale)
+        node->updateHashDeep ();
+
+    if (doWrite && mBacked)
+        writeNode (t, seq, node);
+
+    return flushed + 1;
+}
+
 bool SHAMap::getPath (uint256 const& index, std::vector< Blob >& nodes, SHANodeFormat format)
 {
     // Return the path of nodes to the specified index in the specified format
@@ -1182,8 +1434,110 @@ public:
         return vuc;
     }
 
+    static uint256 randomKey (beast::Random& r)
+    {
+        Serializer s;
+        for (int i = 0; i < 3; ++i)
+            s.add32 (r.nextInt ());
+        return s.getSHA512Half ();
+    }
+
+    // Applies random changes to a map, reading its hash now and then, and
+    // checks each flush against a map whose hash was read after every add.
+    void testDeferredHashing (JobQueue* jobQueue)
+    {
+        testcase (jobQueue ? "parallel flush" : "deferred hashing");
+
+        beast::manual_clock <std::chrono::steady_clock> clock;
+        beast::Journal const j;
+
+        FullBelowCache fullBelowCache ("test.full_below", clock);
+        TreeNodeCache treeNodeCache ("test.tree_node_cache", 65536, 60, clock, j);
+
+        SHAMap map (smtFREE, fullBelowCache, treeNodeCache);
+        map.setUnbacked ();
+
+        beast::Random r (42);
+        std::map <uint256, Blob> items;
+        std::vector <uint256> keys;
+
+        for (int round = 0; round < 8; ++round)
+        {
+            for (int op = 0; op < 500; ++op)
+            {
+                int const choice = r.nextInt (4);
+
+                if (keys.empty () || (choice < 2))
+                {
+                    uint256 const key = randomKey (r);
+                    uint256 const data = randomKey (r);
+                    items[key] = Blob (data.begin (), data.end ());
+                    keys.push_back (key);
+                    map.addItem (SHAMapItem (key, items[key]), false, false);
+                }
+                else if (choice == 2)
+                {
+                    uint256 const& key = keys[r.nextInt (keys.size ())];
+                    uint256 const data = randomKey (r);
+                    items[key] = Blob (data.begin (), data.end ());
+                    map.updateGiveItem (std::make_shared <SHAMapItem> (
+                        key, items[key]), false, false);
+                }
+                else
+                {
+                    std::size_t const index = r.nextInt (keys.size ());
+                    map.delItem (keys[index]);
+                    items.erase (keys[index]);
+                    keys[index] = keys.back ();
+                    keys.pop_back ();
+                }
+
+                if (r.nextInt (50) == 0)
+                    map.getHash ();
+            }
+
+            SHAMap::pointer snapshot;
+            if (round % 2)
+                snapshot = map.snapShot (false);
+
+            map.flushDirty (hotUNKNOWN, round, jobQueue);
+
+            SHAMap expected (smtFREE, fullBelowCache, treeNodeCache);
+            expected.setUnbacked ();
+            for (auto const& item : items)
+            {
+                expected.addItem (SHAMapItem (item.first, item.second),
+                    false, false);
+                expected.getHash ();
+            }
+
+            expect (map.getHash () == expected.getHash (), "Wrong hash");
+            if (snapshot)
+                expect (snapshot->getHash () == expected.getHash (),
+                    "Wrong snapshot hash");
+        }
+    }
+
+    void testParallelFlush ()
+    {
+        beast::Journal journal;
+        beast::RootStoppable root ("root");
+        auto jobQueue (make_JobQueue (
+            beast::insight::NullCollector::New (), root, journal));
+        jobQueue->setThreadCount (4, false, false);
+        root.prepare ();
+        root.start ();
+
+        testDeferredHashing (jobQueue.get ());
+
+        root.stop (journal);
+    }
+
     void run ()
     {
+        testDeferredHashing (nullptr);
+        testParallelFlush ();
+
         testcase ("add/traverse");
 
         beast::manual_clock <std::chrono::steady_clock> clock;  // manual advance clock
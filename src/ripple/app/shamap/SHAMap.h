@@ -62,6 +62,8 @@ struct hash <ripple::SHAMapNodeID> : std::hash <ripple::SHAMapNodeID>
 
 namespace ripple {
 
+class JobQueue;
+
 enum SHAMapState
 {
     smsModifying = 0,       // Objects can be added and removed (like an open ledger)
@@ -123,6 +125,42 @@ public:
 
     typedef std::stack<std::pair<SHAMapTreeNode::pointer, SHAMapNodeID>> SharedPtrNodeStack;
 
+    /** Lock-free read access to an immutable map.
+
+        The nodes of an immutable map never change once they are hooked up,
+        so a ReadView walks them with raw pointers, without taking the child
+        lock or copying shared pointers at each level, and returns raw
+        pointers to the items.
+
+        The caller pins the map by holding a reference to it, or to the
+        ledger that owns it, for as long as it uses the view or anything
+        returned by it. Nodes are reclaimed only when the last reference
+        to the map goes away.
+    */
+    class ReadView
+    {
+    public:
+        explicit ReadView (SHAMap& map);
+
+        ReadView (ReadView const&) = delete;
+        ReadView& operator= (ReadView const&) = delete;
+
+        bool hasItem (uint256 const& id) const;
+
+        SHAMapItem const* peekItem (uint256 const& id) const;
+        SHAMapItem const* peekItem (uint256 const& id, uint256& hash) const;
+
+        // The first item after the given id, which need not be in the map
+        SHAMapItem const* peekNextItem (uint256 const& id) const;
+
+    private:
+        SHAMapTreeNode* descend (SHAMapTreeNode* parent, int branch) const;
+        SHAMapTreeNode* walkTo (uint256 const& id) const;
+        SHAMapTreeNode* firstBelow (SHAMapTreeNode* node) const;
+
+        SHAMap& mMap;
+    };
+
 public:
     // build new map
     SHAMap (
@@ -196,12 +234,26 @@ public:
     SHAMapAddNode addKnownNode (SHAMapNodeID const& nodeID, Blob const& rawNode,
                                 SHAMapSyncFilter * filter);
 
+    /** Add several nodes received from a peer, in order.
+
+        The hashes of the inner nodes are computed together before any node
+        is added. Root nodes must be added with addRootNode, they are
+        skipped here. Stops at the first invalid node.
+    */
+    SHAMapAddNode addKnownNodes (std::list<SHAMapNodeID> const& nodeIDs,
+                                 std::list<Blob> const& rawNodes,
+                                 SHAMapSyncFilter * filter);
+
     // status functions
     void setImmutable ()
     {
         assert (mState != smsInvalid);
         mState = smsImmutable;
     }
+    bool isImmutable () const
+    {
+        return mState == smsImmutable;
+    }
     bool isSynching () const
     {
         return (mState == smsFloating) || (mState == smsSynching);
@@ -223,7 +275,14 @@ public:
     // return value: true=successfully completed, false=too different
     bool compare (SHAMap::ref otherMap, Delta & differences, int maxCount);
 
-    int flushDirty (NodeObjectType t, std::uint32_t seq);
+    /** Hash and share every modified node, writing them if we are backed.
+        If a JobQueue is given, the modified branches of the root are
+        processed in parallel on it.
+        @return The number of nodes flushed.
+    */
+    int flushDirty (NodeObjectType t, std::uint32_t seq,
+        JobQueue* jobQueue = nullptr);
+
     int unshare ();
 
     void walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissing);
@@ -266,7 +325,7 @@ private:
     SHAMapTreeNode::pointer checkFilter (uint256 const& hash, SHAMapNodeID const& id,
         SHAMapSyncFilter* filter);
 
-    /** Update hashes up to the root */
+    /** Link modified nodes up to the root, deferring their hashes */
     void dirtyUp (SharedPtrNodeStack& stack,
                   uint256 const& target, SHAMapTreeNode::pointer terminal);
 
@@ -312,6 +371,10 @@ private:
     /** If there is only one leaf below this node, get its contents */
     SHAMapItem::pointer onlyBelow (SHAMapTreeNode*);
 
+    /** Add a node whose hash may already be known, zero if it is not */
+    SHAMapAddNode addKnownNode (SHAMapNodeID const& nodeID, Blob const& rawNode,
+                                uint256 const& rawHash, SHAMapSyncFilter * filter);
+
     bool hasInnerNode (SHAMapNodeID const& nodeID, uint256 const& hash);
     bool hasLeafNode (uint256 const& tag, uint256 const& hash);
 
@@ -321,7 +384,16 @@ private:
 
     void visitLeavesInternal (std::function<void (SHAMapItem::ref item)>& function);
 
-    int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq);
+    int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq,
+        JobQueue* jobQueue);
+
+    /** Flush a node prepared by preFlushNode and the modified nodes below it */
+    int flushSubTree (SHAMapTreeNode::pointer& node, bool doWrite,
+        NodeObjectType t, std::uint32_t seq);
+
+    /** Flush the modified branches of an inner node in parallel, then the node */
+    int flushBranches (SHAMapTreeNode::pointer& node, bool doWrite,
+        NodeObjectType t, std::uint32_t seq, JobQueue& jobQueue);
 
 private:
 
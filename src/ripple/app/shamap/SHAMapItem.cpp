@@ -33,4 +33,10 @@ SHAMapItem::SHAMapItem (uint256 const& tag, const Serializer& data)
 {
 }
 
+SHAMapItem::SHAMapItem (uint256 const& tag, void const* data, std::size_t size)
+    : mTag (tag)
+    , mData (data, size)
+{
+}
+
 } // ripple
@@ -45,6 +45,7 @@ public:
     explicit SHAMapItem (Blob const & data); // tag by hash
     SHAMapItem (uint256 const& tag, Blob const & data);
     SHAMapItem (uint256 const& tag, const Serializer & s);
+    SHAMapItem (uint256 const& tag, void const* data, std::size_t size);
 
     uint256 const& getTag () const
     {
@@ -58,6 +59,10 @@ public:
     {
         return mData;
     }
+    Serializer const& peekSerializer () const
+    {
+        return mData;
+    }
     void addRaw (Blob & s) const
     {
         s.insert (s.end (), mData.begin (), mData.end ());
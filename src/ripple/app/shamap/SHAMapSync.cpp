@@ -446,6 +446,46 @@ SHAMapAddNode SHAMap::addRootNode (uint256 const& hash, Blob const& rootNode, SH
 SHAMapAddNode
 SHAMap::addKnownNode (const SHAMapNodeID& node, Blob const& rawNode,
                       SHAMapSyncFilter* filter)
+{
+    return addKnownNode (node, rawNode, uZero, filter);
+}
+
+SHAMapAddNode
+SHAMap::addKnownNodes (std::list<SHAMapNodeID> const& nodeIDs,
+                       std::list<Blob> const& rawNodes,
+                       SHAMapSyncFilter* filter)
+{
+    assert (nodeIDs.size () == rawNodes.size ());
+
+    std::vector<uint256> const hashes =
+        SHAMapTreeNode::getWireInnerHashes (rawNodes);
+
+    SHAMapAddNode result;
+    auto hash = hashes.begin ();
+    auto rawNode = rawNodes.begin ();
+
+    for (auto const& nodeID : nodeIDs)
+    {
+        if (!nodeID.isRoot ())
+        {
+            SHAMapAddNode const added =
+                addKnownNode (nodeID, *rawNode, *hash, filter);
+            result += added;
+
+            if (added.isInvalid ())
+                break;
+        }
+
+        ++hash;
+        ++rawNode;
+    }
+
+    return result;
+}
+
+SHAMapAddNode
+SHAMap::addKnownNode (const SHAMapNodeID& node, Blob const& rawNode,
+                      uint256 const& rawHash, SHAMapSyncFilter* filter)
 {
     // return value: true=okay, false=error
     assert (!node.isRoot ());
@@ -495,7 +535,7 @@ SHAMap::addKnownNode (const SHAMapNodeID& node, Blob const& rawNode,
 
             SHAMapTreeNode::pointer newNode =
                 std::make_shared<SHAMapTreeNode> (rawNode, 0, snfWIRE,
-                                                  uZero, false);
+                                                  rawHash, rawHash.isNonZero ());
 
             if (!newNode->isInBounds (iNodeID))
             {
@@ -899,24 +939,49 @@ public:
                 pass ();
             }
 
-            for (nodeIDIterator = gotNodeIDs.begin (), rawNodeIterator = gotNodes.begin ();
-                    nodeIDIterator != gotNodeIDs.end (); ++nodeIDIterator, ++rawNodeIterator)
+            if (passes % 2 == 0)
             {
-                ++nodes;
+                // Add the whole reply at once, as peers' replies are added
+                nodes += gotNodeIDs.size ();
 #ifdef SMS_DEBUG
-                bytes += rawNodeIterator->size ();
+                for (auto const& rawNode : gotNodes)
+                    bytes += rawNode.size ();
 #endif
 
-                if (!destination.addKnownNode (*nodeIDIterator, *rawNodeIterator, nullptr).isGood ())
+                std::list<SHAMapNodeID> const gotNodeList (
+                    gotNodeIDs.begin (), gotNodeIDs.end ());
+
+                if (!destination.addKnownNodes (gotNodeList, gotNodes, nullptr).isGood ())
                 {
-                    WriteLog (lsTRACE, SHAMap) << "AddKnownNode fails";
-                    fail ("AddKnownNode");
+                    WriteLog (lsTRACE, SHAMap) << "AddKnownNodes fails";
+                    fail ("AddKnownNodes");
                 }
                 else
                 {
                     pass ();
                 }
             }
+            else
+            {
+                for (nodeIDIterator = gotNodeIDs.begin (), rawNodeIterator = gotNodes.begin ();
+                        nodeIDIterator != gotNodeIDs.end (); ++nodeIDIterator, ++rawNodeIterator)
+                {
+                    ++nodes;
+#ifdef SMS_DEBUG
+                    bytes += rawNodeIterator->size ();
+#endif
+
+                    if (!destination.addKnownNode (*nodeIDIterator, *rawNodeIterator, nullptr).isGood ())
+                    {
+                        WriteLog (lsTRACE, SHAMap) << "AddKnownNode fails";
+                        fail ("AddKnownNode");
+                    }
+                    else
+                    {
+                        pass ();
+                    }
+                }
+            }
 
             gotNodeIDs.clear ();
             gotNodes.clear ();
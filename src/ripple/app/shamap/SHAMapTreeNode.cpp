@@ -18,15 +18,21 @@
 //==============================================================================
 
 #include <ripple/basics/StringUtilities.h>
+#include <ripple/protocol/SHA512Half.h>
+#include <algorithm>
+#include <cstring>
 
 namespace ripple {
 
+uint256 const SHAMapTreeNode::sZeroHash;
 std::mutex SHAMapTreeNode::childLock;
 
 SHAMapTreeNode::SHAMapTreeNode (std::uint32_t seq)
     : mSeq (seq)
     , mType (tnERROR)
     , mIsBranch (0)
+    , mIsLoaded (0)
+    , mHashStale (false)
     , mFullBelowGen (0)
 {
 }
@@ -36,18 +42,24 @@ SHAMapTreeNode::SHAMapTreeNode (const SHAMapTreeNode& node, std::uint32_t seq)
     , mSeq (seq)
     , mType (node.mType)
     , mIsBranch (node.mIsBranch)
+    , mIsLoaded (0)
+    , mHashStale (node.mHashStale)
     , mFullBelowGen (0)
 {
     if (node.mItem)
         mItem = node.mItem;
-    else
+    else if (mIsBranch != 0)
     {
-        memcpy (mHashes, node.mHashes, sizeof (mHashes));
+        int const count = countBits (mIsBranch);
+        mBranches.reset (new Branch[count]);
 
         std::unique_lock <std::mutex> lock (childLock);
 
-        for (int i = 0; i < 16; ++i)
-            mChildren[i] = node.mChildren[i];
+        for (int i = 0; i < count; ++i)
+            mBranches[i] = node.mBranches[i];
+
+        mIsLoaded.store (node.mIsLoaded.load (std::memory_order_relaxed),
+            std::memory_order_relaxed);
     }
 }
 
@@ -57,23 +69,27 @@ SHAMapTreeNode::SHAMapTreeNode (SHAMapItem::ref item,
     , mSeq (seq)
     , mType (type)
     , mIsBranch (0)
+    , mIsLoaded (0)
+    , mHashStale (false)
     , mFullBelowGen (0)
 {
     assert (item->peekData ().size () >= 12);
     updateHash ();
 }
 
-SHAMapTreeNode::SHAMapTreeNode (Blob const& rawNode,
+SHAMapTreeNode::SHAMapTreeNode (const_byte_view rawNode,
                                 std::uint32_t seq, SHANodeFormat format,
                                 uint256 const& hash, bool hashValid)
     : mSeq (seq)
     , mType (tnERROR)
     , mIsBranch (0)
+    , mIsLoaded (0)
+    , mHashStale (false)
     , mFullBelowGen (0)
 {
     if (format == snfWIRE)
     {
-        Serializer s (rawNode);
+        Serializer s (rawNode.data (), rawNode.size ());
         int type = s.removeLastByte ();
         int len = s.getLength ();
 
@@ -81,7 +97,8 @@ SHAMapTreeNode::SHAMapTreeNode (Blob const& rawNode,
         {
 #ifdef BEAST_DEBUG
             deprecatedLogs().journal("SHAMapTreeNode").fatal <<
-                "Invalid wire format node" << strHex (rawNode);
+                "Invalid wire format node" <<
+                    strHex (rawNode.begin (), rawNode.size ());
             assert (false);
 #endif
             throw std::runtime_error ("invalid node AW type");
@@ -114,19 +131,19 @@ SHAMapTreeNode::SHAMapTreeNode (Blob const& rawNode,
             if (len != 512)
                 throw std::runtime_error ("invalid FI node");
 
-            for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (mHashes[i], i * 32);
+            uint256 hashes[16];
 
-                if (mHashes[i].isNonZero ())
-                    mIsBranch |= (1 << i);
-            }
+            for (int i = 0; i < 16; ++i)
+                s.get256 (hashes[i], i * 32);
 
+            setBranches (hashes);
             mType = tnINNER;
         }
         else if (type == 3)
         {
             // compressed inner
+            uint256 hashes[16];
+
             for (int i = 0; i < (len / 33); ++i)
             {
                 int pos;
@@ -134,12 +151,10 @@ SHAMapTreeNode::SHAMapTreeNode (Blob const& rawNode,
 
                 if ((pos < 0) || (pos >= 16)) throw std::runtime_error ("invalid CI node");
 
-                s.get256 (mHashes[pos], i * 33);
-
-                if (mHashes[pos].isNonZero ())
-                    mIsBranch |= (1 << pos);
+                s.get256 (hashes[pos], i * 33);
             }
 
+            setBranches (hashes);
             mType = tnINNER;
         }
         else if (type == 4)
@@ -175,21 +190,23 @@ SHAMapTreeNode::SHAMapTreeNode (Blob const& rawNode,
         prefix |= rawNode[2];
         prefix <<= 8;
         prefix |= rawNode[3];
-        Serializer s (rawNode.begin () + 4, rawNode.end ());
+
+        // The body is parsed in place, only leaf data is copied into its item
+        std::uint8_t const* const body = rawNode.data () + 4;
+        std::size_t const bodySize = rawNode.size () - 4;
 
         if (prefix == HashPrefix::transactionID)
         {
-            mItem = std::make_shared<SHAMapItem> (Serializer::getSHA512Half (rawNode), s.peekData ());
+            mItem = std::make_shared<SHAMapItem> (
+                Serializer::getSHA512Half (rawNode), body, bodySize);
             mType = tnTRANSACTION_NM;
         }
         else if (prefix == HashPrefix::leafNode)
         {
-            if (s.getLength () < 32)
+            if (bodySize < 32)
                 throw std::runtime_error ("short PLN node");
 
-            uint256 u;
-            s.get256 (u, s.getLength () - 32);
-            s.chop (32);
+            uint256 const u (uint256::fromVoid (body + bodySize - 32));
 
             if (u.isZero ())
             {
@@ -197,34 +214,30 @@ SHAMapTreeNode::SHAMapTreeNode (Blob const& rawNode,
                 throw std::runtime_error ("invalid PLN node");
             }
 
-            mItem = std::make_shared<SHAMapItem> (u, s.peekData ());
+            mItem = std::make_shared<SHAMapItem> (u, body, bodySize - 32);
             mType = tnACCOUNT_STATE;
         }
         else if (prefix == HashPrefix::innerNode)
         {
-            if (s.getLength () != 512)
+            if (bodySize != 512)
                 throw std::runtime_error ("invalid PIN node");
 
-            for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (mHashes[i], i * 32);
+            uint256 hashes[16];
 
-                if (mHashes[i].isNonZero ())
-                    mIsBranch |= (1 << i);
-            }
+            for (int i = 0; i < 16; ++i)
+                hashes[i] = uint256::fromVoid (body + i * 32);
 
+            setBranches (hashes);
             mType = tnINNER;
         }
         else if (prefix == HashPrefix::txNode)
         {
             // transaction with metadata
-            if (s.getLength () < 32)
+            if (bodySize < 32)
                 throw std::runtime_error ("short TXN node");
 
-            uint256 txID;
-            s.get256 (txID, s.getLength () - 32);
-            s.chop (32);
-            mItem = std::make_shared<SHAMapItem> (txID, s.peekData ());
+            uint256 const txID (uint256::fromVoid (body + bodySize - 32));
+            mItem = std::make_shared<SHAMapItem> (txID, body, bodySize - 32);
             mType = tnTRANSACTION_MD;
         }
         else
@@ -260,13 +273,16 @@ bool SHAMapTreeNode::updateHash ()
     {
         if (mIsBranch != 0)
         {
-            nh = Serializer::getPrefixHash (HashPrefix::innerNode, reinterpret_cast<unsigned char*> (mHashes), sizeof (mHashes));
+            uint256 hashes[16];
+            getHashes (hashes);
+
+            nh = Serializer::getPrefixHash (HashPrefix::innerNode, reinterpret_cast<unsigned char*> (hashes), sizeof (hashes));
 #if RIPPLE_VERIFY_NODEOBJECT_KEYS
             Serializer s;
             s.add32 (HashPrefix::innerNode);
 
             for (int i = 0; i < 16; ++i)
-                s.add256 (mHashes[i]);
+                s.add256 (hashes[i]);
 
             assert (nh == s.getSHA512Half ());
 #endif
@@ -280,19 +296,17 @@ bool SHAMapTreeNode::updateHash ()
     }
     else if (mType == tnACCOUNT_STATE)
     {
-        Serializer s (mItem->peekSerializer ().getDataLength () + (256 + 32) / 8);
-        s.add32 (HashPrefix::leafNode);
-        s.addRaw (mItem->peekData ());
-        s.add256 (mItem->getTag ());
-        nh = s.getSHA512Half ();
+        SHA512Half h (HashPrefix::leafNode);
+        h.add (mItem->peekData ());
+        h.add256 (mItem->getTag ());
+        nh = h.finish ();
     }
     else if (mType == tnTRANSACTION_MD)
     {
-        Serializer s (mItem->peekSerializer ().getDataLength () + (256 + 32) / 8);
-        s.add32 (HashPrefix::txNode);
-        s.addRaw (mItem->peekData ());
-        s.add256 (mItem->getTag ());
-        nh = s.getSHA512Half ();
+        SHA512Half h (HashPrefix::txNode);
+        h.add (mItem->peekData ());
+        h.add256 (mItem->getTag ());
+        nh = h.finish ();
     }
     else
         assert (false);
@@ -324,7 +338,7 @@ void SHAMapTreeNode::addRaw (Serializer& s, SHANodeFormat format)
             s.add32 (HashPrefix::innerNode);
 
             for (int i = 0; i < 16; ++i)
-                s.add256 (mHashes[i]);
+                s.add256 (getChildHash (i));
         }
         else
         {
@@ -334,7 +348,7 @@ void SHAMapTreeNode::addRaw (Serializer& s, SHANodeFormat format)
                 for (int i = 0; i < 16; ++i)
                     if (!isEmptyBranch (i))
                     {
-                        s.add256 (mHashes[i]);
+                        s.add256 (getChildHash (i));
                         s.add8 (i);
                     }
 
@@ -343,7 +357,7 @@ void SHAMapTreeNode::addRaw (Serializer& s, SHANodeFormat format)
             else
             {
                 for (int i = 0; i < 16; ++i)
-                    s.add256 (mHashes[i]);
+                    s.add256 (getChildHash (i));
 
                 s.add8 (2);
             }
@@ -398,8 +412,13 @@ void SHAMapTreeNode::addRaw (Serializer& s, SHANodeFormat format)
 
 bool SHAMapTreeNode::setItem (SHAMapItem::ref i, TNType type)
 {
+    // A node only becomes a leaf once all of its branches are gone
+    assert (mIsBranch == 0);
+    mBranches.reset ();
+    mIsLoaded.store (0, std::memory_order_relaxed);
     mType = type;
     mItem = i;
+    mHashStale = false;
     assert (isLeaf ());
     assert (mSeq != 0);
     return updateHash ();
@@ -413,24 +432,53 @@ bool SHAMapTreeNode::isEmpty () const
 int SHAMapTreeNode::getBranchCount () const
 {
     assert (isInner ());
-    int count = 0;
-
-    for (int i = 0; i < 16; ++i)
-        if (!isEmptyBranch (i))
-            ++count;
-
-    return count;
+    return countBits (mIsBranch);
 }
 
 void SHAMapTreeNode::makeInner ()
 {
     mItem.reset ();
     mIsBranch = 0;
-    memset (mHashes, 0, sizeof (mHashes));
+    mBranches.reset ();
+    mIsLoaded.store (0, std::memory_order_relaxed);
     mType = tnINNER;
+    mHashStale = false;
     mHash.zero ();
 }
 
+void SHAMapTreeNode::setBranches (uint256 const* hashes)
+{
+    mIsBranch = 0;
+    mIsLoaded.store (0, std::memory_order_relaxed);
+
+    for (int i = 0; i < 16; ++i)
+        if (hashes[i].isNonZero ())
+            mIsBranch |= (1 << i);
+
+    if (mIsBranch == 0)
+    {
+        mBranches.reset ();
+        return;
+    }
+
+    mBranches.reset (new Branch[countBits (mIsBranch)]);
+
+    for (int i = 0, j = 0; i < 16; ++i)
+        if (hashes[i].isNonZero ())
+            mBranches[j++].hash = hashes[i];
+}
+
+void SHAMapTreeNode::getHashes (uint256* hashes) const
+{
+    for (int i = 0, j = 0; i < 16; ++i)
+    {
+        if (isEmptyBranch (i))
+            hashes[i].zero ();
+        else
+            hashes[i] = mBranches[j++].hash;
+    }
+}
+
 void SHAMapTreeNode::dump (const SHAMapNodeID & id)
 {
     WriteLog (lsDEBUG, SHAMapNodeID) << "SHAMapTreeNode(" << id.getNodeID () << ")";
@@ -452,7 +500,7 @@ std::string SHAMapTreeNode::getString (const SHAMapNodeID & id) const
                 ret += "\nb";
                 ret += beast::lexicalCastThrow <std::string> (i);
                 ret += " = ";
-                ret += to_string (mHashes[i]);
+                ret += to_string (getChildHash (i));
             }
     }
 
@@ -486,27 +534,270 @@ bool SHAMapTreeNode::setChild (int m, uint256 const& hash, SHAMapTreeNode::ref c
     assert (mSeq != 0);
     assert (child.get() != this);
 
-    if (mHashes[m] == hash)
+    // A stale branch may hold the child being set, with an old hash
+    if (!mHashStale && (getChildHash (m) == hash))
         return false;
 
-    mHashes[m] = hash;
+    int const count = countBits (mIsBranch);
+    int const index = getBranchIndex (m);
 
     if (hash.isNonZero ())
     {
         assert (child && (child->getNodeHash() == hash));
-        mIsBranch |= (1 << m);
+
+        if (isEmptyBranch (m))
+            insertBranch (m);
+
+        mBranches[index].hash = hash;
+        mBranches[index].child = child;
+        setLoaded (m, true);
     }
     else
     {
         assert (!child);
+
+        // Shrink the branch array by one, keeping branch order
+        std::unique_ptr<Branch[]> branches;
+
+        if (count > 1)
+        {
+            branches.reset (new Branch[count - 1]);
+
+            for (int i = 0; i < index; ++i)
+                branches[i] = std::move (mBranches[i]);
+
+            for (int i = index + 1; i < count; ++i)
+                branches[i - 1] = std::move (mBranches[i]);
+        }
+
+        mBranches = std::move (branches);
         mIsBranch &= ~ (1 << m);
+        setLoaded (m, false);
     }
 
-    mChildren[m] = child;
+    // A stale hash is computed later, with the other modified branches
+    if (mHashStale)
+        return true;
 
     return updateHash ();
 }
 
+void SHAMapTreeNode::setDirtyChild (int m, SHAMapTreeNode::ref child)
+{
+    assert ((m >= 0) && (m < 16));
+    assert (mType == tnINNER);
+    assert (mSeq != 0);
+    assert (child && (child.get() != this));
+    assert (child->getSeq () == mSeq);
+
+    if (isEmptyBranch (m))
+        insertBranch (m);
+
+    mBranches[getBranchIndex (m)].child = child;
+    setLoaded (m, true);
+    mHashStale = true;
+}
+
+void SHAMapTreeNode::insertBranch (int m)
+{
+    assert (isEmptyBranch (m));
+
+    int const count = countBits (mIsBranch);
+    int const index = getBranchIndex (m);
+
+    // Grow the branch array by one, keeping branch order
+    std::unique_ptr<Branch[]> branches (new Branch[count + 1]);
+
+    for (int i = 0; i < index; ++i)
+        branches[i] = std::move (mBranches[i]);
+
+    for (int i = index; i < count; ++i)
+        branches[i + 1] = std::move (mBranches[i]);
+
+    mBranches = std::move (branches);
+    mIsBranch |= (1 << m);
+}
+
+// Writes the prefix of a hashed inner node
+static void setInnerPrefix (std::uint8_t* message)
+{
+    std::uint32_t const prefix = HashPrefix::innerNode;
+    message[0] = static_cast<std::uint8_t> (prefix >> 24);
+    message[1] = static_cast<std::uint8_t> ((prefix >> 16) & 0xff);
+    message[2] = static_cast<std::uint8_t> ((prefix >> 8) & 0xff);
+    message[3] = static_cast<std::uint8_t> (prefix & 0xff);
+}
+
+void SHAMapTreeNode::updateHashDeep ()
+{
+    assert (mType == tnINNER);
+
+    // Collect the stale nodes below us one level at a time. Only modified
+    // nodes can be stale, and they are always hooked up.
+    std::vector <std::vector <SHAMapTreeNode*>> levels;
+    levels.emplace_back (1, this);
+
+    while (1)
+    {
+        std::vector <SHAMapTreeNode*> next;
+
+        for (auto node : levels.back ())
+        {
+            for (int i = 0, count = countBits (node->mIsBranch); i < count; ++i)
+            {
+                SHAMapTreeNode* child = node->mBranches[i].child.get ();
+                if (child && child->mHashStale)
+                    next.push_back (child);
+            }
+        }
+
+        if (next.empty ())
+            break;
+
+        levels.push_back (std::move (next));
+    }
+
+    // Each level is hashed in one batch, the deepest first
+    for (auto level = levels.rbegin (); level != levels.rend (); ++level)
+        updateInnerHashes (*level);
+}
+
+void SHAMapTreeNode::updateInnerHashes (std::vector <SHAMapTreeNode*> const& nodes)
+{
+    std::size_t const size = 4 + 16 * 32;
+
+    Blob data (nodes.size () * size);
+    std::vector <const_byte_view> messages;
+    messages.reserve (nodes.size ());
+
+    for (auto node : nodes)
+    {
+        assert (node->mType == tnINNER);
+
+        for (int i = 0, count = countBits (node->mIsBranch); i < count; ++i)
+        {
+            Branch& b = node->mBranches[i];
+            if (b.child)
+            {
+                assert (!b.child->mHashStale);
+                b.hash = b.child->mHash;
+            }
+        }
+
+        if (node->mIsBranch == 0)
+            continue;
+
+        std::uint8_t* const message = data.data () + messages.size () * size;
+        setInnerPrefix (message);
+
+        // Empty branches hash as zeroes, which the buffer already holds
+        for (int i = 0, j = 0; i < 16; ++i)
+        {
+            if (!node->isEmptyBranch (i))
+                std::memcpy (message + 4 + i * 32,
+                    node->mBranches[j++].hash.begin (), 32);
+        }
+
+        messages.emplace_back (message, message + size);
+    }
+
+    std::vector <uint256> hashes (messages.size ());
+    SHA512Half::batch (messages.data (), hashes.data (), messages.size ());
+
+    auto hash = hashes.begin ();
+    for (auto node : nodes)
+    {
+        if (node->mIsBranch == 0)
+            node->mHash.zero ();
+        else
+            node->mHash = *hash++;
+
+        node->mHashStale = false;
+    }
+}
+
+std::vector <uint256>
+SHAMapTreeNode::getWireInnerHashes (std::list <Blob> const& rawNodes)
+{
+    std::size_t const size = 4 + 16 * 32;
+
+    // Expanded inner nodes, prefixed like their hashed form
+    Blob data;
+    std::vector <std::size_t> inner;
+
+    std::size_t index = 0;
+    for (auto iter = rawNodes.begin (); iter != rawNodes.end (); ++iter, ++index)
+    {
+        Blob const& raw = *iter;
+
+        if (raw.empty ())
+            continue;
+
+        int const type = raw.back ();
+        std::size_t const len = raw.size () - 1;
+
+        std::uint8_t message[size] = {};
+        setInnerPrefix (message);
+
+        if (type == 2)
+        {
+            // full inner
+            if (len != 512)
+                continue;
+
+            std::memcpy (message + 4, raw.data (), 512);
+        }
+        else if (type == 3)
+        {
+            // compressed inner, each branch is a hash and a position
+            bool valid = true;
+
+            for (std::size_t i = 0; i < (len / 33); ++i)
+            {
+                int const pos = raw[32 + (i * 33)];
+
+                if (pos >= 16)
+                {
+                    valid = false;
+                    break;
+                }
+
+                std::memcpy (message + 4 + pos * 32, raw.data () + i * 33, 32);
+            }
+
+            if (!valid)
+                continue;
+        }
+        else
+        {
+            continue;
+        }
+
+        // Without branches, the node's hash is zero
+        if (std::all_of (message + 4, message + size,
+                [](std::uint8_t c) { return c == 0; }))
+            continue;
+
+        data.insert (data.end (), message, message + size);
+        inner.push_back (index);
+    }
+
+    std::vector <const_byte_view> messages;
+    messages.reserve (inner.size ());
+    for (std::size_t i = 0; i < inner.size (); ++i)
+        messages.emplace_back (data.data () + i * size,
+            data.data () + (i + 1) * size);
+
+    std::vector <uint256> innerHashes (inner.size ());
+    SHA512Half::batch (messages.data (), innerHashes.data (), messages.size ());
+
+    std::vector <uint256> hashes (rawNodes.size ());
+    for (std::size_t i = 0; i < inner.size (); ++i)
+        hashes[inner[i]] = innerHashes[i];
+
+    return hashes;
+}
+
 // finished modifying, now make shareable
 void SHAMapTreeNode::shareChild (int m, SHAMapTreeNode::ref child)
 {
@@ -515,9 +806,12 @@ void SHAMapTreeNode::shareChild (int m, SHAMapTreeNode::ref child)
     assert (mSeq != 0);
     assert (child);
     assert (child.get() != this);
-    assert (child->getNodeHash() == mHashes[m]);
+    assert (!isEmptyBranch (m));
 
-    mChildren[m] = child;
+    Branch& b = mBranches[getBranchIndex (m)];
+    assert (mHashStale || (child->getNodeHash() == b.hash));
+    b.child = child;
+    setLoaded (m, true);
 }
 
 SHAMapTreeNode* SHAMapTreeNode::getChildPointer (int branch)
@@ -525,8 +819,11 @@ SHAMapTreeNode* SHAMapTreeNode::getChildPointer (int branch)
     assert (branch >= 0 && branch < 16);
     assert (isInnerNode ());
 
+    if (isEmptyBranch (branch))
+        return nullptr;
+
     std::unique_lock <std::mutex> lock (childLock);
-    return mChildren[branch].get ();
+    return mBranches[getBranchIndex (branch)].child.get ();
 }
 
 SHAMapTreeNode::pointer SHAMapTreeNode::getChild (int branch)
@@ -534,9 +831,14 @@ SHAMapTreeNode::pointer SHAMapTreeNode::getChild (int branch)
     assert (branch >= 0 && branch < 16);
     assert (isInnerNode ());
 
+    if (isEmptyBranch (branch))
+        return SHAMapTreeNode::pointer ();
+
+    Branch const& b = mBranches[getBranchIndex (branch)];
+
     std::unique_lock <std::mutex> lock (childLock);
-    assert (!mChildren[branch] || (mHashes[branch] == mChildren[branch]->getNodeHash()));
-    return mChildren[branch];
+    assert (mHashStale || !b.child || (b.hash == b.child->getNodeHash()));
+    return b.child;
 }
 
 void SHAMapTreeNode::canonicalizeChild (int branch, SHAMapTreeNode::pointer& node)
@@ -544,18 +846,22 @@ void SHAMapTreeNode::canonicalizeChild (int branch, SHAMapTreeNode::pointer& nod
     assert (branch >= 0 && branch < 16);
     assert (isInnerNode ());
     assert (node);
-    assert (node->getNodeHash() == mHashes[branch]);
+    assert (!isEmptyBranch (branch));
+    assert (node->getNodeHash() == getChildHash (branch));
+
+    SHAMapTreeNode::pointer& child = mBranches[getBranchIndex (branch)].child;
 
     std::unique_lock <std::mutex> lock (childLock);
-    if (mChildren[branch])
+    if (child)
     {
         // There is already a node hooked up, return it
-        node = mChildren[branch];
+        node = child;
     }
     else
     {
         // Hook this node up
-        mChildren[branch] = node;
+        child = node;
+        setLoaded (branch, true);
     }
 }
 
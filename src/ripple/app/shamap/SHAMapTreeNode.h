@@ -24,6 +24,10 @@
 #include <ripple/app/shamap/TreeNodeCache.h>
 #include <ripple/basics/CountedObject.h>
 #include <ripple/basics/TaggedCache.h>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <vector>
 
 namespace ripple {
 
@@ -63,10 +67,19 @@ public:
     SHAMapTreeNode (SHAMapItem::ref item, TNType type, std::uint32_t seq);
 
     // raw node functions
-    SHAMapTreeNode (Blob const & data, std::uint32_t seq,
+    SHAMapTreeNode (const_byte_view data, std::uint32_t seq,
                     SHANodeFormat format, uint256 const& hash, bool hashValid);
     void addRaw (Serializer&, SHANodeFormat format);
 
+    /** Computes the hashes of the inner nodes among raw wire format nodes.
+
+        All inner nodes are hashed together. The hash of every other node,
+        including malformed ones, is left zero: those are hashed when they
+        are parsed.
+    */
+    static std::vector <uint256> getWireInnerHashes (
+        std::list <Blob> const& rawNodes);
+
     virtual bool isPopulated () const
     {
         return true;
@@ -83,6 +96,8 @@ public:
     }
     uint256 const& getNodeHash () const
     {
+        if (mHashStale)
+            const_cast <SHAMapTreeNode*> (this)->updateHashDeep ();
         return mHash;
     }
     TNType getType () const
@@ -131,6 +146,9 @@ public:
     // We are modifying the child hash
     bool setChild (int m, uint256 const& hash, std::shared_ptr<SHAMapTreeNode> const& child);
 
+    // We are modifying the child, our hash is computed when it is needed
+    void setDirtyChild (int m, std::shared_ptr<SHAMapTreeNode> const& child);
+
     // We are sharing/unsharing the child
     void shareChild (int m, std::shared_ptr<SHAMapTreeNode> const& child);
 
@@ -144,7 +162,12 @@ public:
     uint256 const& getChildHash (int m) const
     {
         assert ((m >= 0) && (m < 16) && (mType == tnINNER));
-        return mHashes[m];
+        if (isEmptyBranch (m))
+            return sZeroHash;
+        Branch const& b = mBranches[getBranchIndex (m)];
+        if (mHashStale && b.child)
+            return b.child->getNodeHash ();
+        return b.hash;
     }
 
     // item node function
@@ -185,22 +208,102 @@ public:
     SHAMapTreeNode::pointer getChild (int branch);
     void canonicalizeChild (int branch, SHAMapTreeNode::pointer& node);
 
+    /** Returns the child on a branch if it is hooked up, without locking.
+        Only the nodes of an immutable map may be read this way, since a
+        child is hooked up to them at most once and never changes after.
+    */
+    SHAMapTreeNode* peekChildPointer (int branch) const
+    {
+        assert (branch >= 0 && branch < 16);
+
+        if ((mIsLoaded.load (std::memory_order_acquire) & (1 << branch)) == 0)
+            return nullptr;
+
+        return mBranches[getBranchIndex (branch)].child.get ();
+    }
+
+    /** Returns the number of heap bytes owned by this node.
+        This does not include the node itself, its children or its item.
+    */
+    std::size_t getBranchMemoryUsage () const
+    {
+        return mBranches ? (getBranchCount () * sizeof (Branch)) : 0;
+    }
+
 private:
 
     // VFALCO TODO remove the use of friend
     friend class SHAMap;
 
+    // A populated branch of an inner node.
+    struct Branch
+    {
+        uint256                 hash;
+        SHAMapTreeNode::pointer child;
+    };
+
+    // When mHashStale is set, the hashes of this inner node and of the
+    // branches holding modified children have not been computed yet. Only
+    // nodes owned by a single mutable map are ever stale.
     uint256                 mHash;
-    uint256                 mHashes[16];
-    SHAMapTreeNode::pointer mChildren[16];
+
+    // Inner nodes hold one Branch per set bit of mIsBranch, in branch
+    // order. Leaves and empty inner nodes hold nothing.
+    std::unique_ptr<Branch[]> mBranches;
     SHAMapItem::pointer     mItem;
     std::uint32_t           mSeq;
     TNType                  mType;
-    int                     mIsBranch;
+    std::uint16_t           mIsBranch;
+
+    // The branches with a child hooked up. A bit is set after its child,
+    // so a reader that sees the bit also sees the child.
+    std::atomic <std::uint16_t> mIsLoaded;
+
+    bool                    mHashStale;
     std::uint32_t           mFullBelowGen;
 
     bool updateHash ();
 
+    // Computes the hashes of stale descendants, then our own
+    void updateHashDeep ();
+
+    // Computes the hashes of inner nodes whose children are all current
+    static void updateInnerHashes (std::vector <SHAMapTreeNode*> const& nodes);
+
+    // Make room for a new branch m
+    void insertBranch (int m);
+
+    // Record whether branch m has a child hooked up
+    void setLoaded (int m, bool loaded)
+    {
+        std::uint16_t const bit = static_cast <std::uint16_t> (1 << m);
+        if (loaded)
+            mIsLoaded.fetch_or (bit, std::memory_order_release);
+        else
+            mIsLoaded.fetch_and (~bit, std::memory_order_release);
+    }
+
+    // Position of branch m within mBranches
+    int getBranchIndex (int m) const
+    {
+        return countBits (mIsBranch & ((1 << m) - 1));
+    }
+
+    static int countBits (int bits)
+    {
+        int count = 0;
+        for (; bits != 0; bits &= bits - 1)
+            ++count;
+        return count;
+    }
+
+    // Rebuild the sparse branches from a full set of 16 hashes
+    void setBranches (uint256 const* hashes);
+
+    // Fill in the full set of 16 hashes, zero for empty branches
+    void getHashes (uint256* hashes) const;
+
+    static uint256 const    sZeroHash;
     static std::mutex       childLock;
 };
 
@@ -0,0 +1,214 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <beast/unit_test/suite.h>
+#include <beast/chrono/manual_clock.h>
+#include <iomanip>
+#include <sstream>
+
+namespace ripple {
+
+/** Reports the memory used by the nodes of a SHAMap.
+
+    With no arguments, a map of random items is built in memory. To measure
+    a real account state map, pass the NodeStore backend parameters and the
+    root hash of the state map, for example:
+
+        type=rocksdb,path=/var/lib/rippled/db/rocksdb,hash=<account hash>
+
+    'num_items' sets the size of the random map, it defaults to 100000.
+*/
+class SHAMapMemory_test : public beast::unit_test::suite
+{
+public:
+    struct Stats
+    {
+        std::size_t inner = 0;
+        std::size_t leaves = 0;
+        std::size_t branches = 0;
+        std::size_t branchBytes = 0;
+        std::size_t itemBytes = 0;
+
+        void add (SHAMapTreeNode& node)
+        {
+            if (node.isInner ())
+            {
+                ++inner;
+                branches += node.getBranchCount ();
+                branchBytes += node.getBranchMemoryUsage ();
+            }
+            else
+            {
+                ++leaves;
+                itemBytes += node.peekData ().size ();
+            }
+        }
+    };
+
+    // Loads every node below the root from the backend
+    SHAMapTreeNode::pointer
+    loadTree (NodeStore::Backend& backend, uint256 const& rootHash,
+        Stats& stats)
+    {
+        auto const fetch = [&](uint256 const& hash)
+        {
+            NodeObject::Ptr object;
+            if (backend.fetch (hash.begin (), &object) != NodeStore::ok)
+                return SHAMapTreeNode::pointer ();
+            return std::make_shared <SHAMapTreeNode> (
+                object->getData (), 0, snfPREFIX, hash, true);
+        };
+
+        SHAMapTreeNode::pointer root = fetch (rootHash);
+        if (! expect (root != nullptr, "Missing root node"))
+            return root;
+
+        std::vector <SHAMapTreeNode*> stack;
+        stack.push_back (root.get ());
+
+        while (! stack.empty ())
+        {
+            SHAMapTreeNode* node = stack.back ();
+            stack.pop_back ();
+            stats.add (*node);
+
+            if (! node->isInner ())
+                continue;
+
+            for (int i = 0; i < 16; ++i)
+            {
+                if (node->isEmptyBranch (i))
+                    continue;
+
+                SHAMapTreeNode::pointer child = fetch (node->getChildHash (i));
+                if (! expect (child != nullptr, "Missing node"))
+                    continue;
+
+                node->canonicalizeChild (i, child);
+                stack.push_back (child.get ());
+            }
+        }
+
+        return root;
+    }
+
+    void report (Stats const& stats)
+    {
+        std::size_t const nodes = stats.inner + stats.leaves;
+        if (! expect (nodes != 0, "Empty map"))
+            return;
+
+        std::size_t const fixedArrays = 16 *
+            (sizeof (uint256) + sizeof (SHAMapTreeNode::pointer));
+
+        // The previous layout embedded 16 hashes and 16 child pointers
+        // in every node, inner or leaf.
+        std::size_t const oldBytes = nodes * (sizeof (SHAMapTreeNode) -
+            sizeof (void*) + fixedArrays);
+        std::size_t const newBytes = nodes * sizeof (SHAMapTreeNode) +
+            stats.branchBytes;
+
+        std::stringstream ss;
+        ss << std::setprecision (2) << std::fixed;
+        ss << nodes << " nodes (" << stats.inner << " inner, " <<
+            stats.leaves << " leaves), " << (double (stats.branches) /
+                std::max <std::size_t> (stats.inner, 1)) <<
+                    " branches per inner node" << std::endl;
+        ss << "item data:       " << stats.itemBytes << " bytes" << std::endl;
+        ss << "fixed branches:  " << oldBytes << " bytes, " <<
+            (double (oldBytes) / nodes) << " bytes per node" << std::endl;
+        ss << "sparse branches: " << newBytes << " bytes, " <<
+            (double (newBytes) / nodes) << " bytes per node";
+        log << ss.str ();
+    }
+
+    void testRandomMap (std::int64_t numItems)
+    {
+        testcase ("random map");
+
+        beast::manual_clock <std::chrono::steady_clock> clock;
+        beast::Journal const j;
+
+        FullBelowCache fullBelowCache ("test.full_below", clock);
+        TreeNodeCache treeNodeCache ("test.tree_node_cache", 65536, 60, clock, j);
+
+        SHAMap map (smtFREE, fullBelowCache, treeNodeCache);
+        map.setUnbacked ();
+
+        beast::Random r;
+        RadixMap::add_random_items (numItems, map, r);
+
+        Stats stats;
+        map.visitNodes ([&stats](SHAMapTreeNode& node)
+        {
+            stats.add (node);
+            return false;
+        });
+
+        report (stats);
+    }
+
+    void testStoredMap (beast::StringPairArray const& params)
+    {
+        testcase ("stored map");
+
+        uint256 rootHash;
+        if (! expect (rootHash.SetHex (params["hash"].toStdString ()),
+                "Invalid hash"))
+            return;
+
+        auto manager = NodeStore::make_Manager ();
+        NodeStore::DummyScheduler scheduler;
+        beast::Journal j;
+
+        auto backend = manager->make_Backend (params, scheduler, j);
+
+        Stats stats;
+        SHAMapTreeNode::pointer root = loadTree (*backend, rootHash, stats);
+        if (root)
+            report (stats);
+    }
+
+    void run ()
+    {
+        auto params = parseDelimitedKeyValueString (arg (), ',');
+
+        if (! params["hash"].isEmpty ())
+        {
+            if (params["type"].isEmpty ())
+                params.set ("type", "rocksdb");
+
+            testStoredMap (params);
+            return;
+        }
+
+        std::int64_t numItems = 100000;
+        if (! params["num_items"].isEmpty ())
+            numItems = params["num_items"].getIntValue ();
+
+        testRandomMap (numItems);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SHAMapMemory,bench,ripple);
+
+} // ripple
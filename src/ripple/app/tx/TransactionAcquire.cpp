@@ -235,16 +235,17 @@ SHAMapAddNode TransactionAcquire::takeNodes (const std::list<SHAMapNodeID>& node
                 else
                     mHaveRoot = true;
             }
-            else if (!mMap->addKnownNode (*nodeIDit, *nodeDatait, &sf).isGood())
-            {
-                WriteLog (lsWARNING, TransactionAcquire) << "TX acquire got bad non-root node";
-                return SHAMapAddNode::invalid ();
-            }
 
             ++nodeIDit;
             ++nodeDatait;
         }
 
+        if (!mMap->addKnownNodes (nodeIDs, data, &sf).isGood())
+        {
+            WriteLog (lsWARNING, TransactionAcquire) << "TX acquire got bad non-root node";
+            return SHAMapAddNode::invalid ();
+        }
+
         trigger (peer);
         progress ();
         return SHAMapAddNode::useful ();
@@ -17,6 +17,11 @@
 */
 //==============================================================================
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace ripple {
 
 //
@@ -31,6 +36,9 @@ void TransactionEngine::txnWrite ()
     {
         SLE::ref    sleEntry    = it.second.mEntry;
 
+        if (mWrites && (it.second.mAction != taaCACHED))
+            mWrites->insert (it.first);
+
         switch (it.second.mAction)
         {
         case taaNONE:
@@ -74,6 +82,28 @@ TER TransactionEngine::applyTransaction (
     STTx const& txn,
     TransactionEngineParams params,
     bool& didApply)
+{
+    TER terResult = execute (txn, params, didApply);
+
+    if (didApply)
+        commit (txn, params, terResult);
+
+    mTxnAccount.reset ();
+    mNodes.clear ();
+
+    if (!(params & tapOPEN_LEDGER) && isTemMalformed (terResult))
+    {
+        // XXX Malformed or failed transaction in closed ledger must bow out.
+    }
+
+    return terResult;
+}
+
+// Runs the transaction against mNodes, leaving the changes there
+TER TransactionEngine::execute (
+    STTx const& txn,
+    TransactionEngineParams params,
+    bool& didApply)
 {
     WriteLog (lsTRACE, TransactionEngine) << "applyTransaction>";
     didApply = false;
@@ -196,54 +226,182 @@ TER TransactionEngine::applyTransaction (
             didApply = false;
             terResult = tefINTERNAL;
         }
-        else
-        {
-            // Transaction succeeded fully or (retries are not allowed and the
-            // transaction could claim a fee)
-            Serializer m;
-            mNodes.calcRawMeta (m, terResult, mTxnSeq++);
+    }
 
-            txnWrite ();
+    return terResult;
+}
 
-            Serializer s;
-            txn.add (s);
+// Writes the changes in mNodes and the transaction to the ledger
+void TransactionEngine::commit (
+    STTx const& txn,
+    TransactionEngineParams params,
+    TER terResult)
+{
+    uint256 const& txID = txn.getTransactionID ();
 
-            if (params & tapOPEN_LEDGER)
-            {
-                if (!mLedger->addTransaction (txID, s))
-                {
-                    WriteLog (lsFATAL, TransactionEngine) <<
-                        "Tried to add transaction to open ledger that already had it";
-                    assert (false);
-                    throw std::runtime_error ("Duplicate transaction applied");
-                }
-            }
-            else
-            {
-                if (!mLedger->addTransaction (txID, s, m))
-                {
-                    WriteLog (lsFATAL, TransactionEngine) <<
-                        "Tried to add transaction to ledger that already had it";
-                    assert (false);
-                    throw std::runtime_error ("Duplicate transaction applied to closed ledger");
-                }
+    // Transaction succeeded fully or (retries are not allowed and the
+    // transaction could claim a fee)
+    Serializer m;
+    mNodes.calcRawMeta (m, terResult, mTxnSeq++);
 
-                // Charge whatever fee they specified.
-                STAmount saPaid = txn.getTransactionFee ();
-                mLedger->destroyCoins (saPaid.getNValue ());
-            }
+    txnWrite ();
+
+    Serializer s;
+    txn.add (s);
+
+    if (params & tapOPEN_LEDGER)
+    {
+        if (!mLedger->addTransaction (txID, s))
+        {
+            WriteLog (lsFATAL, TransactionEngine) <<
+                "Tried to add transaction to open ledger that already had it";
+            assert (false);
+            throw std::runtime_error ("Duplicate transaction applied");
         }
     }
+    else
+    {
+        if (!mLedger->addTransaction (txID, s, m))
+        {
+            WriteLog (lsFATAL, TransactionEngine) <<
+                "Tried to add transaction to ledger that already had it";
+            assert (false);
+            throw std::runtime_error ("Duplicate transaction applied to closed ledger");
+        }
+
+        // Charge whatever fee they specified.
+        STAmount saPaid = txn.getTransactionFee ();
+        mLedger->destroyCoins (saPaid.getNValue ());
+    }
+}
+
+void TransactionEngine::speculate (SpeculativeTx& tx)
+{
+    tx.reads = std::make_shared <LedgerEntrySet::Reads> ();
+    mNodes.trackReads (tx.reads);
+
+    try
+    {
+        tx.result = execute (*tx.txn, tx.params, tx.didApply);
+        tx.valid = true;
+    }
+    catch (...)
+    {
+        tx.valid = false;
+    }
+
+    // The set leaves with the read tracker, mNodes gets an empty one
+    tx.nodes.swapWith (mNodes);
+    mNodes.trackReads (nullptr);
 
     mTxnAccount.reset ();
     mNodes.clear ();
+}
 
-    if (!(params & tapOPEN_LEDGER) && isTemMalformed (terResult))
+void TransactionEngine::trackWrites ()
+{
+    mWrites = std::make_unique <std::set <uint256>> ();
+}
+
+bool TransactionEngine::isCurrent (SpeculativeTx const& tx) const
+{
+    if (!tx.valid || !mWrites)
+        return false;
+
+    auto const& writes = *mWrites;
+
+    if (writes.empty ())
+        return true;
+
+    for (auto const& key : tx.reads->keys)
+        if (writes.count (key))
+            return false;
+
+    for (auto const& entry : tx.nodes)
+        if (writes.count (entry.first))
+            return false;
+
+    for (auto const& range : tx.reads->ranges)
     {
-        // XXX Malformed or failed transaction in closed ledger must bow out.
+        auto const it = writes.upper_bound (range.first);
+
+        if ((it != writes.end ()) &&
+                (range.second.isZero () || (*it <= range.second)))
+            return false;
     }
 
-    return terResult;
+    return true;
+}
+
+TER TransactionEngine::applySpeculation (SpeculativeTx& tx, bool& didApply)
+{
+    assert (isCurrent (tx));
+
+    didApply = tx.didApply;
+
+    if (didApply)
+    {
+        mNodes.swapWith (tx.nodes);
+        mNodes.trackReads (nullptr);
+        mNodes.getLedger () = mLedger;
+
+        commit (*tx.txn, tx.params, tx.result);
+    }
+
+    mTxnAccount.reset ();
+    mNodes.clear ();
+
+    return tx.result;
+}
+
+//------------------------------------------------------------------------------
+
+void speculateTransactions (Ledger::ref ledger,
+    std::vector <SpeculativeTx>& txns, JobQueue& jobQueue)
+{
+    // Jobs take transactions one at a time, the calling thread takes them
+    // too so progress does not depend on a free job thread.
+    struct State
+    {
+        std::atomic <std::size_t> next;
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::size_t finished = 0;
+    };
+
+    auto state = std::make_shared <State> ();
+    state->next = 0;
+
+    std::size_t const count = txns.size ();
+
+    // Jobs which start after every transaction was taken do nothing, so
+    // they never touch the transactions after we return.
+    auto work = [state, &txns, ledger, count] ()
+    {
+        TransactionEngine engine (ledger);
+        std::size_t i;
+
+        while ((i = state->next++) < count)
+        {
+            engine.speculate (txns[i]);
+
+            std::lock_guard <std::mutex> lock (state->mutex);
+            if (++state->finished == count)
+                state->cond.notify_all ();
+        }
+    };
+
+    std::size_t const jobs = std::min <std::size_t> (count,
+        std::max (1u, std::thread::hardware_concurrency ()));
+
+    for (std::size_t i = 1; i < jobs; ++i)
+        jobQueue.addJob (jtSPECULATE, "speculateTxns",
+            [work] (Job&) { work (); });
+
+    work ();
+
+    std::unique_lock <std::mutex> lock (state->mutex);
+    state->cond.wait (lock, [&] { return state->finished == count; });
 }
 
 } // ripple
@@ -22,9 +22,31 @@
 
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/ledger/LedgerEntrySet.h>
+#include <ripple/core/JobQueue.h>
+#include <memory>
+#include <set>
+#include <vector>
 
 namespace ripple {
 
+/** A transaction run against a ledger without changing it.
+
+    The entries it would change and everything it looked up in the ledger
+    are kept, so it can be applied later if none of that has changed.
+*/
+struct SpeculativeTx
+{
+    STTx::pointer txn;
+    TransactionEngineParams params = tapNONE;
+
+    // Set once the transaction has run without throwing
+    bool valid = false;
+    TER result = temUNCERTAIN;
+    bool didApply = false;
+    LedgerEntrySet nodes;
+    std::shared_ptr <LedgerEntrySet::Reads> reads;
+};
+
 // A TransactionEngine applies serialized transactions to a ledger
 // It can also, verify signatures, verify fees, and give rejection reasons
 
@@ -42,6 +64,12 @@ private:
     TER setAuthorized (const STTx & txn, bool bMustSetGenerator);
     TER checkSig (const STTx & txn);
 
+    // Keys of the entries written to the ledger, if tracked
+    std::unique_ptr <std::set <uint256>> mWrites;
+
+    TER execute (const STTx&, TransactionEngineParams, bool & didApply);
+    void commit (const STTx&, TransactionEngineParams, TER result);
+
 protected:
     Ledger::pointer     mLedger;
     int                 mTxnSeq;
@@ -99,9 +127,41 @@ public:
     }
 
     TER applyTransaction (const STTx&, TransactionEngineParams, bool & didApply);
+
+    /** Run a transaction without changing the ledger.
+
+        The ledger must not change while any speculation against it runs.
+        Each thread needs its own engine.
+    */
+    void speculate (SpeculativeTx&);
+
+    /** Remember which entries this engine writes from now on. */
+    void trackWrites ();
+
+    /** Returns `true` if a speculation against this engine's ledger is
+        still what applyTransaction would do.
+
+        This holds when nothing the speculation looked up or meant to
+        change has been written since tracking began. Only valid if
+        trackWrites was called before anything was written.
+    */
+    bool isCurrent (SpeculativeTx const&) const;
+
+    /** Apply a current speculation, with the same result and the same
+        changes to the ledger as applyTransaction.
+    */
+    TER applySpeculation (SpeculativeTx&, bool & didApply);
     bool checkInvariants (TER result, const STTx & txn, TransactionEngineParams params);
 };
 
+/** Speculate on each transaction against `ledger`, spread across jobs.
+
+    Returns once every transaction has run. Transactions which are not
+    valid on return threw, and must be applied normally.
+*/
+void speculateTransactions (Ledger::ref ledger,
+    std::vector <SpeculativeTx>& txns, JobQueue& jobQueue);
+
 inline TransactionEngineParams operator| (const TransactionEngineParams& l1, const TransactionEngineParams& l2)
 {
     return static_cast<TransactionEngineParams> (static_cast<int> (l1) | static_cast<int> (l2));
@@ -17,13 +17,15 @@
 */
 //==============================================================================
 
+#include <ripple/app/main/Tuning.h>
 #include <ripple/basics/seconds_clock.h>
 
 namespace ripple {
 
 TransactionMaster::TransactionMaster ()
     : mCache ("TransactionCache", 65536, 1800, get_seconds_clock (),
-        deprecatedLogs().journal("TaggedCache"))
+        deprecatedLogs().journal("TaggedCache"),
+            beast::insight::NullCollector::New (), defaultCachePartitions)
 {
 }
 
@@ -21,6 +21,8 @@
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/resource/Fees.h>
 #include <ripple/rpc/RPCHandler.h>
+#include <ripple/rpc/impl/JsonObject.h>
+#include <ripple/rpc/impl/JsonWriter.h>
 #include <ripple/server/Role.h>
 
 namespace ripple {
@@ -126,12 +128,12 @@ void WSConnection::returnMessage (message_ptr ptr)
     }
 }
 
-Json::Value WSConnection::invokeCommand (Json::Value& jvRequest)
+std::string WSConnection::invokeCommand (Json::Value& jvRequest)
 {
     if (getConsumer().disconnect ())
     {
         disconnect ();
-        return rpcError (rpcSLOW_DOWN);
+        return to_string (rpcError (rpcSLOW_DOWN));
     }
 
     // Requests without "command" are invalid.
@@ -152,7 +154,7 @@ Json::Value WSConnection::invokeCommand (Json::Value& jvRequest)
 
         getConsumer().charge (Resource::feeInvalidRPC);
 
-        return jvResult;
+        return to_string (jvResult);
     }
 
     Resource::Charge loadType = Resource::feeReferenceRPC;
@@ -168,7 +170,35 @@ Json::Value WSConnection::invokeCommand (Json::Value& jvRequest)
     }
     else
     {
-        jvResult[jss::result] = mRPCHandler.doCommand (jvRequest, role, loadType);
+        // Commands that support it write their result straight into the
+        // response text, so large results are never held as a Json::Value.
+        std::string text;
+        bool written;
+        {
+            StringOutput output (text);
+            RPC::New::Writer writer (output);
+            RPC::New::Object::Root root (writer);
+            {
+                auto result = root.makeObject ("result");
+                written = mRPCHandler.writeCommand (
+                    jvRequest, role, loadType, result, jvResult[jss::result]);
+            }
+
+            if (written)
+            {
+                getConsumer().charge (loadType);
+                if (getConsumer().warn ())
+                    root.set ("warning", Json::Value (jss::load));
+
+                root.set ("status", Json::Value (jss::success));
+                if (jvRequest.isMember (jss::id))
+                    root.set ("id", jvRequest[jss::id]);
+                root.set ("type", Json::Value (jss::response));
+            }
+        }
+
+        if (written)
+            return text;
     }
 
     getConsumer().charge (loadType);
@@ -201,7 +231,7 @@ Json::Value WSConnection::invokeCommand (Json::Value& jvRequest)
 
     jvResult[jss::type]        = jss::response;
 
-    return jvResult;
+    return to_string (jvResult);
 }
 
 } // ripple
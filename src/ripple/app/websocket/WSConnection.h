@@ -61,7 +61,9 @@ public:
     message_ptr getMessage ();
     bool checkMessage ();
     void returnMessage (message_ptr ptr);
-    Json::Value invokeCommand (Json::Value& jvRequest);
+
+    // Returns the text of the response to a request
+    std::string invokeCommand (Json::Value& jvRequest);
 
 protected:
     HTTP::Port const& port_;
@@ -143,12 +145,12 @@ public:
             m_serverHandler.send (ptr, jvObj, broadcast);
     }
 
-    void send (Json::Value const& jvObj, std::string const& sObj, bool broadcast)
+    void send (Broadcast const& message)
     {
         connection_ptr ptr = m_connection.lock ();
 
         if (ptr)
-            m_serverHandler.send (ptr, sObj, broadcast);
+            m_serverHandler.send (ptr, message);
     }
 
     void disconnect ()
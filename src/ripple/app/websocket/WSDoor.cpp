@@ -50,17 +50,20 @@ private:
     std::shared_ptr<HTTP::Port> port_;
     Resource::Manager& m_resourceManager;
     InfoSub::Source& m_source;
+    beast::insight::Collector::ptr m_collector;
     LockType m_endpointLock;
     std::shared_ptr<websocketpp::server_autotls> m_endpoint;
 
 public:
     WSDoorImp (HTTP::Port const& port, Resource::Manager& resourceManager,
-        InfoSub::Source& source)
+        InfoSub::Source& source,
+            beast::insight::Collector::ptr const& collector)
         : WSDoor (source)
         , Thread ("websocket")
         , port_(std::make_shared<HTTP::Port>(port))
         , m_resourceManager (resourceManager)
         , m_source (source)
+        , m_collector (collector)
     {
         startThread ();
     }
@@ -80,7 +83,7 @@ private:
 
         websocketpp::server_autotls::handler::ptr handler (
             new WSServerHandler <websocketpp::server_autotls> (
-                port_, m_resourceManager, m_source));
+                port_, m_resourceManager, m_source, m_collector));
 
         {
             ScopedLockType lock (m_endpointLock);
@@ -153,13 +156,15 @@ WSDoor::WSDoor (Stoppable& parent)
 
 std::unique_ptr<WSDoor>
 make_WSDoor (HTTP::Port const& port, Resource::Manager& resourceManager,
-    InfoSub::Source& source)
+    InfoSub::Source& source,
+        beast::insight::Collector::ptr const& collector)
 {
     std::unique_ptr<WSDoor> door;
 
     try
     {
-        door = std::make_unique <WSDoorImp> (port, resourceManager, source);
+        door = std::make_unique <WSDoorImp> (port, resourceManager, source,
+            collector);
     }
     catch (...)
     {
@@ -21,6 +21,7 @@
 #define RIPPLE_WSDOOR_H_INCLUDED
 
 #include <ripple/server/Port.h>
+#include <beast/insight/Collector.h>
 
 namespace ripple {
 
@@ -37,9 +38,13 @@ public:
     //virtual void close() = 0;
 };
 
+/** Create a door for a websocket port.
+    The send queue statistics of the port are reported to the collector.
+*/
 std::unique_ptr<WSDoor>
 make_WSDoor (HTTP::Port const& port, Resource::Manager& resourceManager,
-    InfoSub::Source& source);
+    InfoSub::Source& source,
+        beast::insight::Collector::ptr const& collector);
 
 }
 
@@ -20,9 +20,12 @@
 #ifndef RIPPLE_WSSERVERHANDLER_H_INCLUDED
 #define RIPPLE_WSSERVERHANDLER_H_INCLUDED
 
+#include <ripple/json/json_parser.h>
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/server/Port.h>
 #include <ripple/app/websocket/WSConnection.h>
+#include <beast/insight/Collector.h>
+#include <algorithm>
 #include <memory>
 
 namespace ripple {
@@ -62,9 +65,34 @@ public:
     };
 
 private:
+    struct Stats
+    {
+        explicit Stats (beast::insight::Collector::ptr const& collector)
+        {
+            dropped = collector->make_meter ("dropped");
+            disconnected = collector->make_meter ("disconnected");
+            queue_bytes = collector->make_gauge ("queue_bytes");
+            queue_bytes_max = collector->make_gauge ("queue_bytes_max");
+            queue_messages_max = collector->make_gauge ("queue_messages_max");
+        }
+
+        // Stream messages dropped for, and clients disconnected for,
+        // having too much queued
+        beast::insight::Meter dropped;
+        beast::insight::Meter disconnected;
+
+        // Bytes queued to all clients, and the most queued to one
+        beast::insight::Gauge queue_bytes;
+        beast::insight::Gauge queue_bytes_max;
+        beast::insight::Gauge queue_messages_max;
+
+        beast::insight::Hook hook;
+    };
+
     std::shared_ptr<HTTP::Port> port_;
     Resource::Manager& m_resourceManager;
     InfoSub::Source& m_source;
+    Stats m_stats;
 
 protected:
     // VFALCO TODO Make this private.
@@ -78,11 +106,21 @@ protected:
 
 public:
     WSServerHandler (std::shared_ptr<HTTP::Port> const& port,
-        Resource::Manager& resourceManager, InfoSub::Source& source)
+        Resource::Manager& resourceManager, InfoSub::Source& source,
+            beast::insight::Collector::ptr const& collector)
         : port_(port)
         , m_resourceManager (resourceManager)
         , m_source (source)
+        , m_stats (collector)
+    {
+        m_stats.hook = collector->make_hook (std::bind (
+            &WSServerHandler <endpoint_type>::collect, this));
+    }
+
+    ~WSServerHandler ()
     {
+        // Must unhook before destroying
+        m_stats.hook = beast::insight::Hook ();
     }
 
     WSServerHandler(WSServerHandler const&) = delete;
@@ -133,10 +171,103 @@ public:
 
     void send (connection_ptr cpClient, std::string const& strMessage, bool broadcast)
     {
+        if (broadcast && !admit (cpClient, strMessage.size (), false))
+            return;
+
         cpClient->get_strand ().post (std::bind (
                                           &WSServerHandler<endpoint_type>::ssendb, cpClient, strMessage, broadcast));
     }
 
+    // Sends a published message. Every connection using the same protocol
+    // version is sent one shared, framed buffer.
+    void send (connection_ptr cpClient, InfoSub::Broadcast const& message)
+    {
+        if (!admit (cpClient, message.getText ().size (), message.isReplaceable ()))
+            return;
+
+        // Legacy (hixie) framing differs from the hybi framing
+        int const key = (cpClient->get_version () == 0) ? 1 : 0;
+
+        message_ptr const& frame = message.getFrame <message_ptr> (key,
+            [&message]()
+            {
+                message_ptr frame (new websocketpp::message::data (
+                    websocketpp::message::data::pool_ptr (), 0));
+                frame->reset (websocketpp::frame::opcode::TEXT);
+                frame->set_payload (message.getText ());
+                return frame;
+            });
+
+        WriteLog (lsTRACE, WSServerHandlerLog) <<
+            "Ws:: Sending '" << message.getText () << "'";
+
+        try
+        {
+            // The frame is prepared by the first connection it is sent on,
+            // and queued on each connection's strand without a copy.
+            cpClient->send (frame);
+        }
+        catch (...)
+        {
+            cpClient->close (websocketpp::close::status::value (crTooSlow), std::string ("Client is too slow."));
+        }
+    }
+
+    // Returns true if a stream message may be queued to a client. A client
+    // that is too far behind is sent no more replaceable messages, and is
+    // disconnected by any other.
+    bool admit (connection_ptr const& cpClient, std::size_t size, bool replaceable)
+    {
+        std::uint64_t const maxBytes = getConfig ().WEBSOCKET_QUEUE_BYTES;
+        std::size_t const maxMessages = getConfig ().WEBSOCKET_QUEUE_MESSAGES;
+
+        std::uint64_t const bytes = cpClient->buffered_amount ();
+        std::size_t const messages = cpClient->buffered_messages ();
+
+        if (((maxBytes == 0) || (bytes + size <= maxBytes)) &&
+            ((maxMessages == 0) || (messages < maxMessages)))
+            return true;
+
+        if (replaceable)
+        {
+            ++m_stats.dropped;
+            return false;
+        }
+
+        ++m_stats.disconnected;
+
+        WriteLog (lsINFO, WSServerHandlerLog) <<
+            "Ws:: Disconnecting slow client with " << messages <<
+            " messages, " << bytes << " bytes queued";
+
+        cpClient->close (websocketpp::close::status::value (crTooSlow), std::string ("Client is too slow."));
+        return false;
+    }
+
+    void collect ()
+    {
+        std::uint64_t total = 0;
+        std::uint64_t maxBytes = 0;
+        std::size_t maxMessages = 0;
+
+        {
+            ScopedLockType sl (mLock);
+
+            for (auto const& entry : mMap)
+            {
+                std::uint64_t const bytes = entry.first->buffered_amount ();
+                total += bytes;
+                maxBytes = std::max (maxBytes, bytes);
+                maxMessages = std::max (maxMessages,
+                    entry.first->buffered_messages ());
+            }
+        }
+
+        m_stats.queue_bytes = total;
+        m_stats.queue_bytes_max = maxBytes;
+        m_stats.queue_messages_max = maxMessages;
+    }
+
     void send (connection_ptr cpClient, Json::Value const& jvObj, bool broadcast)
     {
         // WriteLog (lsDEBUG, WSServerHandlerLog) << "Ws:: Object '" << jfwWriter.write(jvObj) << "'";
@@ -360,7 +491,7 @@ public:
     bool do_message (Job& job, const connection_ptr& cpClient, const wsc_ptr& conn, const message_ptr& mpMessage)
     {
         Json::Value     jvRequest;
-        Json::Reader    jrReader;
+        Json::Parser    jpParser;
 
         try
         {
@@ -381,7 +512,7 @@ public:
 
             send (cpClient, jvResult, false);
         }
-        else if (!jrReader.parse (mpMessage->get_payload (), jvRequest) || jvRequest.isNull () || !jvRequest.isObject ())
+        else if (!jpParser.parse (mpMessage->get_payload (), jvRequest) || jvRequest.isNull () || !jvRequest.isObject ())
         {
             Json::Value jvResult (Json::objectValue);
 
@@ -0,0 +1,43 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_ALLOCATIONCOUNTER_H_INCLUDED
+#define RIPPLE_BASICS_ALLOCATIONCOUNTER_H_INCLUDED
+
+#include <cstdint>
+
+namespace ripple {
+
+/** Returns true if heap allocations are being counted.
+
+    Counting replaces the global operator new, so it is only compiled in
+    when RIPPLE_COUNT_ALLOCATIONS is set. It is meant for benchmarks.
+*/
+bool isCountingAllocations ();
+
+/** Returns the number of heap allocations made by the calling thread.
+
+    This is always zero unless allocations are being counted. Take the
+    difference of two calls to measure a piece of code.
+*/
+std::uint64_t getThreadAllocations ();
+
+}
+
+#endif
@@ -25,7 +25,10 @@
 #include <beast/chrono/chrono_io.h>
 #include <beast/Insight.h>
 #include <beast/container/hardened_hash.h>
+#include <algorithm>
+#include <cassert>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -43,6 +46,12 @@ struct TaggedCacheLog;
     If it stays in memory even after it is ejected from the cache,
     the map will track it.
 
+    The cache may be split into partitions, selected by the hash of the key.
+    Each partition has its own lock, map and counters, so that threads
+    working on different keys do not contend. Sweeping visits one partition
+    at a time, a slice of buckets per lock acquisition, and releases evicted
+    objects outside the lock.
+
     @note Callers must not modify data objects that are stored in the cache
           unless they hold their own lock over all cache operations.
 */
@@ -69,11 +78,18 @@ public:
     typedef std::shared_ptr <mapped_type> mapped_ptr;
     typedef beast::abstract_clock <std::chrono::steady_clock> clock_type;
 
+    enum
+    {
+        // Number of hash buckets swept per lock acquisition
+        sweepSliceBuckets = 1024
+    };
+
 public:
     // VFALCO TODO Change expiration_seconds to clock_type::duration
     TaggedCache (std::string const& name, int size,
         clock_type::rep expiration_seconds, clock_type& clock, beast::Journal journal,
-            beast::insight::Collector::ptr const& collector = beast::insight::NullCollector::New ())
+            beast::insight::Collector::ptr const& collector = beast::insight::NullCollector::New (),
+                int partitions = 1)
         : m_journal (journal)
         , m_clock (clock)
         , m_stats (name,
@@ -82,9 +98,9 @@ public:
         , m_name (name)
         , m_target_size (size)
         , m_target_age (std::chrono::seconds (expiration_seconds))
-        , m_cache_count (0)
-        , m_hits (0)
-        , m_misses (0)
+        , m_sweep_hold (0)
+        , m_partition_count (std::max (partitions, 1))
+        , m_partitions (new Partition [m_partition_count])
     {
     }
 
@@ -95,19 +111,38 @@ public:
         return m_clock;
     }
 
+    /** Return the number of independently locked partitions. */
+    int getPartitionCount () const
+    {
+        return m_partition_count;
+    }
+
     int getTargetSize () const
     {
-        lock_guard lock (m_mutex);
+        std::lock_guard <std::mutex> lock (m_settings_mutex);
         return m_target_size;
     }
 
     void setTargetSize (int s)
     {
-        lock_guard lock (m_mutex);
-        m_target_size = s;
+        {
+            std::lock_guard <std::mutex> lock (m_settings_mutex);
+            m_target_size = s;
+        }
 
         if (s > 0)
-            m_cache.rehash (static_cast<std::size_t> ((s + (s >> 2)) / m_cache.max_load_factor () + 1));
+        {
+            int const partitionSize = s / m_partition_count + 1;
+
+            for (int i = 0; i < m_partition_count; ++i)
+            {
+                Partition& p = m_partitions[i];
+                lock_guard lock (p.mutex);
+                p.cache.rehash (static_cast<std::size_t> (
+                    (partitionSize + (partitionSize >> 2)) /
+                        p.cache.max_load_factor () + 1));
+            }
+        }
 
         if (m_journal.debug) m_journal.debug <<
             m_name << " target size set to " << s;
@@ -115,13 +150,13 @@ public:
 
     clock_type::rep getTargetAge () const
     {
-        lock_guard lock (m_mutex);
+        std::lock_guard <std::mutex> lock (m_settings_mutex);
         return m_target_age.count();
     }
 
     void setTargetAge (clock_type::rep s)
     {
-        lock_guard lock (m_mutex);
+        std::lock_guard <std::mutex> lock (m_settings_mutex);
         m_target_age = std::chrono::seconds (s);
         if (m_journal.debug) m_journal.debug <<
             m_name << " target age set to " << m_target_age;
@@ -129,136 +164,109 @@ public:
 
     int getCacheSize ()
     {
-        lock_guard lock (m_mutex);
-        return m_cache_count;
+        int count = 0;
+        for (int i = 0; i < m_partition_count; ++i)
+        {
+            Partition& p = m_partitions[i];
+            lock_guard lock (p.mutex);
+            count += p.cache_count;
+        }
+        return count;
     }
 
     int getTrackSize ()
     {
-        lock_guard lock (m_mutex);
-        return m_cache.size ();
+        int count = 0;
+        for (int i = 0; i < m_partition_count; ++i)
+        {
+            Partition& p = m_partitions[i];
+            lock_guard lock (p.mutex);
+            count += p.cache.size ();
+        }
+        return count;
     }
 
     float getHitRate ()
     {
-        lock_guard lock (m_mutex);
-        auto const total = static_cast<float> (m_hits + m_misses);
-        return m_hits * (100.0f / std::max (1.0f, total));
+        std::uint64_t hits;
+        std::uint64_t misses;
+        getHitsAndMisses (hits, misses);
+        auto const total = static_cast<float> (hits + misses);
+        return hits * (100.0f / std::max (1.0f, total));
     }
 
     void clearStats ()
     {
-        lock_guard lock (m_mutex);
-        m_hits = 0;
-        m_misses = 0;
+        for (int i = 0; i < m_partition_count; ++i)
+        {
+            Partition& p = m_partitions[i];
+            lock_guard lock (p.mutex);
+            p.hits = 0;
+            p.misses = 0;
+        }
     }
 
     void clear ()
     {
-        lock_guard lock (m_mutex);
-        m_cache.clear ();
-        m_cache_count = 0;
+        for (int i = 0; i < m_partition_count; ++i)
+        {
+            Partition& p = m_partitions[i];
+            lock_guard lock (p.mutex);
+            p.cache.clear ();
+            p.cache_count = 0;
+        }
     }
 
     void sweep ()
     {
         int cacheRemovals = 0;
         int mapRemovals = 0;
-        int cc = 0;
+        int trackSize = 0;
 
-        // Keep references to all the stuff we sweep
-        // so that we can destroy them outside the lock.
-        //
-        std::vector <mapped_ptr> stuffToSweep;
+        clock_type::time_point const now (m_clock.now());
+        int targetSize;
+        clock_type::duration targetAge;
 
         {
-            clock_type::time_point const now (m_clock.now());
-            clock_type::time_point when_expire;
-
-            lock_guard lock (m_mutex);
-
-            if (m_target_size == 0 ||
-                (static_cast<int> (m_cache.size ()) <= m_target_size))
-            {
-                when_expire = now - m_target_age;
-            }
-            else
-            {
-                when_expire = now - clock_type::duration (
-                    m_target_age.count() * m_target_size / m_cache.size ());
-
-                clock_type::duration const minimumAge (
-                    std::chrono::seconds (1));
-                if (when_expire > (now - minimumAge))
-                    when_expire = now - minimumAge;
-
-                if (m_journal.trace) m_journal.trace <<
-                    m_name << " is growing fast " << m_cache.size () << " of " << m_target_size <<
-                        " aging at " << (now - when_expire) << " of " << m_target_age;
-            }
+            std::lock_guard <std::mutex> lock (m_settings_mutex);
+            targetSize = m_target_size;
+            targetAge = m_target_age;
+        }
 
-            stuffToSweep.reserve (m_cache.size ());
+        std::chrono::steady_clock::duration maxHold (0);
 
-            cache_iterator cit = m_cache.begin ();
+        for (int i = 0; i < m_partition_count; ++i)
+            sweepPartition (m_partitions[i], now, targetSize, targetAge,
+                cacheRemovals, mapRemovals, trackSize, maxHold);
 
-            while (cit != m_cache.end ())
-            {
-                if (cit->second.isWeak ())
-                {
-                    // weak
-                    if (cit->second.isExpired ())
-                    {
-                        ++mapRemovals;
-                        cit = m_cache.erase (cit);
-                    }
-                    else
-                    {
-                        ++cit;
-                    }
-                }
-                else if (cit->second.last_access <= when_expire)
-                {
-                    // strong, expired
-                    --m_cache_count;
-                    ++cacheRemovals;
-                    if (cit->second.ptr.unique ())
-                    {
-                        stuffToSweep.push_back (cit->second.ptr);
-                        ++mapRemovals;
-                        cit = m_cache.erase (cit);
-                    }
-                    else
-                    {
-                        // remains weakly cached
-                        cit->second.ptr.reset ();
-                        ++cit;
-                    }
-                }
-                else
-                {
-                    // strong, not expired
-                    ++cc;
-                    ++cit;
-                }
-            }
+        {
+            std::lock_guard <std::mutex> lock (m_settings_mutex);
+            m_sweep_hold = maxHold;
         }
 
         if (m_journal.trace && (mapRemovals || cacheRemovals)) m_journal.trace <<
-            m_name << ": cache = " << m_cache.size () << "-" << cacheRemovals <<
-                ", map-=" << mapRemovals;
+            m_name << ": cache = " << trackSize << "-" << cacheRemovals <<
+                ", map-=" << mapRemovals << ", held " <<
+                    std::chrono::duration_cast <std::chrono::microseconds> (
+                        maxHold).count () << "us";
+    }
 
-        // At this point stuffToSweep will go out of scope outside the lock
-        // and decrement the reference count on each strong pointer.
+    /** Return the longest time the last sweep held a partition lock. */
+    std::chrono::steady_clock::duration getSweepHoldTime () const
+    {
+        std::lock_guard <std::mutex> lock (m_settings_mutex);
+        return m_sweep_hold;
     }
 
     bool del (const key_type& key, bool valid)
     {
         // Remove from cache, if !valid, remove from map too. Returns true if removed from cache
-        lock_guard lock (m_mutex);
+        Partition& p = partition (key);
+        lock_guard lock (p.mutex);
 
-        cache_iterator cit = m_cache.find (key);
+        cache_iterator cit = p.cache.find (key);
 
-        if (cit == m_cache.end ())
+        if (cit == p.cache.end ())
             return false;
 
         Entry& entry = cit->second;
@@ -267,13 +275,13 @@ public:
 
         if (entry.isCached ())
         {
-            --m_cache_count;
+            --p.cache_count;
             entry.ptr.reset ();
             ret = true;
         }
 
         if (!valid || entry.isExpired ())
-            m_cache.erase (cit);
+            p.cache.erase (cit);
 
         return ret;
     }
@@ -295,16 +303,17 @@ public:
     {
         // Return canonical value, store if needed, refresh in cache
         // Return values: true=we had the data already
-        lock_guard lock (m_mutex);
+        Partition& p = partition (key);
+        lock_guard lock (p.mutex);
 
-        cache_iterator cit = m_cache.find (key);
+        cache_iterator cit = p.cache.find (key);
 
-        if (cit == m_cache.end ())
+        if (cit == p.cache.end ())
         {
-            m_cache.emplace (std::piecewise_construct,
+            p.cache.emplace (std::piecewise_construct,
                 std::forward_as_tuple(key),
                 std::forward_as_tuple(m_clock.now(), data));
-            ++m_cache_count;
+            ++p.cache_count;
             return false;
         }
 
@@ -341,13 +350,13 @@ public:
                 data = cachedData;
             }
 
-            ++m_cache_count;
+            ++p.cache_count;
             return true;
         }
 
         entry.ptr = data;
         entry.weak_ptr = data;
-        ++m_cache_count;
+        ++p.cache_count;
 
         return false;
     }
@@ -355,13 +364,14 @@ public:
     std::shared_ptr<T> fetch (const key_type& key)
     {
         // fetch us a shared pointer to the stored data object
-        lock_guard lock (m_mutex);
+        Partition& p = partition (key);
+        lock_guard lock (p.mutex);
 
-        cache_iterator cit = m_cache.find (key);
+        cache_iterator cit = p.cache.find (key);
 
-        if (cit == m_cache.end ())
+        if (cit == p.cache.end ())
         {
-            ++m_misses;
+            ++p.misses;
             return mapped_ptr ();
         }
 
@@ -370,7 +380,7 @@ public:
 
         if (entry.isCached ())
         {
-            ++m_hits;
+            ++p.hits;
             return entry.ptr;
         }
 
@@ -379,12 +389,12 @@ public:
         if (entry.isCached ())
         {
             // independent of cache size, so not counted as a hit
-            ++m_cache_count;
+            ++p.cache_count;
             return entry.ptr;
         }
 
-        m_cache.erase (cit);
-        ++m_misses;
+        p.cache.erase (cit);
+        ++p.misses;
         return mapped_ptr ();
     }
 
@@ -426,11 +436,12 @@ public:
         bool found = false;
 
         // If present, make current in cache
-        lock_guard lock (m_mutex);
+        Partition& p = partition (key);
+        lock_guard lock (p.mutex);
 
-        cache_iterator cit = m_cache.find (key);
+        cache_iterator cit = p.cache.find (key);
 
-        if (cit != m_cache.end ())
+        if (cit != p.cache.end ())
         {
             Entry& entry = cit->second;
 
@@ -442,7 +453,7 @@ public:
                 if (entry.isCached ())
                 {
                     // We just put the object back in cache
-                    ++m_cache_count;
+                    ++p.cache_count;
                     entry.touch (m_clock.now());
                     found = true;
                 }
@@ -450,7 +461,7 @@ public:
                 {
                     // Couldn't get strong pointer,
                     // object fell out of the cache so remove the entry.
-                    m_cache.erase (cit);
+                    p.cache.erase (cit);
                 }
             }
             else
@@ -468,19 +479,25 @@ public:
         return found;
     }
 
+    /** Return the mutex which protects the cache.
+        This is only meaningful for caches with a single partition.
+    */
     mutex_type& peekMutex ()
     {
-        return m_mutex;
+        assert (m_partition_count == 1);
+        return m_partitions[0].mutex;
     }
 
     std::vector <key_type> getKeys ()
     {
         std::vector <key_type> v;
 
+        for (int i = 0; i < m_partition_count; ++i)
         {
-            lock_guard lock (m_mutex);
-            v.reserve (m_cache.size());
-            for (auto const& _ : m_cache)
+            Partition& p = m_partitions[i];
+            lock_guard lock (p.mutex);
+            v.reserve (v.size () + p.cache.size());
+            for (auto const& _ : p.cache)
                 v.push_back (_.first);
         }
 
@@ -488,6 +505,19 @@ public:
     }
 
 private:
+    void getHitsAndMisses (std::uint64_t& hits, std::uint64_t& misses)
+    {
+        hits = 0;
+        misses = 0;
+        for (int i = 0; i < m_partition_count; ++i)
+        {
+            Partition& p = m_partitions[i];
+            lock_guard lock (p.mutex);
+            hits += p.hits;
+            misses += p.misses;
+        }
+    }
+
     void collect_metrics ()
     {
         m_stats.size.set (getCacheSize ());
@@ -495,13 +525,18 @@ private:
         {
             beast::insight::Gauge::value_type hit_rate (0);
             {
-                lock_guard lock (m_mutex);
-                auto const total (m_hits + m_misses);
+                std::uint64_t hits;
+                std::uint64_t misses;
+                getHitsAndMisses (hits, misses);
+                auto const total (hits + misses);
                 if (total != 0)
-                    hit_rate = (m_hits * 100) / total;
+                    hit_rate = (hits * 100) / total;
             }
             m_stats.hit_rate.set (hit_rate);
         }
+
+        m_stats.sweep_hold.set (std::chrono::duration_cast <
+            std::chrono::microseconds> (getSweepHoldTime ()).count ());
     }
 
 private:
@@ -513,11 +548,13 @@ private:
             : hook (collector->make_hook (handler))
             , size (collector->make_gauge (prefix, "size"))
             , hit_rate (collector->make_gauge (prefix, "hit_rate"))
+            , sweep_hold (collector->make_gauge (prefix, "sweep_hold_us"))
             { }
 
         beast::insight::Hook hook;
         beast::insight::Gauge size;
         beast::insight::Gauge hit_rate;
+        beast::insight::Gauge sweep_hold;
     };
 
     class Entry
@@ -545,11 +582,152 @@ private:
     typedef hardened_hash_map <key_type, Entry, Hash, KeyEqual> cache_type;
     typedef typename cache_type::iterator cache_iterator;
 
+    // One independently locked slice of the cache
+    struct Partition
+    {
+        mutex_type mutex;
+
+        // Number of items cached
+        int cache_count = 0;
+        cache_type cache;  // Hold strong reference to recent objects
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+    };
+
+    Partition& partition (key_type const& key)
+    {
+        if (m_partition_count == 1)
+            return m_partitions[0];
+        return m_partitions[m_hash (key) % m_partition_count];
+    }
+
+    void sweepPartition (Partition& p, clock_type::time_point const& now,
+        int targetSize, clock_type::duration const& targetAge,
+            int& cacheRemovals, int& mapRemovals, int& trackSize,
+                std::chrono::steady_clock::duration& maxHold)
+    {
+        clock_type::time_point when_expire;
+        std::size_t bucket = 0;
+        bool first = true;
+
+        // The partition is swept a slice of buckets at a time, releasing
+        // the lock in between. A rehash while the lock is released may
+        // cause some entries to be visited twice or not at all, which
+        // only delays their removal until the next sweep.
+        while (true)
+        {
+            // Keep references to all the stuff we sweep
+            // so that we can destroy them outside the lock.
+            //
+            std::vector <mapped_ptr> stuffToSweep;
+
+            {
+                lock_guard lock (p.mutex);
+                auto const start = std::chrono::steady_clock::now ();
+
+                if (first)
+                {
+                    when_expire = getExpiration (p, now,
+                        targetSize, targetAge);
+                    first = false;
+                }
+
+                std::size_t const bucketCount = p.cache.bucket_count ();
+
+                if (bucket >= bucketCount)
+                {
+                    trackSize += p.cache.size ();
+                    break;
+                }
+
+                std::size_t const end = std::min <std::size_t> (
+                    bucketCount, bucket + sweepSliceBuckets);
+
+                for (; bucket < end; ++bucket)
+                {
+                    auto lit = p.cache.begin (bucket);
+
+                    while (lit != p.cache.end (bucket))
+                    {
+                        auto const cit = lit++;
+                        Entry& entry = cit->second;
+
+                        if (entry.isWeak ())
+                        {
+                            // weak
+                            if (entry.isExpired ())
+                            {
+                                ++mapRemovals;
+                                key_type const key (cit->first);
+                                p.cache.erase (key);
+                            }
+                        }
+                        else if (entry.last_access <= when_expire)
+                        {
+                            // strong, expired
+                            --p.cache_count;
+                            ++cacheRemovals;
+                            if (entry.ptr.unique ())
+                            {
+                                stuffToSweep.push_back (std::move (entry.ptr));
+                                ++mapRemovals;
+                                key_type const key (cit->first);
+                                p.cache.erase (key);
+                            }
+                            else
+                            {
+                                // remains weakly cached
+                                entry.ptr.reset ();
+                            }
+                        }
+                    }
+                }
+
+                maxHold = std::max (maxHold,
+                    std::chrono::steady_clock::now () - start);
+            }
+
+            // At this point stuffToSweep will go out of scope outside the lock
+            // and decrement the reference count on each strong pointer.
+        }
+    }
+
+    // Returns the access time before which strong entries are evicted
+    clock_type::time_point getExpiration (Partition& p,
+        clock_type::time_point const& now, int targetSize,
+            clock_type::duration const& targetAge)
+    {
+        // Each partition gets an equal share of the target size
+        int const partitionTarget = (targetSize + m_partition_count - 1) /
+            m_partition_count;
+
+        if (partitionTarget == 0 ||
+            (static_cast<int> (p.cache.size ()) <= partitionTarget))
+        {
+            return now - targetAge;
+        }
+
+        clock_type::time_point when_expire = now - clock_type::duration (
+            targetAge.count() * partitionTarget / p.cache.size ());
+
+        clock_type::duration const minimumAge (
+            std::chrono::seconds (1));
+        if (when_expire > (now - minimumAge))
+            when_expire = now - minimumAge;
+
+        if (m_journal.trace) m_journal.trace <<
+            m_name << " is growing fast " << p.cache.size () << " of " << partitionTarget <<
+                " aging at " << (now - when_expire) << " of " << targetAge;
+
+        return when_expire;
+    }
+
     beast::Journal m_journal;
     clock_type& m_clock;
     Stats m_stats;
 
-    mutex_type mutable m_mutex;
+    // Protects the target size and age and the sweep statistics
+    std::mutex mutable m_settings_mutex;
 
     // Used for logging
     std::string m_name;
@@ -560,11 +738,13 @@ private:
     // Desired maximum cache age
     clock_type::duration m_target_age;
 
-    // Number of items cached
-    int m_cache_count;
-    cache_type m_cache;  // Hold strong reference to recent objects
-    std::uint64_t m_hits;
-    std::uint64_t m_misses;
+    // Longest time the last sweep held a partition lock
+    std::chrono::steady_clock::duration m_sweep_hold;
+
+    // Selects the partition for a key
+    Hash m_hash;
+    int const m_partition_count;
+    std::unique_ptr <Partition[]> m_partitions;
 };
 
 }
@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/AllocationCounter.h>
+#include <beast/Config.h>
+#include <cstdlib>
+#include <new>
+
+namespace ripple {
+
+#if RIPPLE_COUNT_ALLOCATIONS
+
+namespace detail {
+
+// Compiler thread locals, since operator new must not allocate
+#if BEAST_MSVC
+static __declspec(thread) std::uint64_t threadAllocations;
+#else
+static __thread std::uint64_t threadAllocations;
+#endif
+
+void*
+countedAllocate (std::size_t size)
+{
+    ++threadAllocations;
+
+    void* const p = std::malloc (size != 0 ? size : 1);
+    if (p == nullptr)
+        throw std::bad_alloc ();
+    return p;
+}
+
+}
+
+bool
+isCountingAllocations ()
+{
+    return true;
+}
+
+std::uint64_t
+getThreadAllocations ()
+{
+    return detail::threadAllocations;
+}
+
+#else
+
+bool
+isCountingAllocations ()
+{
+    return false;
+}
+
+std::uint64_t
+getThreadAllocations ()
+{
+    return 0;
+}
+
+#endif
+
+}
+
+#if RIPPLE_COUNT_ALLOCATIONS
+
+void*
+operator new (std::size_t size)
+{
+    return ripple::detail::countedAllocate (size);
+}
+
+void*
+operator new[] (std::size_t size)
+{
+    return ripple::detail::countedAllocate (size);
+}
+
+void
+operator delete (void* p) noexcept
+{
+    std::free (p);
+}
+
+void
+operator delete[] (void* p) noexcept
+{
+    std::free (p);
+}
+
+#endif
@@ -18,9 +18,17 @@
 //==============================================================================
 
 #include <ripple/basics/TaggedCache.h>
-
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/types/base_uint.h>
+#include <ripple/types/Blob.h>
 #include <beast/unit_test/suite.h>
 #include <beast/chrono/manual_clock.h>
+#include <beast/module/core/text/LexicalCast.h>
+#include <boost/algorithm/string.hpp>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
 
 namespace ripple {
 
@@ -37,8 +45,10 @@ original object.
 class TaggedCache_test : public beast::unit_test::suite
 {
 public:
-    void run ()
+    void testCache (int partitions)
     {
+        testcase ("partitions " + std::to_string (partitions));
+
         beast::Journal const j;
 
         beast::manual_clock <std::chrono::steady_clock> clock;
@@ -48,7 +58,8 @@ public:
         typedef std::string Value;
         typedef TaggedCache <Key, Value> Cache;
 
-        Cache c ("test", 1, 1, clock, j);
+        Cache c ("test", 1, 1, clock, j,
+            beast::insight::NullCollector::New (), partitions);
 
         // Insert an item, retrieve it, and age it so it gets purged.
         {
@@ -143,9 +154,145 @@ public:
             expect (c.getCacheSize() == 0);
             expect (c.getTrackSize() == 0);
         }
+
+        // Keys spread over every partition are all found again
+        {
+            for (int i = 0; i < 100; ++i)
+                expect (! c.insert (100 + i, std::to_string (i)));
+            expect (c.getCacheSize() == 100);
+            expect (c.getTrackSize() == 100);
+            expect (c.getKeys().size() == 100);
+
+            std::string s;
+            expect (c.retrieve (142, s));
+            expect (s == "42");
+
+            ++clock;
+            c.sweep ();
+            expect (c.getCacheSize() == 0);
+            expect (c.getTrackSize() == 0);
+        }
+
+        // Sweep a table larger than one slice, keeping some entries alive
+        {
+            std::vector <Cache::mapped_ptr> held;
+            for (int i = 0; i < 5000; ++i)
+            {
+                expect (! c.insert (1000 + i, "many"));
+                if ((i % 10) == 0)
+                    held.push_back (c.fetch (1000 + i));
+            }
+            expect (c.getCacheSize() == 5000);
+
+            ++clock;
+            c.sweep ();
+            expect (c.getCacheSize() == 0);
+            expect (c.getTrackSize() == 500);
+
+            held.clear ();
+            ++clock;
+            c.sweep ();
+            expect (c.getTrackSize() == 0);
+        }
+    }
+
+    void run ()
+    {
+        testCache (1);
+        testCache (4);
     }
 };
 
 BEAST_DEFINE_TESTSUITE(TaggedCache,common,ripple);
 
+//------------------------------------------------------------------------------
+
+/** Measures lock contention on a TaggedCache shared by many threads.
+
+    Each thread performs a mix of fetch and canonicalize calls on random
+    keys, the way the node caches are used during ledger acquisition.
+    The argument is a comma separated list of key/value pairs:
+
+        threads=16,ops=200000,keys=65536,partitions=1;16
+*/
+class TaggedCacheContention_test : public beast::unit_test::suite
+{
+public:
+    typedef TaggedCache <uint256, Blob> Cache;
+
+    double runThreads (Cache& cache, int threads, int ops, int keys)
+    {
+        std::vector <std::thread> workers;
+        workers.reserve (threads);
+
+        auto const start = std::chrono::steady_clock::now ();
+
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back ([&cache, t, ops, keys]
+            {
+                std::minstd_rand r (t + 1);
+                for (int i = 0; i < ops; ++i)
+                {
+                    uint256 key (r () % keys);
+                    if (! cache.fetch (key))
+                    {
+                        auto data = std::make_shared <Blob> (32);
+                        cache.canonicalize (key, data);
+                    }
+                }
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join ();
+
+        return std::chrono::duration_cast <std::chrono::duration <double>> (
+            std::chrono::steady_clock::now () - start).count ();
+    }
+
+    void run ()
+    {
+        auto params = parseDelimitedKeyValueString (arg (), ',');
+
+        int threads = 16;
+        int ops = 200000;
+        int keys = 65536;
+        std::vector <std::string> partitions = {"1", "16"};
+
+        if (! params["threads"].isEmpty ())
+            threads = params["threads"].getIntValue ();
+        if (! params["ops"].isEmpty ())
+            ops = params["ops"].getIntValue ();
+        if (! params["keys"].isEmpty ())
+            keys = params["keys"].getIntValue ();
+        if (! params["partitions"].isEmpty ())
+            boost::split (partitions, params["partitions"].toStdString (),
+                boost::algorithm::is_any_of (";"));
+
+        beast::Journal const j;
+        beast::manual_clock <std::chrono::steady_clock> clock;
+
+        for (auto const& p : partitions)
+        {
+            int const count = beast::lexicalCastThrow <int> (p);
+            Cache cache ("bench", keys, 60, clock, j,
+                beast::insight::NullCollector::New (), count);
+
+            double const elapsed = runThreads (cache, threads, ops, keys);
+
+            std::stringstream ss;
+            ss << std::setprecision (2) << std::fixed <<
+                count << " partitions, " << threads << " threads: " <<
+                    elapsed << "s, " << (threads * ops / elapsed / 1000000) <<
+                        "M ops/s";
+            log << ss.str ();
+        }
+
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(TaggedCacheContention,bench,ripple);
+
 }
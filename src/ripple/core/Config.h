@@ -260,6 +260,8 @@ public:
     unsigned int                PEERS_MAX;
 
     int                         WEBSOCKET_PING_FREQ;
+    std::uint64_t               WEBSOCKET_QUEUE_BYTES;      // Most bytes queued to a subscriber, 0 for no limit
+    std::size_t                 WEBSOCKET_QUEUE_MESSAGES;   // Most messages queued to a subscriber, 0 for no limit
 
     // RPC parameters
     std::vector<beast::IP::Endpoint>   RPC_ADMIN_ALLOW;
@@ -292,8 +294,15 @@ public:
     // Node storage configuration
     std::uint32_t                      LEDGER_HISTORY;
     std::uint32_t                      FETCH_DEPTH;
+    int                                LEDGER_FETCH_WINDOW;    // Most node requests outstanding to a peer
     int                         NODE_SIZE;
 
+    // Job queue threads steal tasks from each other
+    bool                        WORK_STEALING;
+
+    // Run a closing ledger's transactions in parallel
+    bool                        PARALLEL_APPLY;
+
     // Client behavior
     int                         ACCOUNT_PROBE_MAX;      // How far to scan for accounts.
 
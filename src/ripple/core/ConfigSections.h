@@ -42,6 +42,7 @@ struct ConfigSection
 #define SECTION_FEE_ACCOUNT_RESERVE     "fee_account_reserve"
 #define SECTION_FEE_OWNER_RESERVE       "fee_owner_reserve"
 #define SECTION_FETCH_DEPTH             "fetch_depth"
+#define SECTION_LEDGER_FETCH_WINDOW     "ledger_fetch_window"
 #define SECTION_LEDGER_HISTORY          "ledger_history"
 #define SECTION_INSIGHT                 "insight"
 #define SECTION_IPS                     "ips"
@@ -49,6 +50,7 @@ struct ConfigSection
 #define SECTION_NETWORK_QUORUM          "network_quorum"
 #define SECTION_NODE_SEED               "node_seed"
 #define SECTION_NODE_SIZE               "node_size"
+#define SECTION_PARALLEL_APPLY          "parallel_apply"
 #define SECTION_PATH_SEARCH_OLD         "path_search_old"
 #define SECTION_PATH_SEARCH             "path_search"
 #define SECTION_PATH_SEARCH_FAST        "path_search_fast"
@@ -70,6 +72,9 @@ struct ConfigSection
 #define SECTION_VALIDATION_QUORUM       "validation_quorum"
 #define SECTION_VALIDATION_SEED         "validation_seed"
 #define SECTION_WEBSOCKET_PING_FREQ     "websocket_ping_frequency"
+#define SECTION_WEBSOCKET_QUEUE_BYTES   "websocket_queue_bytes"
+#define SECTION_WEBSOCKET_QUEUE_MESSAGES "websocket_queue_messages"
+#define SECTION_WORK_STEALING           "work_stealing"
 #define SECTION_VALIDATORS              "validators"
 #define SECTION_VALIDATORS_SITE         "validators_site"
 
@@ -48,6 +48,7 @@ enum JobType
     jtCLIENT,        // A websocket command from the client
     jtRPC,           // A websocket command from the client
     jtUPDATE_PF,     // Update pathfinding requests
+    jtTXN_VERIFY,    // Check the signatures of received transactions
     jtTRANSACTION,   // A transaction received from the network
     jtUNL,           // A Score or Fetch of the UNL (DEPRECATED)
     jtADVANCE,       // Advance validated/acquired ledgers
@@ -57,6 +58,8 @@ enum JobType
     jtVALIDATION_t,  // A validation from a trusted source
     jtWRITE,         // Write out hashed objects
     jtACCEPT,        // Accept a consensus ledger
+    jtSPECULATE,     // Run part of an accepted ledger's transactions
+    jtFLUSH_MAP,     // Hash and write part of an accepted ledger's map
     jtPROPOSAL_t,    // A proposal from a trusted source
     jtSWEEP,         // Sweep for stale structures
     jtNETOP_CLUSTER, // NetworkOPs cluster peer report
@@ -54,7 +54,8 @@ public:
 
     virtual void shutdown () = 0;
 
-    virtual void setThreadCount (int c, bool const standaloneMode) = 0;
+    virtual void setThreadCount (int c, bool const standaloneMode,
+        bool const workStealing) = 0;
 
     // VFALCO TODO Rename these to newLoadEventMeasurement or something similar
     //             since they create the object.
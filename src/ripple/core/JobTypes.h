@@ -79,6 +79,10 @@ public:
         add (jtRPC,           "RPC",
             maxLimit, false,  false, 0,     0);
 
+        // Check the signatures of received transactions
+        add (jtTXN_VERIFY,    "verifyTransaction",
+            maxLimit, true,   false, 250,   1000);
+
         // A transaction received from the network
         add (jtTRANSACTION,   "transaction",
             maxLimit, true,   false, 250,   1000);
@@ -115,6 +119,14 @@ public:
         add (jtACCEPT,        "acceptLedger",
             maxLimit, false,  false, 0,     0);
 
+        // Run part of an accepted ledger's transactions
+        add (jtSPECULATE,     "speculateTxns",
+            maxLimit, false,  false, 0,     0);
+
+        // Hash and write part of an accepted ledger's map
+        add (jtFLUSH_MAP,     "flushMap",
+            maxLimit, false,  false, 0,     0);
+
         // A proposal from a trusted source
         add (jtPROPOSAL_t,    "trustedProposal",
             maxLimit, false,  false, 100,   500);
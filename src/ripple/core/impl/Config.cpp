@@ -229,6 +229,8 @@ Config::Config ()
     //
 
     WEBSOCKET_PING_FREQ     = (5 * 60);
+    WEBSOCKET_QUEUE_BYTES   = 16 * 1024 * 1024;
+    WEBSOCKET_QUEUE_MESSAGES = 4096;
 
     RPC_ADMIN_ALLOW.push_back (beast::IP::Endpoint::from_string("127.0.0.1"));
 
@@ -248,6 +250,7 @@ Config::Config ()
 
     LEDGER_HISTORY          = 256;
     FETCH_DEPTH             = 1000000000;
+    LEDGER_FETCH_WINDOW     = 8;
 
     // An explanation of these magical values would be nice.
     PATH_SEARCH_OLD         = 7;
@@ -262,6 +265,8 @@ Config::Config ()
     SSL_VERIFY              = true;
 
     ELB_SUPPORT             = false;
+    WORK_STEALING           = false;
+    PARALLEL_APPLY          = false;
     RUN_STANDALONE          = false;
     doImport                = false;
     START_UP                = NORMAL;
@@ -516,12 +521,27 @@ void Config::load ()
                 }
             }
 
+            // Large servers default to work stealing
+            WORK_STEALING = (NODE_SIZE >= 3);
+
+            if (getSingleSection (secConfig, SECTION_WORK_STEALING, strTemp))
+                WORK_STEALING       = beast::lexicalCastThrow <bool> (strTemp);
+
+            if (getSingleSection (secConfig, SECTION_PARALLEL_APPLY, strTemp))
+                PARALLEL_APPLY      = beast::lexicalCastThrow <bool> (strTemp);
+
             if (getSingleSection (secConfig, SECTION_ELB_SUPPORT, strTemp))
                 ELB_SUPPORT         = beast::lexicalCastThrow <bool> (strTemp);
 
             if (getSingleSection (secConfig, SECTION_WEBSOCKET_PING_FREQ, strTemp))
                 WEBSOCKET_PING_FREQ = beast::lexicalCastThrow <int> (strTemp);
 
+            if (getSingleSection (secConfig, SECTION_WEBSOCKET_QUEUE_BYTES, strTemp))
+                WEBSOCKET_QUEUE_BYTES = beast::lexicalCastThrow <std::uint64_t> (strTemp);
+
+            if (getSingleSection (secConfig, SECTION_WEBSOCKET_QUEUE_MESSAGES, strTemp))
+                WEBSOCKET_QUEUE_MESSAGES = beast::lexicalCastThrow <std::size_t> (strTemp);
+
             getSingleSection (secConfig, SECTION_SSL_VERIFY_FILE, SSL_VERIFY_FILE);
             getSingleSection (secConfig, SECTION_SSL_VERIFY_DIR, SSL_VERIFY_DIR);
 
@@ -597,6 +617,10 @@ void Config::load ()
                     FETCH_DEPTH = 10;
             }
 
+            if (getSingleSection (secConfig, SECTION_LEDGER_FETCH_WINDOW, strTemp))
+                LEDGER_FETCH_WINDOW = std::max (1,
+                    beast::lexicalCastThrow <int> (strTemp));
+
             if (getSingleSection (secConfig, SECTION_PATH_SEARCH_OLD, strTemp))
                 PATH_SEARCH_OLD     = beast::lexicalCastThrow <int> (strTemp);
             if (getSingleSection (secConfig, SECTION_PATH_SEARCH, strTemp))
@@ -0,0 +1,161 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_CORE_JOBPRIORITYQUEUE_H_INCLUDED
+#define RIPPLE_CORE_JOBPRIORITYQUEUE_H_INCLUDED
+
+#include <ripple/core/Job.h>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+
+namespace ripple {
+
+/** Holds the pending Jobs of a JobQueue, ordered by priority.
+
+    Each JobType has its own FIFO, so queueing a Job never has to search
+    an ordered container. Two bitmasks, indexed by JobType, track which
+    types have waiting jobs and which types are already running at their
+    limit. Finding the next Job to run is then a lookup of the highest bit
+    set in (pending & ~saturated), instead of a walk over the whole set.
+
+    This class is not thread safe, the caller provides the locking.
+*/
+class JobPriorityQueue
+{
+public:
+    // The number of JobType values that can be queued
+    static int const maxTypes = jtNS_WRITE + 1;
+
+    static_assert (maxTypes <= 64, "Too many job types for the masks");
+
+    JobPriorityQueue ()
+        : m_pending (0)
+        , m_saturated (0)
+        , m_size (0)
+    {
+    }
+
+    JobPriorityQueue (JobPriorityQueue const&) = delete;
+    JobPriorityQueue& operator= (JobPriorityQueue const&) = delete;
+
+    bool empty () const
+    {
+        return m_size == 0;
+    }
+
+    std::size_t size () const
+    {
+        return m_size;
+    }
+
+    /** Returns the number of Jobs waiting for the given type. */
+    std::size_t size (JobType type) const
+    {
+        return m_queues [index (type)].size ();
+    }
+
+    /** Adds a Job behind every waiting Job of the same type. */
+    void push (Job&& job)
+    {
+        int const i (index (job.getType ()));
+        m_queues [i].push_back (std::move (job));
+        m_pending |= bit (i);
+        ++m_size;
+    }
+
+    /** Marks whether a JobType is running at its limit.
+        Waiting jobs of a saturated type are skipped by pop().
+    */
+    void setSaturated (JobType type, bool saturated)
+    {
+        if (saturated)
+            m_saturated |= bit (index (type));
+        else
+            m_saturated &= ~bit (index (type));
+    }
+
+    /** Returns `true` if a waiting Job belongs to an unsaturated type. */
+    bool hasRunnable () const
+    {
+        return (m_pending & ~m_saturated) != 0;
+    }
+
+    /** Removes and returns the oldest Job of the highest runnable type.
+        Pre-condition: hasRunnable() is `true`.
+    */
+    Job pop ()
+    {
+        assert (hasRunnable ());
+
+        int const i (highestBit (m_pending & ~m_saturated));
+        std::deque <Job>& queue (m_queues [i]);
+
+        Job job (std::move (queue.front ()));
+        queue.pop_front ();
+
+        if (queue.empty ())
+            m_pending &= ~bit (i);
+        --m_size;
+
+        return job;
+    }
+
+private:
+    static int index (JobType type)
+    {
+        assert (type > jtINVALID && type < maxTypes);
+        return static_cast <int> (type);
+    }
+
+    static std::uint64_t bit (int i)
+    {
+        return std::uint64_t (1) << i;
+    }
+
+    // Returns the position of the most significant set bit
+    static int highestBit (std::uint64_t mask)
+    {
+        assert (mask != 0);
+
+        int n = 0;
+        if (mask >> 32) { mask >>= 32; n += 32; }
+        if (mask >> 16) { mask >>= 16; n += 16; }
+        if (mask >>  8) { mask >>=  8; n +=  8; }
+        if (mask >>  4) { mask >>=  4; n +=  4; }
+        if (mask >>  2) { mask >>=  2; n +=  2; }
+        if (mask >>  1) {              n +=  1; }
+        return n;
+    }
+
+    std::array <std::deque <Job>, maxTypes> m_queues;
+
+    // Bit n is set when JobType n has waiting jobs
+    std::uint64_t m_pending;
+
+    // Bit n is set when JobType n is running at its limit
+    std::uint64_t m_saturated;
+
+    std::size_t m_size;
+};
+
+}
+
+#endif
@@ -21,14 +21,16 @@
 #include <ripple/core/JobTypes.h>
 #include <ripple/core/JobTypeInfo.h>
 #include <ripple/core/JobTypeData.h>
+#include <ripple/core/impl/JobPriorityQueue.h>
 
 #include <beast/cxx14/memory.h>
 #include <beast/chrono/chrono_util.h>
 #include <beast/module/core/thread/Workers.h>
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <mutex>
-#include <set>
 #include <thread>
 
 namespace ripple {
@@ -38,14 +40,13 @@ class JobQueueImp
     , private beast::Workers::Callback
 {
 public:
-    typedef std::set <Job> JobSet;
     typedef std::map <JobType, JobTypeData> JobDataMap;
     typedef std::lock_guard <std::mutex> ScopedLock;
 
     beast::Journal m_journal;
     std::mutex m_mutex;
-    std::uint64_t m_lastJob;
-    JobSet m_jobSet;
+    std::atomic <std::uint64_t> m_lastJob;
+    JobPriorityQueue m_jobSet;
     JobDataMap m_jobData;
     JobTypeData m_invalidJobData;
 
@@ -55,6 +56,11 @@ public:
     beast::Workers m_workers;
     Job::CancelCallback m_cancelCallback;
 
+    // Jobs counted by the time they waited to run. Bucket n holds waits
+    // shorter than 2^n milliseconds, the last bucket holds the rest.
+    static int const latencyBuckets = 12;
+    std::array <std::atomic <std::uint64_t>, latencyBuckets> m_latency;
+
     // statistics tracking
     beast::insight::Collector::ptr m_collector;
     beast::insight::Gauge job_count;
@@ -84,6 +90,9 @@ public:
             &JobQueueImp::collect, this));
         job_count = m_collector->make_gauge ("job_count");
 
+        for (auto& bucket : m_latency)
+            bucket = 0;
+
         {
             ScopedLock lock (m_mutex);
 
@@ -159,13 +168,14 @@ public:
             return;
         }
 
+        // Build the Job before taking the lock, so that producers only
+        // hold the mutex for the push onto the queue of its type.
+        Job job (type, name, ++m_lastJob,
+            data.load (), jobFunc, m_cancelCallback);
+
         {
             ScopedLock lock (m_mutex);
-
-            std::pair <std::set <Job>::iterator, bool> result (
-                m_jobSet.insert (Job (type, name, ++m_lastJob,
-                    data.load (), jobFunc, m_cancelCallback)));
-            queueJob (*result.first, lock);
+            queueJob (std::move (job), lock);
         }
     }
 
@@ -217,7 +227,8 @@ public:
     }
 
     // set the number of thread serving the job queue to precisely this number
-    void setThreadCount (int c, bool const standaloneMode)
+    void setThreadCount (int c, bool const standaloneMode,
+        bool const workStealing)
     {
         if (standaloneMode)
         {
@@ -232,6 +243,12 @@ public:
                               " validation/transaction/proposal threads";
         }
 
+        // Must be chosen before the threads are created
+        m_workers.setWorkStealing (workStealing);
+
+        if (m_workers.isWorkStealing ())
+            m_journal.info << "Job queue threads use work stealing";
+
         m_workers.setNumberOfThreads (c);
     }
 
@@ -334,6 +351,23 @@ public:
 
         ret["job_types"] = priorities;
 
+        Json::Value latency (Json::objectValue);
+
+        for (int i = 0; i < latencyBuckets; ++i)
+        {
+            std::uint64_t const count (m_latency [i].load ());
+
+            if (count == 0)
+                continue;
+
+            std::string const name ((i + 1 < latencyBuckets)
+                ? "<" + std::to_string (1 << i) + "ms"
+                : ">=" + std::to_string (1 << (i - 1)) + "ms");
+            latency [name] = static_cast <Json::UInt> (count);
+        }
+
+        ret["latency"] = latency;
+
         return ret;
     }
 
@@ -380,24 +414,25 @@ private:
     //
     // Pre-conditions:
     //  The JobType must be valid.
-    //  The Job must exist in mJobSet.
     //  The Job must not have previously been queued.
     //
     // Post-conditions:
+    //  The Job is added to mJobSet.
     //  Count of waiting jobs of that type will be incremented.
     //  If JobQueue exists, and has at least one thread, Job will eventually run.
     //
     // Invariants:
     //  The calling thread owns the JobLock
     //
-    void queueJob (Job const& job, ScopedLock const& lock)
+    void queueJob (Job&& job, ScopedLock const& lock)
     {
         JobType const type (job.getType ());
         assert (type != jtINVALID);
-        assert (m_jobSet.find (job) != m_jobSet.end ());
 
         JobTypeData& data (getJobTypeData (type));
 
+        m_jobSet.push (std::move (job));
+
         if (data.waiting + data.running < getJobLimit (type))
         {
             m_workers.addTask ();
@@ -427,6 +462,7 @@ private:
     //  job is removed from mJobQueue.
     //  Waiting job count of it's type is decremented
     //  Running job count of it's type is incremented
+    //  The type is marked saturated if it reached its limit
     //
     // Invariants:
     //  The calling thread owns the JobLock
@@ -434,34 +470,23 @@ private:
     void getNextJob (Job& job, ScopedLock const& lock)
     {
         assert (! m_jobSet.empty ());
+        assert (m_jobSet.hasRunnable ());
 
-        JobSet::const_iterator iter;
-        for (iter = m_jobSet.begin (); iter != m_jobSet.end (); ++iter)
-        {
-            JobTypeData& data (getJobTypeData (iter->getType ()));
-
-            assert (data.running <= getJobLimit (data.type ()));
-
-            // Run this job if we're running below the limit.
-            if (data.running < getJobLimit (data.type ()))
-            {
-                assert (data.waiting > 0);
-                break;
-            }
-        }
-
-        assert (iter != m_jobSet.end ());
+        // Types running at their limit are masked out of the lookup
+        job = m_jobSet.pop ();
 
-        JobType const type = iter->getType ();
+        JobType const type = job.getType ();
         JobTypeData& data (getJobTypeData (type));
 
         assert (type != jtINVALID);
-
-        job = *iter;
-        m_jobSet.erase (iter);
+        assert (data.waiting > 0);
+        assert (data.running < getJobLimit (type));
 
         --data.waiting;
         ++data.running;
+
+        if (data.running >= getJobLimit (type))
+            m_jobSet.setSaturated (type, true);
     }
 
     //------------------------------------------------------------------------------
@@ -474,6 +499,7 @@ private:
     //
     // Post-conditions:
     //  The running count of that JobType is decremented
+    //  The type is no longer saturated
     //  A new task is signaled if there are more waiting Jobs than the limit, if any.
     //
     // Invariants:
@@ -483,7 +509,6 @@ private:
     {
         JobType const type = job.getType ();
 
-        assert (m_jobSet.find (job) == m_jobSet.end ());
         assert (type != jtINVALID);
 
         JobTypeData& data (getJobTypeData (type));
@@ -498,6 +523,7 @@ private:
         }
 
         --data.running;
+        m_jobSet.setSaturated (type, false);
     }
 
     //--------------------------------------------------------------------------
@@ -509,6 +535,15 @@ private:
 
         if (ms.count() >= 10)
             getJobTypeData (type).dequeue.notify (ms);
+
+        auto const wait (std::chrono::duration_cast <
+            std::chrono::milliseconds> (value).count ());
+
+        int bucket = 0;
+        while (bucket + 1 < latencyBuckets && wait >= (1 << bucket))
+            ++bucket;
+
+        ++m_latency [bucket];
     }
 
     template <class Rep, class Period>
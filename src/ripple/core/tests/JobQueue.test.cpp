@@ -0,0 +1,456 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/core/JobTypes.h>
+#include <ripple/core/impl/JobPriorityQueue.h>
+#include <beast/insight/NullCollector.h>
+#include <beast/threads/Stoppable.h>
+#include <beast/unit_test/suite.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class JobPriorityQueue_test : public beast::unit_test::suite
+{
+public:
+    LoadMonitor m_load;
+
+    Job make (JobType type, std::uint64_t index)
+    {
+        return Job (type, "test", index, m_load,
+            [](Job&) { }, Job::CancelCallback ());
+    }
+
+    void testOrder ()
+    {
+        testcase ("order");
+
+        JobPriorityQueue q;
+        expect (q.empty ());
+        expect (! q.hasRunnable ());
+
+        q.push (make (jtTRANSACTION, 1));
+        q.push (make (jtPACK, 2));
+        q.push (make (jtPROPOSAL_t, 3));
+        q.push (make (jtTRANSACTION, 4));
+        expect (q.size () == 4);
+        expect (q.size (jtTRANSACTION) == 2);
+
+        // Same order as the std::set <Job> it replaces
+        std::set <Job> expected;
+        expected.insert (make (jtTRANSACTION, 1));
+        expected.insert (make (jtPACK, 2));
+        expected.insert (make (jtPROPOSAL_t, 3));
+        expected.insert (make (jtTRANSACTION, 4));
+
+        for (auto const& job : expected)
+        {
+            Job const next (q.pop ());
+            expect (next.getType () == job.getType ());
+            expect (! (next < job) && ! (job < next), "Wrong job order");
+        }
+
+        expect (q.empty ());
+        expect (! q.hasRunnable ());
+    }
+
+    void testSaturated ()
+    {
+        testcase ("saturated");
+
+        JobPriorityQueue q;
+        q.push (make (jtPACK, 1));
+        q.push (make (jtLEDGER_DATA, 2));
+        q.push (make (jtLEDGER_DATA, 3));
+
+        q.setSaturated (jtLEDGER_DATA, true);
+        expect (q.hasRunnable ());
+        expect (q.pop ().getType () == jtPACK);
+        expect (! q.hasRunnable ());
+        expect (q.size () == 2);
+
+        q.setSaturated (jtLEDGER_DATA, false);
+        expect (q.pop ().getType () == jtLEDGER_DATA);
+        expect (q.pop ().getType () == jtLEDGER_DATA);
+        expect (q.empty ());
+    }
+
+    void run ()
+    {
+        testOrder ();
+        testSaturated ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(JobPriorityQueue,core,ripple);
+
+//------------------------------------------------------------------------------
+
+/** Measures how fast jobs move through the pending job container.
+
+    Many producer threads queue jobs with the mix of types a busy peer
+    connection generates, while a few consumers take the next runnable job
+    and finish it, respecting the limits of each job type. The std::set
+    based queue previously used by JobQueueImp is measured against
+    JobPriorityQueue, both behind a single mutex.
+
+    Arguments (all optional):
+
+        producers=32,consumers=4,jobs=20000
+
+    where 'jobs' is the number of jobs queued by each producer.
+*/
+class JobQueueThroughput_test : public beast::unit_test::suite
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+    typedef std::lock_guard <std::mutex> ScopedLock;
+
+    static JobTypes const& getJobTypes ()
+    {
+        static JobTypes types;
+        return types;
+    }
+
+    // Tracks the running count of each type against its limit
+    struct Limits
+    {
+        std::vector <int> running;
+
+        Limits ()
+            : running (JobPriorityQueue::maxTypes, 0)
+        {
+        }
+
+        static int limit (JobType type)
+        {
+            return getJobTypes ().get (type).limit ();
+        }
+    };
+
+    // The previous implementation
+    class SetQueue
+    {
+    public:
+        bool pop (Job& job)
+        {
+            ScopedLock lock (m_mutex);
+            for (auto iter = m_jobs.begin (); iter != m_jobs.end (); ++iter)
+            {
+                JobType const type (iter->getType ());
+                if (m_limits.running [type] < Limits::limit (type))
+                {
+                    ++m_limits.running [type];
+                    job = *iter;
+                    m_jobs.erase (iter);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void push (Job&& job)
+        {
+            ScopedLock lock (m_mutex);
+            m_jobs.insert (std::move (job));
+        }
+
+        void finish (JobType type)
+        {
+            ScopedLock lock (m_mutex);
+            --m_limits.running [type];
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::set <Job> m_jobs;
+        Limits m_limits;
+    };
+
+    class PriorityQueue
+    {
+    public:
+        bool pop (Job& job)
+        {
+            ScopedLock lock (m_mutex);
+            if (! m_jobs.hasRunnable ())
+                return false;
+            job = m_jobs.pop ();
+            JobType const type (job.getType ());
+            if (++m_limits.running [type] >= Limits::limit (type))
+                m_jobs.setSaturated (type, true);
+            return true;
+        }
+
+        void push (Job&& job)
+        {
+            ScopedLock lock (m_mutex);
+            m_jobs.push (std::move (job));
+        }
+
+        void finish (JobType type)
+        {
+            ScopedLock lock (m_mutex);
+            --m_limits.running [type];
+            m_jobs.setSaturated (type, false);
+        }
+
+    private:
+        std::mutex m_mutex;
+        JobPriorityQueue m_jobs;
+        Limits m_limits;
+    };
+
+    //--------------------------------------------------------------------------
+
+    int m_producers;
+    int m_consumers;
+    int m_jobs;
+
+    template <class Queue>
+    void measure (std::string const& name)
+    {
+        static JobType const types [] = {
+            jtTRANSACTION, jtTRANSACTION, jtTRANSACTION, jtTRANSACTION,
+            jtPROPOSAL_ut, jtPROPOSAL_t, jtVALIDATION_ut, jtVALIDATION_t,
+            jtLEDGER_DATA, jtCLIENT };
+        int const numTypes = sizeof (types) / sizeof (types [0]);
+
+        LoadMonitor load;
+        Queue queue;
+        std::atomic <std::uint64_t> index (0);
+        std::atomic <int> remaining (m_producers * m_jobs);
+
+        auto const producer = [&](int id)
+        {
+            for (int i = 0; i < m_jobs; ++i)
+                queue.push (Job (types [(id + i) % numTypes], "bench",
+                    ++index, load, [](Job&) { }, Job::CancelCallback ()));
+        };
+
+        auto const consumer = [&]()
+        {
+            Job job;
+            while (remaining.load () > 0)
+            {
+                if (! queue.pop (job))
+                {
+                    std::this_thread::yield ();
+                    continue;
+                }
+                queue.finish (job.getType ());
+                --remaining;
+            }
+        };
+
+        clock_type::time_point const start (clock_type::now ());
+
+        std::vector <std::thread> threads;
+        for (int i = 0; i < m_consumers; ++i)
+            threads.emplace_back (consumer);
+        for (int i = 0; i < m_producers; ++i)
+            threads.emplace_back (producer, i);
+        for (auto& t : threads)
+            t.join ();
+
+        auto const elapsed (std::chrono::duration_cast <
+            std::chrono::milliseconds> (clock_type::now () - start));
+
+        std::int64_t const total (std::int64_t (m_producers) * m_jobs);
+        std::stringstream ss;
+        ss << name << ": " << total << " jobs in " << elapsed.count () <<
+            "ms, " << (total * 1000 / std::max <std::int64_t> (
+                elapsed.count (), 1)) << " jobs/s";
+        log << ss.str ();
+
+        expect (remaining.load () == 0);
+    }
+
+    void run ()
+    {
+        auto const params = parseDelimitedKeyValueString (arg (), ',');
+
+        m_producers = 32;
+        m_consumers = 4;
+        m_jobs = 20000;
+
+        if (! params["producers"].isEmpty ())
+            m_producers = params["producers"].getIntValue ();
+        if (! params["consumers"].isEmpty ())
+            m_consumers = params["consumers"].getIntValue ();
+        if (! params["jobs"].isEmpty ())
+            m_jobs = params["jobs"].getIntValue ();
+
+        testcase ("throughput");
+
+        std::stringstream ss;
+        ss << m_producers << " producers, " << m_consumers <<
+            " consumers, " << m_jobs << " jobs per producer";
+        log << ss.str ();
+
+        measure <SetQueue> ("std::set");
+        measure <PriorityQueue> ("JobPriorityQueue");
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(JobQueueThroughput,bench,ripple);
+
+//------------------------------------------------------------------------------
+
+/** Measures job latency with and without work stealing.
+
+    Each chain of jobs owns a buffer. A job reads the buffer of its chain
+    and queues the next job of the chain, the way ledger data and node
+    store reads produce bursts of follow-up work. The job queue latency
+    histogram is reported for each mode.
+
+    Arguments (all optional):
+
+        threads=4,chains=64,depth=200,kb=32
+*/
+class JobQueueLatency_test : public beast::unit_test::suite
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    struct Chains
+    {
+        std::vector <std::vector <std::uint64_t>> buffers;
+        std::atomic <int> remaining;
+        std::atomic <std::uint64_t> sum;
+        std::mutex mutex;
+        std::condition_variable cond;
+
+        Chains (int chains, int depth, int words)
+            : buffers (chains, std::vector <std::uint64_t> (words, 1))
+            , remaining (chains * depth)
+            , sum (0)
+        {
+        }
+    };
+
+    int m_threads;
+    int m_chains;
+    int m_depth;
+    int m_kb;
+
+    void step (JobQueue& jobQueue, Chains& chains, int chain, int depth)
+    {
+        std::uint64_t total = 0;
+        for (auto const word : chains.buffers [chain])
+            total += word;
+        chains.sum += total;
+
+        if (depth > 1)
+        {
+            jobQueue.addJob (jtTRANSACTION, "bench", std::bind (
+                &JobQueueLatency_test::step, this, std::ref (jobQueue),
+                    std::ref (chains), chain, depth - 1));
+        }
+
+        if (--chains.remaining == 0)
+        {
+            std::lock_guard <std::mutex> lock (chains.mutex);
+            chains.cond.notify_all ();
+        }
+    }
+
+    void measure (bool workStealing)
+    {
+        testcase (workStealing ? "work stealing" : "shared");
+
+        beast::Journal journal;
+        beast::RootStoppable root ("root");
+        auto jobQueue (make_JobQueue (
+            beast::insight::NullCollector::New (), root, journal));
+        jobQueue->setThreadCount (m_threads, false, workStealing);
+        root.prepare ();
+        root.start ();
+
+        Chains chains (m_chains, m_depth, m_kb * 1024 / 8);
+
+        clock_type::time_point const start (clock_type::now ());
+
+        for (int i = 0; i < m_chains; ++i)
+        {
+            jobQueue->addJob (jtTRANSACTION, "bench", std::bind (
+                &JobQueueLatency_test::step, this, std::ref (*jobQueue),
+                    std::ref (chains), i, m_depth));
+        }
+
+        {
+            std::unique_lock <std::mutex> lock (chains.mutex);
+            chains.cond.wait (lock, [&chains]
+                { return chains.remaining.load () == 0; });
+        }
+
+        auto const elapsed (std::chrono::duration_cast <
+            std::chrono::milliseconds> (clock_type::now () - start));
+
+        Json::Value const latency (jobQueue->getJson (0)["latency"]);
+
+        std::stringstream ss;
+        ss << (m_chains * m_depth) << " jobs in " << elapsed.count () << "ms";
+        for (auto const& name : latency.getMemberNames ())
+            ss << std::endl << std::setw (10) << name << " " <<
+                latency [name].asUInt ();
+        log << ss.str ();
+
+        root.stop (journal);
+
+        expect (chains.sum.load () == std::uint64_t (m_chains) * m_depth *
+            chains.buffers [0].size ());
+    }
+
+    void run ()
+    {
+        auto const params = parseDelimitedKeyValueString (arg (), ',');
+
+        m_threads = 4;
+        m_chains = 64;
+        m_depth = 200;
+        m_kb = 32;
+
+        if (! params["threads"].isEmpty ())
+            m_threads = params["threads"].getIntValue ();
+        if (! params["chains"].isEmpty ())
+            m_chains = params["chains"].getIntValue ();
+        if (! params["depth"].isEmpty ())
+            m_depth = params["depth"].getIntValue ();
+        if (! params["kb"].isEmpty ())
+            m_kb = params["kb"].getIntValue ();
+
+        measure (false);
+        measure (true);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(JobQueueLatency,bench,ripple);
+
+}
@@ -136,12 +136,182 @@ public:
         pass ();
     }
 
+    void
+    test_members ()
+    {
+        Json::Value v (Json::objectValue);
+
+        // Keep a reference while many siblings are added and removed.
+        Json::Value& first = v["m"];
+        first = "first";
+
+        for (int i = 0; i < 100; ++i)
+            v["k" + std::to_string (i)] = i;
+        for (int i = 0; i < 100; i += 2)
+            v.removeMember ("k" + std::to_string (i));
+
+        expect (first.asString () == "first");
+        expect (&v["m"] == &first);
+        expect (v.size () == 51);
+        expect (v["k51"].asInt () == 51);
+        expect (!v.isMember ("k50"));
+
+        // Members are visited in key order, however they were added.
+        std::string last;
+        for (auto it = v.begin (); it != v.end (); ++it)
+        {
+            expect (last < it.memberName ());
+            last = it.memberName ();
+        }
+
+        Json::Value copy (v);
+        expect (copy == v);
+        copy["k51"] = 0;
+        expect (copy != v);
+        expect (copy < v);
+
+        v.clear ();
+        expect (v.isObject () && v.empty ());
+        v["a"] = 1;
+        expect (to_string (v) == "{\"a\":1}\n");
+
+        pass ();
+    }
+
+    void
+    test_array ()
+    {
+        Json::Value a (Json::arrayValue);
+
+        Json::Value& first = a.append ("first");
+        for (int i = 1; i < 1000; ++i)
+            a.append (i);
+
+        expect (first.asString () == "first");
+        expect (a.size () == 1000);
+        expect (a[999u].asInt () == 999);
+
+        // Arrays may be sparse.
+        Json::Value s;
+        s[5u] = 5;
+        s[2u] = 2;
+        expect (s.size () == 6);
+        expect (s[2u].asInt () == 2);
+        expect (s[3u].isNull ());
+        s.resize (3);
+        expect (s.size () == 3);
+        expect (to_string (s) == "[null,null,2]\n");
+
+        pass ();
+    }
+
+    void
+    test_parser ()
+    {
+        // The Parser must read every document exactly as the Reader does.
+        char const* const documents[] = {
+            "{\"method\":\"ledger\",\"params\":[{\"ledger_index\":1e300}]}",
+            "{\"a\":[1,-2,4294967295,2147483648,-2147483648,0.5,-1e-3]}",
+            "[true,false,null,\"\",{},[],[[]],{\"x\":{}}]",
+            "{\"esc\":\"q\\\"b\\\\s\\/n\\nt\\t\\u00e9\\ud83d\\ude00\"}",
+            " /* leading */ { \"b\" : 1 , // trailing\n \"a\" : [ 2 ] } ",
+            "\"top\"",
+            "42",
+            "{\"dup\":1,\"dup\":2}",
+            "{\"overflow\":4294967296}",
+            "{\"underflow\":-2147483649}",
+            "{\"a\":1,}",
+            "[1,]",
+            "{\"a\" 1}",
+            "[1 2]",
+            "{\"unterminated",
+            "\"\\x\"",
+            "tru",
+            "",
+        };
+
+        for (auto const document : documents)
+        {
+            Json::Value expected;
+            bool const ok = Json::Reader ().parse (document, expected);
+
+            Json::Value actual;
+            Json::Parser parser;
+            expect (parser.parse (document, actual) == ok, document);
+            expect (parser.getFormatedErrorMessages ().empty () == ok,
+                document);
+            if (ok)
+                expect (actual == expected, document);
+        }
+
+        Json::Value v;
+        Json::Parser strict (Json::Features::strictMode ());
+        expect (! strict.parse ("\"top\"", v));
+        expect (! strict.parse ("// comment\n[1]", v));
+        expect (strict.parse ("[1]", v));
+
+        Json::Parser parser;
+        expect (! parser.parse ("{\n\"a\":1,\n\"a\":2}", v));
+        expect (parser.getFormatedErrorMessages () ==
+            "* Line 3, Column 1\n  Key 'a' appears twice.\n");
+
+        pass ();
+    }
+
+    void
+    test_parser_strings ()
+    {
+        // Strings without escapes are reported straight from the document.
+        struct Handler : Json::ValueBuilder
+        {
+            std::string const& document;
+            bool inDocument = true;
+
+            Handler (Json::Value& root, std::string const& doc)
+                : ValueBuilder (root)
+                , document (doc)
+            {
+            }
+
+            bool onString (char const* data, std::size_t size) override
+            {
+                if (data < document.data () ||
+                        data + size > document.data () + document.size ())
+                    inDocument = false;
+                return ValueBuilder::onString (data, size);
+            }
+        };
+
+        auto const inDocument = [](std::string const& document)
+        {
+            Json::Value v;
+            Handler handler (v, document);
+            Json::Parser parser;
+            return parser.parse (document.data (),
+                document.data () + document.size (), handler) &&
+                    handler.inDocument;
+        };
+
+        expect (inDocument ("[\"plain\",\"\"]"));
+        expect (! inDocument ("[\"with \\\"escape\\\"\"]"));
+
+        Json::Value v;
+        expect (Json::Parser ().parse ("[\"with \\\"escape\\\"\"]", v));
+        expect (v[0u].asString () == "with \"escape\"");
+
+        pass ();
+    }
+
     void run ()
     {
         test_bad_json ();
         test_edge_cases ();
         test_copy ();
         test_move ();
+        test_members ();
+        test_array ();
+        test_parser ();
+        test_parser_strings ();
     }
 };
 
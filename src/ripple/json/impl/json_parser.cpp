@@ -0,0 +1,726 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/json/json_parser.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace Json
+{
+
+static void
+appendCodePoint (std::string& s, unsigned int cp)
+{
+    if (cp <= 0x7f)
+    {
+        s += static_cast<char> (cp);
+    }
+    else if (cp <= 0x7FF)
+    {
+        s += static_cast<char> (0xC0 | (0x1f & (cp >> 6)));
+        s += static_cast<char> (0x80 | (0x3f & cp));
+    }
+    else if (cp <= 0xFFFF)
+    {
+        s += static_cast<char> (0xE0 | (0xf & (cp >> 12)));
+        s += static_cast<char> (0x80 | (0x3f & (cp >> 6)));
+        s += static_cast<char> (0x80 | (0x3f & cp));
+    }
+    else if (cp <= 0x10FFFF)
+    {
+        s += static_cast<char> (0xF0 | (0x7 & (cp >> 18)));
+        s += static_cast<char> (0x80 | (0x3f & (cp >> 12)));
+        s += static_cast<char> (0x80 | (0x3f & (cp >> 6)));
+        s += static_cast<char> (0x80 | (0x3f & cp));
+    }
+}
+
+std::string
+ParseHandler::rejection () const
+{
+    return "Value rejected.";
+}
+
+//------------------------------------------------------------------------------
+
+ValueBuilder::ValueBuilder (Value& root)
+    : root_ (root)
+{
+}
+
+Value&
+ValueBuilder::next ()
+{
+    if (nodes_.empty ())
+        return root_;
+
+    Value& top = *nodes_.back ();
+
+    if (top.isArray ())
+        return top[top.size ()];
+
+    return top[key_];
+}
+
+bool
+ValueBuilder::onNull ()
+{
+    next () = Value ();
+    return true;
+}
+
+bool
+ValueBuilder::onBool (bool value)
+{
+    next () = value;
+    return true;
+}
+
+bool
+ValueBuilder::onInt (Value::Int value)
+{
+    next () = value;
+    return true;
+}
+
+bool
+ValueBuilder::onUInt (Value::UInt value)
+{
+    next () = value;
+    return true;
+}
+
+bool
+ValueBuilder::onDouble (double value)
+{
+    next () = value;
+    return true;
+}
+
+bool
+ValueBuilder::onString (char const* data, std::size_t size)
+{
+    next () = Value (data, data + size);
+    return true;
+}
+
+bool
+ValueBuilder::onObjectBegin ()
+{
+    Value& value = next ();
+    value = Value (objectValue);
+    nodes_.push_back (&value);
+    return true;
+}
+
+bool
+ValueBuilder::onKey (char const* data, std::size_t size)
+{
+    key_.assign (data, size);
+
+    // Reject duplicate names
+    return ! nodes_.back ()->isMember (key_);
+}
+
+bool
+ValueBuilder::onObjectEnd ()
+{
+    nodes_.pop_back ();
+    return true;
+}
+
+bool
+ValueBuilder::onArrayBegin ()
+{
+    Value& value = next ();
+    value = Value (arrayValue);
+    nodes_.push_back (&value);
+    return true;
+}
+
+bool
+ValueBuilder::onArrayEnd ()
+{
+    nodes_.pop_back ();
+    return true;
+}
+
+std::string
+ValueBuilder::rejection () const
+{
+    return "Key '" + key_ + "' appears twice.";
+}
+
+//------------------------------------------------------------------------------
+
+Parser::Parser ()
+    : Parser (Features::all ())
+{
+}
+
+Parser::Parser (Features const& features)
+    : features_ (features)
+    , begin_ (nullptr)
+    , end_ (nullptr)
+    , current_ (nullptr)
+{
+}
+
+bool
+Parser::parse (std::string const& document, Value& root)
+{
+    return parse (document.data (), document.data () + document.size (), root);
+}
+
+bool
+Parser::parse (char const* begin, char const* end, Value& root)
+{
+    root = Value ();
+    ValueBuilder builder (root);
+    return parse (begin, end, builder);
+}
+
+bool
+Parser::parse (char const* begin, char const* end, ParseHandler& handler)
+{
+    begin_ = begin;
+    end_ = end;
+    current_ = begin;
+    stack_.clear ();
+    error_.clear ();
+
+    if (! skipSpaces ())
+        return false;
+
+    if (features_.strictRoot_ &&
+        (current_ == end_ || (*current_ != '{' && *current_ != '[')))
+    {
+        return fail ("A valid JSON document must be either an array or an "
+            "object value.", begin_);
+    }
+
+    // Each pass reads one value followed by whatever closing brackets,
+    // separator and member name lead up to the next value.
+    for (;;)
+    {
+        bool opened;
+
+        if (! parseValue (handler, opened))
+            return false;
+
+        while (! opened)
+        {
+            if (stack_.empty ())
+                return true;
+
+            if (! skipSpaces ())
+                return false;
+
+            char const* const location = current_;
+            char const c = (current_ != end_) ? *current_ : 0;
+
+            if (c == ',')
+            {
+                ++current_;
+                break;
+            }
+
+            if (stack_.back () == '[')
+            {
+                if (c != ']')
+                    return fail ("Missing ',' or ']' in array declaration",
+                        location);
+
+                ++current_;
+                stack_.pop_back ();
+
+                if (! handler.onArrayEnd ())
+                    return reject (handler, location);
+            }
+            else
+            {
+                if (c != '}')
+                    return fail ("Missing ',' or '}' in object declaration",
+                        location);
+
+                ++current_;
+                stack_.pop_back ();
+
+                if (! handler.onObjectEnd ())
+                    return reject (handler, location);
+            }
+        }
+
+        if (stack_.back () == '{')
+        {
+            if (! skipSpaces ())
+                return false;
+
+            if (current_ == end_ || *current_ != '"')
+                return fail ("Missing '}' or object member name", current_);
+
+            if (! parseString (handler, true))
+                return false;
+
+            if (! skipSpaces ())
+                return false;
+
+            if (current_ == end_ || *current_ != ':')
+                return fail ("Missing ':' after object member name", current_);
+
+            ++current_;
+        }
+    }
+}
+
+bool
+Parser::parseValue (ParseHandler& handler, bool& opened)
+{
+    opened = false;
+
+    if (! skipSpaces ())
+        return false;
+
+    char const* const location = current_;
+
+    if (current_ == end_)
+        return fail ("Syntax error: value, object or array expected.",
+            location);
+
+    switch (*current_)
+    {
+    case '{':
+        ++current_;
+
+        if (! handler.onObjectBegin ())
+            return reject (handler, location);
+
+        if (! skipSpaces ())
+            return false;
+
+        if (current_ != end_ && *current_ == '}')
+        {
+            ++current_;
+            return handler.onObjectEnd () || reject (handler, location);
+        }
+
+        stack_.push_back ('{');
+        opened = true;
+        return true;
+
+    case '[':
+        ++current_;
+
+        if (! handler.onArrayBegin ())
+            return reject (handler, location);
+
+        if (! skipSpaces ())
+            return false;
+
+        if (current_ != end_ && *current_ == ']')
+        {
+            ++current_;
+            return handler.onArrayEnd () || reject (handler, location);
+        }
+
+        stack_.push_back ('[');
+        opened = true;
+        return true;
+
+    case '"':
+        return parseString (handler, false);
+
+    case 't':
+        if (! match ("true", 4))
+            break;
+        return handler.onBool (true) || reject (handler, location);
+
+    case 'f':
+        if (! match ("false", 5))
+            break;
+        return handler.onBool (false) || reject (handler, location);
+
+    case 'n':
+        if (! match ("null", 4))
+            break;
+        return handler.onNull () || reject (handler, location);
+
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+    case '-':
+        return parseNumber (handler);
+
+    default:
+        break;
+    }
+
+    return fail ("Syntax error: value, object or array expected.", location);
+}
+
+bool
+Parser::parseString (ParseHandler& handler, bool key)
+{
+    char const* const location = current_++; // skip '"'
+    char const* run = current_;
+
+    while (current_ != end_ && *current_ != '"' && *current_ != '\\')
+        ++current_;
+
+    char const* data = run;
+    std::size_t size = current_ - run;
+
+    // Only strings with escape sequences are copied
+    if (current_ != end_ && *current_ == '\\')
+    {
+        scratch_.assign (run, current_);
+
+        while (current_ != end_ && *current_ != '"')
+        {
+            if (! decodeEscape (location))
+                return false;
+
+            run = current_;
+
+            while (current_ != end_ && *current_ != '"' && *current_ != '\\')
+                ++current_;
+
+            scratch_.append (run, current_);
+        }
+
+        data = scratch_.data ();
+        size = scratch_.size ();
+    }
+
+    if (current_ == end_)
+        return fail ("Missing '\"' at the end of a string.", location);
+
+    ++current_; // skip '"'
+
+    bool const ok = key
+        ? handler.onKey (data, size)
+        : handler.onString (data, size);
+
+    return ok || reject (handler, location);
+}
+
+bool
+Parser::decodeEscape (char const* location)
+{
+    ++current_; // skip '\'
+
+    if (current_ == end_)
+        return fail ("Empty escape sequence in string", location);
+
+    switch (*current_++)
+    {
+    case '"':
+        scratch_ += '"';
+        break;
+
+    case '/':
+        scratch_ += '/';
+        break;
+
+    case '\\':
+        scratch_ += '\\';
+        break;
+
+    case 'b':
+        scratch_ += '\b';
+        break;
+
+    case 'f':
+        scratch_ += '\f';
+        break;
+
+    case 'n':
+        scratch_ += '\n';
+        break;
+
+    case 'r':
+        scratch_ += '\r';
+        break;
+
+    case 't':
+        scratch_ += '\t';
+        break;
+
+    case 'u':
+    {
+        unsigned int unicode;
+
+        if (! decodeUnicodeEscapeSequence (unicode, location))
+            return false;
+
+        if (unicode >= 0xD800 && unicode <= 0xDBFF)
+        {
+            // surrogate pairs
+            if (end_ - current_ < 6)
+                return fail ("additional six characters expected to parse "
+                    "unicode surrogate pair.", location);
+
+            if (current_[0] != '\\' || current_[1] != 'u')
+                return fail ("expecting another \\u token to begin the "
+                    "second half of a unicode surrogate pair", location);
+
+            current_ += 2;
+
+            unsigned int surrogatePair;
+
+            if (! decodeUnicodeEscapeSequence (surrogatePair, location))
+                return false;
+
+            unicode = 0x10000 + ((unicode & 0x3FF) << 10) +
+                (surrogatePair & 0x3FF);
+        }
+
+        appendCodePoint (scratch_, unicode);
+    }
+    break;
+
+    default:
+        return fail ("Bad escape sequence in string", location);
+    }
+
+    return true;
+}
+
+bool
+Parser::decodeUnicodeEscapeSequence (unsigned int& unicode,
+    char const* location)
+{
+    if (end_ - current_ < 4)
+        return fail ("Bad unicode escape sequence in string: four digits "
+            "expected.", location);
+
+    unicode = 0;
+
+    for (int index = 0; index < 4; ++index)
+    {
+        char const c = *current_++;
+        unicode *= 16;
+
+        if (c >= '0' && c <= '9')
+            unicode += c - '0';
+        else if (c >= 'a' && c <= 'f')
+            unicode += c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            unicode += c - 'A' + 10;
+        else
+            return fail ("Bad unicode escape sequence in string: "
+                "hexadecimal digit expected.", location);
+    }
+
+    return true;
+}
+
+bool
+Parser::parseNumber (ParseHandler& handler)
+{
+    // Accepts the same characters, and classifies them the same way, as
+    // Reader::readNumber and Reader::decodeNumber.
+    char const* const location = current_++;
+    bool isDouble = false;
+
+    while (current_ != end_)
+    {
+        char const c = *current_;
+
+        if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-')
+            isDouble = true;
+        else if (c < '0' || c > '9')
+            break;
+
+        ++current_;
+    }
+
+    if (isDouble)
+    {
+        std::size_t const length = current_ - location;
+        char buffer[33];
+        std::string large;
+        char const* text = buffer;
+
+        if (length < sizeof (buffer))
+        {
+            std::memcpy (buffer, location, length);
+            buffer[length] = 0;
+        }
+        else
+        {
+            large.assign (location, current_);
+            text = large.c_str ();
+        }
+
+        char* parsed;
+        double const value = std::strtod (text, &parsed);
+
+        if (parsed == text)
+            return fail ("'" + std::string (location, current_) +
+                "' is not a number.", location);
+
+        return handler.onDouble (value) || reject (handler, location);
+    }
+
+    char const* digit = location;
+    bool const isNegative = *digit == '-';
+
+    if (isNegative)
+        ++digit;
+
+    std::int64_t value = 0;
+
+    while (digit < current_ && value <= Value::maxUInt)
+        value = (value * 10) + (*digit++ - '0');
+
+    if (digit != current_)
+        return fail ("'" + std::string (location, current_) +
+            "' exceeds the allowable range.", location);
+
+    if (isNegative)
+    {
+        value = -value;
+
+        if (value < Value::minInt || value > Value::maxInt)
+            return fail ("'" + std::string (location, current_) +
+                "' exceeds the allowable range.", location);
+
+        return handler.onInt (static_cast<Value::Int> (value)) ||
+            reject (handler, location);
+    }
+
+    if (value > Value::maxUInt)
+        return fail ("'" + std::string (location, current_) +
+            "' exceeds the allowable range.", location);
+
+    // If it's representable as a signed integer, report it as one.
+    if (value <= Value::maxInt)
+        return handler.onInt (static_cast<Value::Int> (value)) ||
+            reject (handler, location);
+
+    return handler.onUInt (static_cast<Value::UInt> (value)) ||
+        reject (handler, location);
+}
+
+bool
+Parser::match (char const* literal, std::size_t size)
+{
+    if (static_cast<std::size_t> (end_ - current_) < size ||
+            std::memcmp (current_, literal, size) != 0)
+        return false;
+
+    current_ += size;
+    return true;
+}
+
+bool
+Parser::skipSpaces ()
+{
+    while (current_ != end_)
+    {
+        char const c = *current_;
+
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+            ++current_;
+            continue;
+        }
+
+        if (c != '/' || ! features_.allowComments_)
+            return true;
+
+        char const* const location = current_++;
+        char const kind = (current_ != end_) ? *current_++ : 0;
+
+        if (kind == '*')
+        {
+            for (;;)
+            {
+                if (end_ - current_ < 2)
+                    return fail ("Syntax error: unterminated comment.",
+                        location);
+
+                if (current_[0] == '*' && current_[1] == '/')
+                    break;
+
+                ++current_;
+            }
+
+            current_ += 2;
+        }
+        else if (kind == '/')
+        {
+            while (current_ != end_ && *current_ != '\r' && *current_ != '\n')
+                ++current_;
+        }
+        else
+        {
+            return fail ("Syntax error: value, object or array expected.",
+                location);
+        }
+    }
+
+    return true;
+}
+
+bool
+Parser::fail (std::string const& message, char const* location)
+{
+    // The location is resolved now, the document may not outlive the parse.
+    // line & column start at 1
+    int line = 1;
+    char const* lineStart = begin_;
+
+    for (char const* current = begin_; current < location; ++current)
+    {
+        if (*current == '\n' || (*current == '\r' &&
+            (current + 1 == end_ || current[1] != '\n')))
+        {
+            lineStart = current + 1;
+            ++line;
+        }
+    }
+
+    error_ = "* Line " + std::to_string (line) + ", Column " +
+        std::to_string (location - lineStart + 1) + "\n  " + message + "\n";
+    return false;
+}
+
+bool
+Parser::reject (ParseHandler& handler, char const* location)
+{
+    return fail (handler.rejection (), location);
+}
+
+std::string
+Parser::getFormatedErrorMessages () const
+{
+    return error_;
+}
+
+} // namespace Json
@@ -20,6 +20,8 @@
 #include <beast/module/core/text/LexicalCast.h>
 #include <ripple/json/to_string.h>
 #include <ripple/json/json_writer.h>
+#include <algorithm>
+#include <new>
 
 namespace Json {
 
@@ -261,6 +263,189 @@ Value::CZString::isStaticString () const
 #endif // ifndef JSON_VALUE_USE_INTERNAL_MAP
 
 
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// class Value::ObjectValues
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+#if !defined (JSON_VALUE_USE_INTERNAL_MAP) && !defined (JSON_USE_CPPTL_SMALLMAP)
+
+// A header followed by storage for capacity entries
+struct Value::ObjectValues::Block
+{
+    Block* next;
+    std::size_t capacity;
+
+    value_type* entries ()
+    {
+        static_assert (sizeof (Block) %
+            std::alignment_of <value_type>::value == 0,
+                "Entries following a Block must be aligned");
+
+        return reinterpret_cast <value_type*> (this + 1);
+    }
+};
+
+Value::ObjectValues::ObjectValues ()
+    : blocks_ (nullptr)
+    , next_ (reinterpret_cast <value_type*> (inline_))
+    , limit_ (next_ + inlineEntries)
+    , capacity_ (inlineEntries)
+{
+}
+
+Value::ObjectValues::ObjectValues ( const ObjectValues& other )
+    : ObjectValues ()
+{
+    index_.reserve (other.size ());
+
+    for (auto const entry : other.index_)
+        index_.push_back (new (allocate ()) value_type (*entry));
+}
+
+Value::ObjectValues::~ObjectValues ()
+{
+    release ();
+}
+
+Value::ObjectValues::value_type*
+Value::ObjectValues::allocate ()
+{
+    if (next_ == limit_)
+    {
+        // Each block doubles the capacity
+        std::size_t const count = capacity_;
+        Block* const block = static_cast <Block*> (::operator new (
+            sizeof (Block) + count * sizeof (value_type)));
+        block->next = blocks_;
+        block->capacity = count;
+        blocks_ = block;
+        next_ = block->entries ();
+        limit_ = next_ + count;
+        capacity_ += count;
+    }
+
+    return next_++;
+}
+
+void
+Value::ObjectValues::release ()
+{
+    for (auto const entry : index_)
+        entry->~value_type ();
+
+    index_.clear ();
+
+    while (blocks_)
+    {
+        Block* const next = blocks_->next;
+        ::operator delete (blocks_);
+        blocks_ = next;
+    }
+}
+
+Value::ObjectValues::iterator
+Value::ObjectValues::lower_bound ( const CZString& key ) const
+{
+    // Array elements, and members added in key order, go at the end.
+    if (index_.empty () || index_.back ()->first < key)
+        return end ();
+
+    // An array element is usually at the position of its index.
+    if (! key.c_str ())
+    {
+        std::size_t const i = key.index ();
+
+        if (i < index_.size () && index_[i]->first == key)
+            return iterator (index_.data () + i);
+    }
+
+    auto const it = std::lower_bound (index_.begin (), index_.end (), key,
+        [](value_type const* entry, CZString const& k)
+        {
+            return entry->first < k;
+        });
+
+    return iterator (index_.data () + (it - index_.begin ()));
+}
+
+Value::ObjectValues::iterator
+Value::ObjectValues::find ( const CZString& key ) const
+{
+    iterator const it = lower_bound (key);
+
+    if (it != end () && it->first == key)
+        return it;
+
+    return end ();
+}
+
+Value::ObjectValues::iterator
+Value::ObjectValues::insert ( iterator hint, const CZString& key )
+{
+    std::size_t const offset = hint.p_ - index_.data ();
+
+    value_type* const entry = allocate ();
+
+    // Grow the index along with the blocks, before constructing the
+    // entry so that nothing can throw once it exists.
+    if (index_.capacity () < capacity_)
+        index_.reserve (capacity_);
+
+    new (entry) value_type (key, Value ());
+    auto const it = index_.insert (index_.begin () + offset, entry);
+    return iterator (index_.data () + (it - index_.begin ()));
+}
+
+void
+Value::ObjectValues::erase ( iterator it )
+{
+    // The entry's storage isn't reused until the container is cleared.
+    value_type* const entry = *it.p_;
+    index_.erase (index_.begin () + (it.p_ - index_.data ()));
+    entry->~value_type ();
+}
+
+std::size_t
+Value::ObjectValues::erase ( const CZString& key )
+{
+    iterator const it = find (key);
+
+    if (it == end ())
+        return 0;
+
+    erase (it);
+    return 1;
+}
+
+void
+Value::ObjectValues::clear ()
+{
+    release ();
+    next_ = reinterpret_cast <value_type*> (inline_);
+    limit_ = next_ + inlineEntries;
+    capacity_ = inlineEntries;
+}
+
+bool
+Value::ObjectValues::operator== ( const ObjectValues& other ) const
+{
+    return size () == other.size () &&
+        std::equal (begin (), end (), other.begin ());
+}
+
+bool
+Value::ObjectValues::operator< ( const ObjectValues& other ) const
+{
+    return std::lexicographical_compare (
+        begin (), end (), other.begin (), other.end ());
+}
+
+#endif
+
+
 // //////////////////////////////////////////////////////////////////
 // //////////////////////////////////////////////////////////////////
 // //////////////////////////////////////////////////////////////////
@@ -1154,8 +1339,7 @@ Value::operator[] ( UInt index )
     if ( it != value_.map_->end ()  &&  (*it).first == key )
         return (*it).second;
 
-    ObjectValues::value_type defaultValue ( key, null );
-    it = value_.map_->insert ( it, defaultValue );
+    it = value_.map_->insert ( it, key );
     return (*it).second;
 #else
     return value_.array_->resolveReference ( index );
@@ -1210,10 +1394,9 @@ Value::resolveReference ( const char* key,
     if ( it != value_.map_->end ()  &&  (*it).first == actualKey )
         return (*it).second;
 
-    ObjectValues::value_type defaultValue ( actualKey, null );
-    it = value_.map_->insert ( it, defaultValue );
-    Value& value = (*it).second;
-    return value;
+    // The key is duplicated here, unless it is static.
+    it = value_.map_->insert ( it, actualKey );
+    return (*it).second;
 #else
     return value_.map_->resolveReference ( key, isStatic );
 #endif
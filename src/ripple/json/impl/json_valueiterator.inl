@@ -193,7 +193,7 @@ Value
 ValueIteratorBase::key () const
 {
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
-    const Value::CZString czstring = (*current_).first;
+    const Value::CZString& czstring = (*current_).first;
 
     if ( czstring.c_str () )
     {
@@ -224,7 +224,7 @@ UInt
 ValueIteratorBase::index () const
 {
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
-    const Value::CZString czstring = (*current_).first;
+    const Value::CZString& czstring = (*current_).first;
 
     if ( !czstring.c_str () )
         return czstring.index ();
@@ -254,22 +254,20 @@ FastWriter::writeValue ( const Value& value )
 
     case objectValue:
     {
-        Value::Members members ( value.getMemberNames () );
         document_ += "{";
 
-        for ( Value::Members::iterator it = members.begin ();
-                it != members.end ();
+        // Members are stored in key order.
+        for ( Value::const_iterator it = value.begin ();
+                it != value.end ();
                 ++it )
         {
-            std::string const& name = *it;
-
-            if ( it != members.begin () )
+            if ( it != value.begin () )
                 document_ += ",";
 
-            document_ += valueToQuotedString ( name.c_str () );
+            document_ += valueToQuotedString ( it.memberName () );
             document_ += yamlCompatiblityEnabled_ ? ": "
                          : ":";
-            writeValue ( value[name] );
+            writeValue ( *it );
         }
 
         document_ += "}";
@@ -338,26 +336,23 @@ StyledWriter::writeValue ( const Value& value )
 
     case objectValue:
     {
-        Value::Members members ( value.getMemberNames () );
-
-        if ( members.empty () )
+        if ( value.empty () )
             pushValue ( "{}" );
         else
         {
             writeWithIndent ( "{" );
             indent ();
-            Value::Members::iterator it = members.begin ();
+            Value::const_iterator it = value.begin ();
 
             while ( true )
             {
-                std::string const& name = *it;
-                const Value& childValue = value[name];
+                const Value& childValue = *it;
                 writeCommentBeforeValue ( childValue );
-                writeWithIndent ( valueToQuotedString ( name.c_str () ) );
+                writeWithIndent ( valueToQuotedString ( it.memberName () ) );
                 document_ += " : ";
                 writeValue ( childValue );
 
-                if ( ++it == members.end () )
+                if ( ++it == value.end () )
                 {
                     writeCommentAfterValueOnSameLine ( childValue );
                     break;
@@ -649,26 +644,23 @@ StyledStreamWriter::writeValue ( const Value& value )
 
     case objectValue:
     {
-        Value::Members members ( value.getMemberNames () );
-
-        if ( members.empty () )
+        if ( value.empty () )
             pushValue ( "{}" );
         else
         {
             writeWithIndent ( "{" );
             indent ();
-            Value::Members::iterator it = members.begin ();
+            Value::const_iterator it = value.begin ();
 
             while ( true )
             {
-                std::string const& name = *it;
-                const Value& childValue = value[name];
+                const Value& childValue = *it;
                 writeCommentBeforeValue ( childValue );
-                writeWithIndent ( valueToQuotedString ( name.c_str () ) );
+                writeWithIndent ( valueToQuotedString ( it.memberName () ) );
                 *document_ << " : ";
                 writeValue ( childValue );
 
-                if ( ++it == members.end () )
+                if ( ++it == value.end () )
                 {
                     writeCommentAfterValueOnSameLine ( childValue );
                     break;
@@ -964,17 +956,15 @@ write_value (write_t write, Value const& value)
 
     case objectValue:
     {
-        Value::Members const members = value.getMemberNames();
         write("{", 1);
-        for (auto it = members.begin(); it != members.end(); ++it)
+        for (auto it = value.begin(); it != value.end(); ++it)
         {
-            std::string const& name = *it;
-            if (it != members.begin())
+            if (it != value.begin())
                 write(",", 1);
 
-            write_string(write, valueToQuotedString(name.c_str()));
+            write_string(write, valueToQuotedString(it.memberName()));
             write(":", 1);
-            write_value(write, value[name]);
+            write_value(write, *it);
         }
         write("}", 1);
         break;
@@ -991,4 +981,10 @@ stream (Json::Value const& jv, write_t write)
     write("\n", 1);
 }
 
+void
+streamValue (Json::Value const& jv, write_t write)
+{
+    detail::write_value(write, jv);
+}
+
 } // namespace Json
@@ -30,6 +30,10 @@ class StyledWriter;
 // reader.h
 class Reader;
 
+// parser.h
+class ParseHandler;
+class Parser;
+
 // features.h
 class Features;
 
@@ -0,0 +1,158 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef JSON_PARSER_H_INCLUDED
+#define JSON_PARSER_H_INCLUDED
+
+#include <ripple/json/json_features.h>
+#include <ripple/json/json_value.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Json
+{
+
+/** Receives the events produced by Parser.
+
+    Strings and member names are passed as ranges which are only valid for
+    the duration of the call: when the text holds no escape sequences they
+    point directly into the document, otherwise into a scratch buffer owned
+    by the Parser.
+
+    Each callback returns false to stop the parse, in which case rejection()
+    supplies the error message.
+*/
+class ParseHandler
+{
+public:
+    virtual ~ParseHandler () = default;
+
+    virtual bool onNull () = 0;
+    virtual bool onBool (bool value) = 0;
+    virtual bool onInt (Value::Int value) = 0;
+    virtual bool onUInt (Value::UInt value) = 0;
+    virtual bool onDouble (double value) = 0;
+    virtual bool onString (char const* data, std::size_t size) = 0;
+
+    virtual bool onObjectBegin () = 0;
+    virtual bool onKey (char const* data, std::size_t size) = 0;
+    virtual bool onObjectEnd () = 0;
+
+    virtual bool onArrayBegin () = 0;
+    virtual bool onArrayEnd () = 0;
+
+    /** Describes why the last callback returned false. */
+    virtual std::string rejection () const;
+};
+
+/** Builds a Value from the events produced by Parser.
+
+    The resulting Value is the same as Reader would produce for the
+    document, including the rejection of duplicate member names. Every
+    top-level value replaces the contents of root.
+*/
+class ValueBuilder : public ParseHandler
+{
+public:
+    explicit ValueBuilder (Value& root);
+
+    bool onNull () override;
+    bool onBool (bool value) override;
+    bool onInt (Value::Int value) override;
+    bool onUInt (Value::UInt value) override;
+    bool onDouble (double value) override;
+    bool onString (char const* data, std::size_t size) override;
+
+    bool onObjectBegin () override;
+    bool onKey (char const* data, std::size_t size) override;
+    bool onObjectEnd () override;
+
+    bool onArrayBegin () override;
+    bool onArrayEnd () override;
+
+    std::string rejection () const override;
+
+private:
+    Value& next ();
+
+    Value& root_;
+    std::vector <Value*> nodes_;
+    std::string key_;
+};
+
+/** Single pass parser for a JSON document held in a contiguous buffer.
+
+    Unlike Reader, the document is neither copied nor tokenized ahead of
+    time: values are reported to a ParseHandler as they are scanned, and
+    strings without escape sequences are never copied by the parser.
+    Containers are tracked with an explicit stack so deeply nested input
+    does not recurse. Comments are skipped but never collected.
+*/
+class Parser
+{
+public:
+    /** Constructs a Parser allowing all features. */
+    Parser ();
+
+    /** Constructs a Parser allowing the specified feature set. */
+    explicit Parser (Features const& features);
+
+    /** Reports the value in [begin, end) to handler.
+        @return true if the document was successfully parsed.
+    */
+    bool parse (char const* begin, char const* end, ParseHandler& handler);
+
+    /** Reads the value in [begin, end) into root.
+        @return true if the document was successfully parsed.
+    */
+    bool parse (char const* begin, char const* end, Value& root);
+
+    bool parse (std::string const& document, Value& root);
+
+    /** Returns a user friendly description of the last error, in the same
+        format as Reader::getFormatedErrorMessages. An empty string is
+        returned if no error occurred.
+    */
+    std::string getFormatedErrorMessages () const;
+
+private:
+    bool fail (std::string const& message, char const* location);
+    bool reject (ParseHandler& handler, char const* location);
+    bool skipSpaces ();
+    bool match (char const* literal, std::size_t size);
+    bool parseValue (ParseHandler& handler, bool& opened);
+    bool parseString (ParseHandler& handler, bool key);
+    bool parseNumber (ParseHandler& handler);
+    bool decodeEscape (char const* location);
+    bool decodeUnicodeEscapeSequence (unsigned int& unicode,
+        char const* location);
+
+    Features features_;
+    char const* begin_;
+    char const* end_;
+    char const* current_;
+    std::vector <char> stack_;
+    std::string scratch_;
+    std::string error_;
+};
+
+} // namespace Json
+
+#endif
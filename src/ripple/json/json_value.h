@@ -23,8 +23,12 @@
 #include <ripple/json/json_config.h>
 #include <ripple/json/json_forwards.h>
 #include <beast/strings/String.h>
+#include <cstddef>
 #include <functional>
+#include <iterator>
 #include <map>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 /** \brief JSON (JavaScript Object Notation).
@@ -172,7 +176,7 @@ private:
 
 public:
 #  ifndef JSON_USE_CPPTL_SMALLMAP
-    typedef std::map<CZString, Value> ObjectValues;
+    class ObjectValues;
 #  else
     typedef CppTL::SmallMap<CZString, Value> ObjectValues;
 #  endif // ifndef JSON_USE_CPPTL_SMALLMAP
@@ -465,6 +469,101 @@ private:
     CommentInfo* comments_;
 };
 
+#if !defined (JSONCPP_DOC_EXCLUDE_IMPLEMENTATION) && \
+    !defined (JSON_VALUE_USE_INTERNAL_MAP) && !defined (JSON_USE_CPPTL_SMALLMAP)
+
+/** The members of an object, or the elements of an array, in key order.
+
+    This replaces a std::map, which cost an allocation for every member.
+    Entries are constructed in place in a few blocks of geometrically
+    increasing size, the first of which is part of this object, and a
+    sorted index of pointers to them gives lookup and ordered iteration.
+
+    Entries never move once added, so a reference to a member stays valid
+    while its siblings are added or removed, as it did with std::map.
+    Iterators are invalidated by insert and erase.
+*/
+class Value::ObjectValues
+{
+public:
+    typedef std::pair<const CZString, Value> value_type;
+
+    class iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef Value::ObjectValues::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef value_type* pointer;
+        typedef value_type& reference;
+
+        iterator () : p_ (nullptr) {}
+
+        reference operator* () const { return **p_; }
+        pointer operator-> () const { return *p_; }
+
+        iterator& operator++ () { ++p_; return *this; }
+        iterator& operator-- () { --p_; return *this; }
+        iterator operator++ (int) { iterator i (*this); ++p_; return i; }
+        iterator operator-- (int) { iterator i (*this); --p_; return i; }
+
+        bool operator== (iterator const& other) const { return p_ == other.p_; }
+        bool operator!= (iterator const& other) const { return p_ != other.p_; }
+
+    private:
+        friend class ObjectValues;
+        explicit iterator (value_type* const* p) : p_ (p) {}
+        value_type* const* p_;
+    };
+
+    typedef iterator const_iterator;
+
+    ObjectValues ();
+    ObjectValues ( const ObjectValues& other );
+    ObjectValues& operator= ( const ObjectValues& other ) = delete;
+    ~ObjectValues ();
+
+    std::size_t size () const { return index_.size (); }
+    bool empty () const { return index_.empty (); }
+
+    iterator begin () const { return iterator (index_.data ()); }
+    iterator end () const { return iterator (index_.data () + index_.size ()); }
+
+    iterator find ( const CZString& key ) const;
+    iterator lower_bound ( const CZString& key ) const;
+
+    /** Add a null value for a key which is not present.
+        The hint must be lower_bound ( key ).
+    */
+    iterator insert ( iterator hint, const CZString& key );
+
+    void erase ( iterator it );
+    std::size_t erase ( const CZString& key );
+    void clear ();
+
+    bool operator== ( const ObjectValues& other ) const;
+    bool operator< ( const ObjectValues& other ) const;
+
+private:
+    struct Block;
+    enum { inlineEntries = 4 };
+
+    value_type* allocate ();
+    void release ();
+
+    typedef std::aligned_storage <sizeof (value_type),
+        std::alignment_of <value_type>::value>::type Storage;
+
+    std::vector <value_type*> index_;
+    Storage inline_[inlineEntries];
+    Block* blocks_;         // Blocks allocated after inline_ filled up
+    value_type* next_;      // Next unused entry
+    value_type* limit_;     // End of the block next_ is in
+    std::size_t capacity_;  // Entries in inline_ and blocks_
+};
+
+#endif
+
 
 /** \brief Experimental and untested: represents an element of the "path" to access a node.
  */
@@ -1091,6 +1190,10 @@ using write_t = std::function<void(void const*, std::size_t)>;
 void
 stream (Json::Value const& jv, write_t write);
 
+/** Stream compact JSON, without the newline that stream() ends with. */
+void
+streamValue (Json::Value const& jv, write_t write);
+
 } // namespace Json
 
 
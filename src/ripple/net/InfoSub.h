@@ -25,6 +25,8 @@
 #include <ripple/resource/Consumer.h>
 #include <ripple/types/Book.h>
 #include <beast/threads/Stoppable.h>
+#include <map>
+#include <memory>
 #include <mutex>
 
 namespace ripple {
@@ -51,6 +53,63 @@ public:
 
     typedef Resource::Consumer Consumer;
 
+    /** A message published to many subscribers.
+
+        The JSON is serialized once, when it is first needed. A transport can keep its framed form
+        of the message here, so that all of its subscribers are sent the
+        same buffer instead of a copy each. A Broadcast is sent to its
+        subscribers from a single thread.
+
+        A replaceable message, such as a ledger close or the server status,
+        is superseded by the next one of its kind. It may be dropped for a
+        subscriber that has fallen behind.
+    */
+    class Broadcast
+    {
+    public:
+        explicit Broadcast (Json::Value const& jvObj, bool replaceable = false)
+            : mJson (jvObj)
+            , mReplaceable (replaceable)
+        {
+        }
+
+        Broadcast (Broadcast const&) = delete;
+        Broadcast& operator= (Broadcast const&) = delete;
+
+        Json::Value const& getJson () const
+        {
+            return mJson;
+        }
+
+        std::string const& getText () const;
+
+        bool isReplaceable () const
+        {
+            return mReplaceable;
+        }
+
+        /** Returns the framed form of the message for a transport.
+            The frame is built by calling build the first time the key is
+            asked for, and is shared by every later caller.
+        */
+        template <class Frame, class Build>
+        Frame const& getFrame (int key, Build build) const
+        {
+            std::shared_ptr <void>& frame = mFrames[key];
+
+            if (!frame)
+                frame = std::make_shared <Frame> (build ());
+
+            return *static_cast <Frame const*> (frame.get ());
+        }
+
+    private:
+        Json::Value const& mJson;
+        bool const mReplaceable;
+        mutable std::unique_ptr <std::string> mText;
+        mutable std::map <int, std::shared_ptr <void>> mFrames;
+    };
+
 public:
     /** Abstracts the source of subscription data.
     */
@@ -103,9 +162,7 @@ public:
 
     virtual void send (Json::Value const& jvObj, bool broadcast) = 0;
 
-    // VFALCO NOTE Why is this virtual?
-    virtual void send (
-        Json::Value const& jvObj, std::string const& sObj, bool broadcast);
+    virtual void send (Broadcast const& message);
 
     std::uint64_t getSeq ();
 
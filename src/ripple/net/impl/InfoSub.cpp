@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/net/InfoSub.h>
+#include <ripple/json/to_string.h>
 #include <atomic>
 
 namespace ripple {
@@ -42,6 +43,16 @@ InfoSub::Source::Source (char const* name, Stoppable& parent)
 
 //------------------------------------------------------------------------------
 
+std::string const& InfoSub::Broadcast::getText () const
+{
+    if (!mText)
+        mText.reset (new std::string (to_string (mJson)));
+
+    return *mText;
+}
+
+//------------------------------------------------------------------------------
+
 InfoSub::InfoSub (Source& source, Consumer consumer)
     : m_consumer (consumer)
     , m_source (source)
@@ -65,10 +76,9 @@ Resource::Consumer& InfoSub::getConsumer()
     return m_consumer;
 }
 
-void InfoSub::send (
-    Json::Value const& jvObj, std::string const& sObj, bool broadcast)
+void InfoSub::send (Broadcast const& message)
 {
-    send (jvObj, broadcast);
+    send (message.getJson (), true);
 }
 
 std::uint64_t InfoSub::getSeq ()
@@ -60,6 +60,20 @@ public:
     */
     virtual Status fetch (void const* key, NodeObject::Ptr* pObject) = 0;
 
+    /** Fetch a group of objects.
+        The keys are passed in ascending order, so a backend can visit its
+        storage sequentially and share the cost of a lookup across the
+        batch. The default implementation calls fetch for each key.
+        @note This will be called concurrently.
+        @param keys Pointers to the key data of each object.
+        @param pObjects [out] The created objects, one per key, null for
+                              any key which was not found.
+        @return The result of the operation for each key.
+    */
+    virtual std::vector <Status> fetchBatch (
+        std::vector <void const*> const& keys,
+            std::vector <NodeObject::Ptr>* pObjects);
+
     /** Store a single object.
         Depending on the implementation this may happen immediately
         or deferred using a scheduled task.
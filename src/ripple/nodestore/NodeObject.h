@@ -20,6 +20,7 @@
 #ifndef RIPPLE_NODESTORE_NODEOBJECT_H_INCLUDED
 #define RIPPLE_NODESTORE_NODEOBJECT_H_INCLUDED
 
+#include <ripple/basics/byte_view.h>
 #include <ripple/basics/CountedObject.h>
 #include <ripple/protocol/Protocol.h>
 
@@ -79,6 +80,7 @@ public:
     NodeObject (NodeObjectType type,
                 LedgerIndex ledgerIndex,
                 Blob&& data,
+                std::size_t offset,
                 uint256 const& hash,
                 PrivateAccess);
 
@@ -98,6 +100,18 @@ public:
                              Blob&& data,
                              uint256 const& hash);
 
+    /** Create an object which takes over a buffer read from a backend.
+
+        The payload starts at offset within the buffer. The bytes in front
+        of it are kept but never exposed, so a backend can hand over the
+        buffer it read into without copying the payload out of it.
+    */
+    static Ptr createObject (NodeObjectType type,
+                             LedgerIndex ledgerIndex,
+                             Blob&& data,
+                             std::size_t offset,
+                             uint256 const& hash);
+
     /** Retrieve the type of this object.
     */
     NodeObjectType getType () const;
@@ -111,8 +125,10 @@ public:
     LedgerIndex getLedgerIndex() const;
 
     /** Retrieve the binary data.
+
+        The view remains valid for the lifetime of the object.
     */
-    Blob const& getData () const;
+    const_byte_view getData () const;
 
     /** See if this object has the same data as another object.
     */
@@ -138,6 +154,7 @@ private:
     uint256 mHash;
     LedgerIndex mLedgerIndex;
     Blob mData;
+    std::size_t mOffset;
 };
 
 }
@@ -25,13 +25,18 @@
 namespace ripple {
 namespace NodeStore {
 
-/** Contains information about a fetch operation. */
+/** Contains information about a fetch operation.
+    Asynchronous reads are fetched in batches, in which case the report
+    covers every object of the batch that was not already cached.
+*/
 struct FetchReport
 {
     std::chrono::milliseconds elapsed;
     bool isAsync;
     bool wentToDisk;
     bool wasFound;
+    int fetchCount;     // objects fetched, more than one for a batch
+    int foundCount;     // objects found
 };
 
 /** Contains information about a batch write operation. */
@@ -0,0 +1,789 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <beast/Config.h>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <set>
+
+#if BEAST_WIN32
+#include <io.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ripple {
+namespace NodeStore {
+
+/*  On-disk layout
+
+    data.log    A sequence of records, each of which is the key, the size
+                of the encoded object as a 32-bit big endian integer, and
+                the encoded object as produced by EncodedBlob. Records are
+                only ever appended.
+
+    index.dat   An IndexHeader followed by a power of two number of
+                IndexSlot entries which form an open addressed hash table
+                with linear probing. The first eight bytes of the key are
+                the tag and choose the starting slot; keys are hashes so
+                they are already uniformly distributed. A slot with a size
+                of zero is empty.
+
+    The index is updated only after the records it refers to are written,
+    and it remembers how much of the data file it covers. Records past that
+    point are indexed when the backend is opened, so an interrupted write
+    loses at most a partially written trailing record.
+*/
+
+// Positional reads and appends on the data file. Reads may happen
+// concurrently with each other and with an append.
+class AppendLogFile
+{
+public:
+    explicit AppendLogFile (std::string const& path);
+    ~AppendLogFile ();
+
+    std::uint64_t
+    size () const
+    {
+        return m_size.load ();
+    }
+
+    bool read (std::uint64_t offset, void* buffer, std::size_t bytes);
+
+    // Writes at the end of the file, throws on failure
+    void append (void const* buffer, std::size_t bytes);
+
+    void truncate (std::uint64_t size);
+
+private:
+#if BEAST_WIN32
+    std::mutex m_mutex;
+    std::FILE* m_file;
+#else
+    int m_fd;
+#endif
+    std::atomic <std::uint64_t> m_size;
+};
+
+#if BEAST_WIN32
+
+AppendLogFile::AppendLogFile (std::string const& path)
+{
+    m_file = std::fopen (path.c_str (), "r+b");
+    if (m_file == nullptr)
+        m_file = std::fopen (path.c_str (), "w+b");
+    if (m_file == nullptr)
+        throw std::runtime_error ("Unable to open " + path);
+    _fseeki64 (m_file, 0, SEEK_END);
+    m_size = _ftelli64 (m_file);
+}
+
+AppendLogFile::~AppendLogFile ()
+{
+    std::fclose (m_file);
+}
+
+bool
+AppendLogFile::read (std::uint64_t offset, void* buffer, std::size_t bytes)
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    return _fseeki64 (m_file, offset, SEEK_SET) == 0 &&
+        std::fread (buffer, 1, bytes, m_file) == bytes;
+}
+
+void
+AppendLogFile::append (void const* buffer, std::size_t bytes)
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    if (_fseeki64 (m_file, m_size, SEEK_SET) != 0 ||
+        std::fwrite (buffer, 1, bytes, m_file) != bytes ||
+            std::fflush (m_file) != 0)
+        throw std::runtime_error ("AppendLog write failed");
+    m_size += bytes;
+}
+
+void
+AppendLogFile::truncate (std::uint64_t size)
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    if (_chsize_s (_fileno (m_file), size) != 0)
+        throw std::runtime_error ("AppendLog truncate failed");
+    m_size = size;
+}
+
+#else
+
+AppendLogFile::AppendLogFile (std::string const& path)
+{
+    m_fd = ::open (path.c_str (), O_RDWR | O_CREAT, 0644);
+    if (m_fd == -1)
+        throw std::runtime_error ("Unable to open " + path);
+
+    struct stat st;
+    if (::fstat (m_fd, &st) != 0)
+    {
+        ::close (m_fd);
+        throw std::runtime_error ("Unable to stat " + path);
+    }
+    m_size = st.st_size;
+}
+
+AppendLogFile::~AppendLogFile ()
+{
+    ::close (m_fd);
+}
+
+bool
+AppendLogFile::read (std::uint64_t offset, void* buffer, std::size_t bytes)
+{
+    char* p = static_cast <char*> (buffer);
+    while (bytes > 0)
+    {
+        ssize_t const n = ::pread (m_fd, p, bytes, offset);
+        if (n <= 0)
+        {
+            if (n == -1 && errno == EINTR)
+                continue;
+            return false;
+        }
+        p += n;
+        bytes -= n;
+        offset += n;
+    }
+    return true;
+}
+
+void
+AppendLogFile::append (void const* buffer, std::size_t bytes)
+{
+    char const* p = static_cast <char const*> (buffer);
+    std::uint64_t offset = m_size;
+    std::size_t remaining = bytes;
+    while (remaining > 0)
+    {
+        ssize_t const n = ::pwrite (m_fd, p, remaining, offset);
+        if (n <= 0)
+        {
+            if (n == -1 && errno == EINTR)
+                continue;
+            throw std::runtime_error ("AppendLog write failed");
+        }
+        p += n;
+        remaining -= n;
+        offset += n;
+    }
+    m_size += bytes;
+}
+
+void
+AppendLogFile::truncate (std::uint64_t size)
+{
+    if (::ftruncate (m_fd, size) != 0)
+        throw std::runtime_error ("AppendLog truncate failed");
+    m_size = size;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+class AppendLogBackend
+    : public Backend
+    , public BatchWriter::Callback
+    , public beast::LeakChecked <AppendLogBackend>
+{
+private:
+    static std::uint64_t const indexMagic = 0x52504c4f47494458ULL;
+    static std::uint32_t const indexVersion = 1;
+    static std::uint64_t const defaultIndexSlots = 65536;
+    static std::size_t const sizeBytes = 4;
+
+    struct IndexHeader
+    {
+        std::uint64_t magic;
+        std::uint32_t version;
+        std::uint32_t keyBytes;
+        std::uint64_t capacity;
+        std::uint64_t count;
+        std::uint64_t dataSize;
+    };
+
+    struct IndexSlot
+    {
+        std::uint64_t tag;
+        std::uint64_t offset;
+        std::uint32_t size;
+        std::uint32_t reserved;
+    };
+
+    typedef boost::interprocess::mapped_region Region;
+
+    std::atomic <bool> m_deletePath;
+
+public:
+    beast::Journal m_journal;
+    size_t const m_keyBytes;
+    Scheduler& m_scheduler;
+    boost::filesystem::path const m_dir;
+    std::uint64_t const m_indexSlots;
+
+    // Serializes appends to the data file
+    std::mutex m_writeMutex;
+
+    // Guards the index mapping and its contents
+    std::mutex m_indexMutex;
+    Region m_region;
+    IndexHeader* m_header;
+    IndexSlot* m_slots;
+    std::uint64_t m_generation;
+
+    std::unique_ptr <AppendLogFile> m_data;
+
+    // Reset first on destruction so pending writes reach the open files
+    std::unique_ptr <BatchWriter> m_batch;
+
+    AppendLogBackend (size_t keyBytes, Parameters const& keyValues,
+        Scheduler& scheduler, beast::Journal journal)
+        : m_deletePath (false)
+        , m_journal (journal)
+        , m_keyBytes (keyBytes)
+        , m_scheduler (scheduler)
+        , m_dir (keyValues ["path"].toStdString ())
+        , m_indexSlots (keyValues ["index_slots"].isEmpty () ?
+            defaultIndexSlots : keyValues ["index_slots"].getIntValue ())
+        , m_header (nullptr)
+        , m_slots (nullptr)
+        , m_generation (0)
+        , m_batch (std::make_unique <BatchWriter> (*this, scheduler))
+    {
+        if (m_dir.empty ())
+            throw std::runtime_error ("Missing path in AppendLog backend");
+
+        if (m_keyBytes < sizeof (std::uint64_t))
+            throw std::runtime_error ("Key size too small for AppendLog backend");
+
+        if (m_indexSlots == 0 || (m_indexSlots & (m_indexSlots - 1)) != 0)
+            throw std::runtime_error ("AppendLog index_slots must be a power of two");
+
+        boost::filesystem::create_directories (m_dir);
+        m_data = std::make_unique <AppendLogFile> (
+            (m_dir / "data.log").string ());
+        openIndex ();
+    }
+
+    ~AppendLogBackend ()
+    {
+        m_batch.reset ();
+
+        if (m_region.get_address () != nullptr)
+            m_region.flush ();
+        Region ().swap (m_region);
+        m_data.reset ();
+
+        if (m_deletePath)
+            boost::filesystem::remove_all (m_dir);
+    }
+
+    std::string
+    getName ()
+    {
+        return m_dir.string ();
+    }
+
+    //--------------------------------------------------------------------------
+
+    Status
+    fetch (void const* key, NodeObject::Ptr* pObject)
+    {
+        pObject->reset ();
+
+        std::uint64_t const tag = getTag (key);
+        std::uint64_t probe = 0;
+        std::uint64_t generation = 0;
+        IndexSlot slot;
+
+        // A tag match is almost always the key, but keep probing if not
+        while (findSlot (tag, probe, generation, slot))
+        {
+            Status const status = readRecord (key, slot, pObject);
+            if (status != notFound)
+                return status;
+        }
+
+        return notFound;
+    }
+
+    void
+    store (NodeObject::ref object)
+    {
+        m_batch->store (object);
+    }
+
+    void
+    storeBatch (Batch const& batch)
+    {
+        std::lock_guard <std::mutex> lock (m_writeMutex);
+
+        std::uint64_t const offset = m_data->size ();
+        std::vector <std::uint8_t> buffer;
+        std::vector <IndexSlot> slots;
+        std::set <uint256> keys;
+        slots.reserve (batch.size ());
+
+        EncodedBlob encoded;
+
+        for (auto const& e : batch)
+        {
+            encoded.prepare (e);
+            void const* const key = encoded.getKey ();
+
+            // Objects are immutable, so a key is only ever written once
+            if (! keys.insert (uint256::fromVoid (key)).second ||
+                    contains (key))
+                continue;
+
+            IndexSlot slot;
+            slot.tag = getTag (key);
+            slot.offset = offset + buffer.size ();
+            slot.size = static_cast <std::uint32_t> (encoded.getSize ());
+            slot.reserved = 0;
+            slots.push_back (slot);
+
+            std::uint8_t const* const k =
+                static_cast <std::uint8_t const*> (key);
+            std::uint8_t const* const data =
+                static_cast <std::uint8_t const*> (encoded.getData ());
+            buffer.insert (buffer.end (), k, k + m_keyBytes);
+            buffer.push_back (static_cast <std::uint8_t> (slot.size >> 24));
+            buffer.push_back (static_cast <std::uint8_t> (slot.size >> 16));
+            buffer.push_back (static_cast <std::uint8_t> (slot.size >> 8));
+            buffer.push_back (static_cast <std::uint8_t> (slot.size));
+            buffer.insert (buffer.end (), data, data + slot.size);
+        }
+
+        if (buffer.empty ())
+            return;
+
+        m_data->append (buffer.data (), buffer.size ());
+
+        std::lock_guard <std::mutex> indexLock (m_indexMutex);
+        for (auto const& slot : slots)
+            insert (slot);
+        m_header->dataSize = m_data->size ();
+    }
+
+    void
+    for_each (std::function <void(NodeObject::Ptr)> f)
+    {
+        std::uint64_t end;
+        {
+            std::lock_guard <std::mutex> lock (m_indexMutex);
+            end = m_header->dataSize;
+        }
+
+        std::vector <std::uint8_t> record;
+        std::uint64_t offset = 0;
+        std::uint32_t size;
+
+        while (readHead (offset, end, record, size))
+        {
+            record.resize (m_keyBytes + sizeBytes + size);
+            if (! m_data->read (offset + m_keyBytes + sizeBytes,
+                    &record [m_keyBytes + sizeBytes], size))
+                break;
+
+            DecodedBlob decoded (record.data (),
+                &record [m_keyBytes + sizeBytes], size);
+
+            if (decoded.wasOk ())
+            {
+                f (decoded.createObject ());
+            }
+            else
+            {
+                // Uh oh, corrupted data!
+                if (m_journal.fatal) m_journal.fatal <<
+                    "Corrupt NodeObject #" << uint256::fromVoid (record.data ());
+            }
+
+            offset += record.size ();
+        }
+    }
+
+    int
+    getWriteLoad ()
+    {
+        return m_batch->getWriteLoad ();
+    }
+
+    void
+    setDeletePath() override
+    {
+        m_deletePath = true;
+    }
+
+    //--------------------------------------------------------------------------
+
+    void
+    writeBatch (Batch const& batch)
+    {
+        storeBatch (batch);
+    }
+
+private:
+    static
+    std::uint64_t
+    getTag (void const* key)
+    {
+        std::uint64_t tag;
+        std::memcpy (&tag, key, sizeof (tag));
+        return tag;
+    }
+
+    static
+    std::uint32_t
+    getSize (std::uint8_t const* p)
+    {
+        return (std::uint32_t (p[0]) << 24) | (std::uint32_t (p[1]) << 16) |
+            (std::uint32_t (p[2]) << 8) | std::uint32_t (p[3]);
+    }
+
+    // Reads the key and size of the record at offset, if it is complete
+    bool
+    readHead (std::uint64_t offset, std::uint64_t end,
+        std::vector <std::uint8_t>& record, std::uint32_t& size)
+    {
+        std::size_t const headBytes = m_keyBytes + sizeBytes;
+        if (offset + headBytes > end)
+            return false;
+
+        record.resize (headBytes);
+        if (! m_data->read (offset, record.data (), headBytes))
+            return false;
+
+        size = getSize (&record [m_keyBytes]);
+        return size != 0 && offset + headBytes + size <= end;
+    }
+
+    Status
+    readRecord (void const* key, IndexSlot const& slot,
+        NodeObject::Ptr* pObject)
+    {
+        Blob record (m_keyBytes + sizeBytes + slot.size);
+
+        if (! m_data->read (slot.offset, record.data (), record.size ()))
+            return dataCorrupt;
+
+        if (std::memcmp (record.data (), key, m_keyBytes) != 0)
+            return notFound;
+
+        if (getSize (&record [m_keyBytes]) != slot.size)
+            return dataCorrupt;
+
+        // The object takes over the record instead of copying the value
+        DecodedBlob decoded (key, std::move (record), m_keyBytes + sizeBytes);
+
+        if (! decoded.wasOk ())
+            return dataCorrupt;
+
+        *pObject = decoded.createObject ();
+        return ok;
+    }
+
+    bool
+    contains (void const* key)
+    {
+        std::uint64_t const tag = getTag (key);
+        std::uint64_t probe = 0;
+        std::uint64_t generation = 0;
+        IndexSlot slot;
+        std::vector <std::uint8_t> stored (m_keyBytes);
+
+        while (findSlot (tag, probe, generation, slot))
+        {
+            if (m_data->read (slot.offset, stored.data (), m_keyBytes) &&
+                    std::memcmp (stored.data (), key, m_keyBytes) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    /** Finds the next slot carrying tag.
+        probe counts the slots already examined and generation detects a
+        resize between calls, after which the search starts over.
+    */
+    bool
+    findSlot (std::uint64_t tag, std::uint64_t& probe,
+        std::uint64_t& generation, IndexSlot& result)
+    {
+        std::lock_guard <std::mutex> lock (m_indexMutex);
+
+        if (probe == 0 || generation != m_generation)
+        {
+            probe = 0;
+            generation = m_generation;
+        }
+
+        std::uint64_t const capacity = m_header->capacity;
+        while (probe < capacity)
+        {
+            IndexSlot const& slot = m_slots [(tag + probe) & (capacity - 1)];
+            ++probe;
+
+            if (slot.size == 0)
+                return false;
+
+            if (slot.tag == tag)
+            {
+                result = slot;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    static
+    void
+    insertSlot (IndexSlot* slots, std::uint64_t capacity,
+        IndexSlot const& slot)
+    {
+        std::uint64_t pos = slot.tag & (capacity - 1);
+        while (slots [pos].size != 0)
+            pos = (pos + 1) & (capacity - 1);
+        slots [pos] = slot;
+    }
+
+    // Caller must hold m_indexMutex
+    void
+    insert (IndexSlot const& slot)
+    {
+        // Keep the table at most half full so probe chains stay short
+        if ((m_header->count + 1) * 2 > m_header->capacity)
+            grow ();
+
+        insertSlot (m_slots, m_header->capacity, slot);
+        ++m_header->count;
+    }
+
+    //--------------------------------------------------------------------------
+
+    boost::filesystem::path
+    indexPath () const
+    {
+        return m_dir / "index.dat";
+    }
+
+    void
+    createIndex (boost::filesystem::path const& path, std::uint64_t capacity)
+    {
+        IndexHeader const header = { indexMagic, indexVersion,
+            static_cast <std::uint32_t> (m_keyBytes), capacity, 0, 0 };
+
+        std::FILE* const file = std::fopen (path.string ().c_str (), "wb");
+        if (file == nullptr)
+            throw std::runtime_error ("Unable to create " + path.string ());
+        bool const written = std::fwrite (&header, sizeof (header), 1, file) == 1;
+        std::fclose (file);
+        if (! written)
+            throw std::runtime_error ("Unable to write " + path.string ());
+
+        boost::filesystem::resize_file (path,
+            sizeof (IndexHeader) + capacity * sizeof (IndexSlot));
+    }
+
+    static
+    void
+    mapIndex (boost::filesystem::path const& path, Region& region)
+    {
+        boost::interprocess::file_mapping file (
+            path.string ().c_str (), boost::interprocess::read_write);
+        Region (file, boost::interprocess::read_write).swap (region);
+    }
+
+    void
+    setPointers ()
+    {
+        m_header = static_cast <IndexHeader*> (m_region.get_address ());
+        m_slots = reinterpret_cast <IndexSlot*> (m_header + 1);
+    }
+
+    bool
+    isValidIndex (boost::system::error_code& ec)
+    {
+        std::uint64_t const fileSize = boost::filesystem::file_size (
+            indexPath (), ec);
+        if (ec || fileSize < sizeof (IndexHeader))
+            return false;
+
+        mapIndex (indexPath (), m_region);
+        setPointers ();
+
+        std::uint64_t const capacity = m_header->capacity;
+        return m_header->magic == indexMagic &&
+            m_header->version == indexVersion &&
+            m_header->keyBytes == m_keyBytes &&
+            capacity != 0 && (capacity & (capacity - 1)) == 0 &&
+            fileSize == sizeof (IndexHeader) + capacity * sizeof (IndexSlot) &&
+            m_header->dataSize <= m_data->size ();
+    }
+
+    void
+    openIndex ()
+    {
+        boost::system::error_code ec;
+        if (! isValidIndex (ec))
+        {
+            if (m_data->size () != 0)
+            {
+                if (m_journal.warning) m_journal.warning <<
+                    "Rebuilding index of " << m_dir.string ();
+            }
+
+            Region ().swap (m_region);
+            createIndex (indexPath (), m_indexSlots);
+            mapIndex (indexPath (), m_region);
+            setPointers ();
+        }
+
+        if (m_header->dataSize < m_data->size ())
+            recover ();
+    }
+
+    // Indexes the records written after the index was last updated
+    void
+    recover ()
+    {
+        std::uint64_t const end = m_data->size ();
+        std::uint64_t offset = m_header->dataSize;
+        std::vector <std::uint8_t> record;
+        std::uint32_t size;
+        std::size_t recovered = 0;
+
+        while (readHead (offset, end, record, size))
+        {
+            if (! contains (record.data ()))
+            {
+                IndexSlot slot;
+                slot.tag = getTag (record.data ());
+                slot.offset = offset;
+                slot.size = size;
+                slot.reserved = 0;
+
+                std::lock_guard <std::mutex> lock (m_indexMutex);
+                insert (slot);
+                ++recovered;
+            }
+
+            offset += m_keyBytes + sizeBytes + size;
+        }
+
+        if (offset != end)
+        {
+            if (m_journal.warning) m_journal.warning <<
+                "Discarding " << (end - offset) <<
+                " bytes of partial record in " << m_dir.string ();
+            m_data->truncate (offset);
+        }
+
+        m_header->dataSize = offset;
+
+        if (m_journal.info) m_journal.info <<
+            "Indexed " << recovered << " records in " << m_dir.string ();
+    }
+
+    // Caller must hold m_indexMutex
+    void
+    grow ()
+    {
+        std::uint64_t const capacity = m_header->capacity * 2;
+        boost::filesystem::path const temp = m_dir / "index.tmp";
+
+        createIndex (temp, capacity);
+        {
+            Region region;
+            mapIndex (temp, region);
+
+            IndexHeader* const header =
+                static_cast <IndexHeader*> (region.get_address ());
+            IndexSlot* const slots = reinterpret_cast <IndexSlot*> (header + 1);
+
+            *header = *m_header;
+            header->capacity = capacity;
+
+            for (std::uint64_t i = 0; i < m_header->capacity; ++i)
+            {
+                if (m_slots [i].size != 0)
+                    insertSlot (slots, capacity, m_slots [i]);
+            }
+
+            region.flush ();
+        }
+
+        // The old mapping must be released before the file is replaced
+        Region ().swap (m_region);
+        boost::filesystem::rename (temp, indexPath ());
+        mapIndex (indexPath (), m_region);
+        setPointers ();
+        ++m_generation;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+class AppendLogFactory : public Factory
+{
+public:
+    std::string
+    getName () const
+    {
+        return "AppendLog";
+    }
+
+    std::unique_ptr <Backend>
+    createInstance (
+        size_t keyBytes,
+        Parameters const& keyValues,
+        Scheduler& scheduler,
+        beast::Journal journal)
+    {
+        return std::make_unique <AppendLogBackend> (
+            keyBytes, keyValues, scheduler, journal);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+std::unique_ptr <Factory>
+make_AppendLogFactory ()
+{
+    return std::make_unique <AppendLogFactory> ();
+}
+
+}
+}
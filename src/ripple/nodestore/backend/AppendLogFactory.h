@@ -0,0 +1,41 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_APPENDLOGFACTORY_H_INCLUDED
+#define RIPPLE_NODESTORE_APPENDLOGFACTORY_H_INCLUDED
+
+#include <ripple/nodestore/Factory.h>
+
+namespace ripple {
+namespace NodeStore {
+
+/** Factory to produce append-only log backends for the NodeStore.
+
+    Objects are appended to a single data file and located through a
+    memory-mapped hash index, so that a fetch costs at most one random
+    read and a batch of stores costs one sequential write.
+
+    @see Database
+*/
+std::unique_ptr <Factory> make_AppendLogFactory ();
+
+}
+}
+
+#endif
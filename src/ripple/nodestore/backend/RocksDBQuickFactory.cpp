@@ -184,10 +184,6 @@ public:
     Status
     fetch (void const* key, NodeObject::Ptr* pObject)
     {
-        pObject->reset ();
-
-        Status status (ok);
-
         rocksdb::ReadOptions const options;
         rocksdb::Slice const slice (static_cast <char const*> (key), m_keyBytes);
 
@@ -195,6 +191,51 @@ public:
 
         rocksdb::Status getStatus = m_db->Get (options, slice, &string);
 
+        return decode (key, getStatus, string, pObject);
+    }
+
+    std::vector <Status>
+    fetchBatch (std::vector <void const*> const& keys,
+        std::vector <NodeObject::Ptr>* pObjects)
+    {
+        std::vector <rocksdb::Slice> slices;
+        slices.reserve (keys.size ());
+
+        for (auto const key : keys)
+            slices.emplace_back (static_cast <char const*> (key), m_keyBytes);
+
+        // A single MultiGet references one version of the database
+        // for the whole batch instead of once per key.
+        rocksdb::ReadOptions const options;
+        std::vector <std::string> strings;
+
+        std::vector <rocksdb::Status> const getStatus (
+            m_db->MultiGet (options, slices, &strings));
+
+        std::vector <Status> results;
+        results.reserve (keys.size ());
+
+        pObjects->clear ();
+        pObjects->resize (keys.size ());
+
+        for (std::size_t i = 0; i < keys.size (); ++i)
+        {
+            results.push_back (decode (keys [i], getStatus [i],
+                strings [i], &(*pObjects) [i]));
+        }
+
+        return results;
+    }
+
+    // Creates the object from the result of a read
+    Status
+    decode (void const* key, rocksdb::Status const& getStatus,
+        std::string const& string, NodeObject::Ptr* pObject)
+    {
+        pObject->reset ();
+
+        Status status (ok);
+
         if (getStatus.ok ())
         {
             DecodedBlob decoded (key, string.data (), string.size ());
@@ -24,5 +24,21 @@ Backend::~Backend ()
 {
 }
 
+std::vector <Status>
+Backend::fetchBatch (std::vector <void const*> const& keys,
+    std::vector <NodeObject::Ptr>* pObjects)
+{
+    std::vector <Status> results;
+    results.reserve (keys.size ());
+
+    pObjects->clear ();
+    pObjects->resize (keys.size ());
+
+    for (std::size_t i = 0; i < keys.size (); ++i)
+        results.push_back (fetch (keys [i], &(*pObjects) [i]));
+
+    return results;
+}
+
 }
 }
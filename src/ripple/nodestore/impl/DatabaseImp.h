@@ -69,7 +69,8 @@ public:
         , m_backend (std::move (backend))
         , m_fastBackend (std::move (fastBackend))
         , m_cache ("NodeStore", cacheTargetSize, cacheTargetSeconds,
-            get_seconds_clock (), deprecatedLogs().journal("TaggedCache"))
+            get_seconds_clock (), deprecatedLogs().journal("TaggedCache"),
+                beast::insight::NullCollector::New (), cachePartitions)
         , m_negCache ("NodeStore", get_seconds_clock (),
             cacheTargetSize, cacheTargetSeconds)
         , m_readShut (false)
@@ -163,11 +164,79 @@ public:
             (std::chrono::steady_clock::now() - before);
 
         report.wasFound = (ret != nullptr);
+        report.fetchCount = 1;
+        report.foundCount = report.wasFound ? 1 : 0;
         m_scheduler.onFetch (report);
 
         return ret;
     }
 
+    /** Perform a batch of asynchronous fetches and report the time it took.
+        The hashes must be in ascending order.
+    */
+    void doTimedFetchBatch (std::vector <uint256> const& hashes)
+    {
+        FetchReport report;
+        report.isAsync = true;
+        report.wentToDisk = false;
+
+        auto const before = std::chrono::steady_clock::now();
+
+        // Objects may have arrived since the reads were posted
+        std::vector <uint256> missing;
+        missing.reserve (hashes.size ());
+
+        for (auto const& hash : hashes)
+        {
+            if (m_cache.fetch (hash) == nullptr &&
+                    ! m_negCache.touch_if_exists (hash))
+                missing.push_back (hash);
+        }
+
+        report.fetchCount = hashes.size ();
+        report.foundCount = hashes.size () - missing.size ();
+
+        if (! missing.empty ())
+        {
+            report.wentToDisk = true;
+            report.fetchCount = missing.size ();
+            report.foundCount = 0;
+
+            std::vector <NodeObject::Ptr> objects (missing.size ());
+            std::vector <bool> foundInFastBackend (missing.size (), false);
+
+            if (m_fastBackend != nullptr)
+            {
+                fetchInternal (*m_fastBackend, missing, objects);
+
+                for (std::size_t i = 0; i < missing.size (); ++i)
+                    foundInFastBackend [i] = (objects [i] != nullptr);
+            }
+
+            for (auto const& object : objects)
+            {
+                if (object == nullptr)
+                    ++m_fetchTotalCount;
+            }
+
+            fetchFrom (missing, objects);
+
+            for (std::size_t i = 0; i < missing.size (); ++i)
+            {
+                finishFetch (missing [i], objects [i], foundInFastBackend [i]);
+
+                if (objects [i] != nullptr)
+                    ++report.foundCount;
+            }
+        }
+
+        report.elapsed = std::chrono::duration_cast <std::chrono::milliseconds>
+            (std::chrono::steady_clock::now() - before);
+
+        report.wasFound = (report.foundCount != 0);
+        m_scheduler.onFetch (report);
+    }
+
     NodeObject::Ptr doFetch (uint256 const& hash, FetchReport &report)
     {
         // See if the object already exists in the cache
@@ -206,6 +275,15 @@ public:
             ++m_fetchTotalCount;
         }
 
+        finishFetch (hash, obj, foundInFastBackend);
+
+        return obj;
+    }
+
+    // Updates the caches once an object was looked for in the backends
+    void finishFetch (uint256 const& hash, NodeObject::Ptr& obj,
+        bool foundInFastBackend)
+    {
         if (obj == nullptr)
         {
 
@@ -242,8 +320,6 @@ public:
                     "HOS: " << hash << " fetch: in db";
             }
         }
-
-        return obj;
     }
 
     virtual NodeObject::Ptr fetchFrom (uint256 const& hash)
@@ -251,6 +327,13 @@ public:
         return fetchInternal (*m_backend, hash);
     }
 
+    // Fetches the objects of the batch which are still null
+    virtual void fetchFrom (std::vector <uint256> const& hashes,
+        std::vector <NodeObject::Ptr>& objects)
+    {
+        fetchInternal (*m_backend, hashes, objects);
+    }
+
     NodeObject::Ptr fetchInternal (Backend& backend,
         uint256 const& hash)
     {
@@ -258,6 +341,44 @@ public:
 
         Status const status = backend.fetch (hash.begin (), &object);
 
+        checkStatus (status, hash, object);
+
+        return object;
+    }
+
+    // Fetches the objects of the batch which are still null
+    void fetchInternal (Backend& backend,
+        std::vector <uint256> const& hashes,
+            std::vector <NodeObject::Ptr>& objects)
+    {
+        std::vector <void const*> keys;
+        std::vector <std::size_t> index;
+
+        for (std::size_t i = 0; i < hashes.size (); ++i)
+        {
+            if (objects [i] == nullptr)
+            {
+                keys.push_back (hashes [i].begin ());
+                index.push_back (i);
+            }
+        }
+
+        if (keys.empty ())
+            return;
+
+        std::vector <NodeObject::Ptr> found;
+        std::vector <Status> const status (backend.fetchBatch (keys, &found));
+
+        for (std::size_t i = 0; i < keys.size (); ++i)
+        {
+            checkStatus (status [i], hashes [index [i]], found [i]);
+            objects [index [i]] = std::move (found [i]);
+        }
+    }
+
+    void checkStatus (Status status, uint256 const& hash,
+        NodeObject::Ptr const& object)
+    {
         switch (status)
         {
         case ok:
@@ -279,8 +400,6 @@ public:
                 "Unknown status=" << status;
             break;
         }
-
-        return object;
     }
 
     //------------------------------------------------------------------------------
@@ -356,9 +475,12 @@ public:
     void threadEntry ()
     {
         beast::Thread::setCurrentThreadName ("prefetch");
+        std::vector <uint256> hashes;
+        hashes.reserve (asyncReadBatchSize);
+
         while (1)
         {
-            uint256 hash;
+            hashes.clear ();
 
             {
                 std::unique_lock <std::mutex> lock (m_readLock);
@@ -384,13 +506,23 @@ public:
                     m_readGenCondVar.notify_all ();
                 }
 
-                hash = *it;
-                m_readSet.erase (it);
-                m_readLast = hash;
+                // Take a run of keys in order, leaving work
+                // for the other read threads
+                std::size_t const count (std::max <std::size_t> (1,
+                    std::min <std::size_t> (asyncReadBatchSize,
+                        m_readSet.size () / m_readThreads.size ())));
+
+                while (it != m_readSet.end () && hashes.size () < count)
+                {
+                    hashes.push_back (*it);
+                    it = m_readSet.erase (it);
+                }
+
+                m_readLast = hashes.back ();
             }
 
-            // Perform the read
-            doTimedFetch (hash, true);
+            // Perform the reads
+            doTimedFetchBatch (hashes);
          }
      }
 
@@ -49,6 +49,28 @@ NodeObject::Ptr DatabaseRotatingImp::fetchFrom (uint256 const& hash)
 
     return object;
 }
+
+void DatabaseRotatingImp::fetchFrom (std::vector <uint256> const& hashes,
+    std::vector <NodeObject::Ptr>& objects)
+{
+    Backends b = getBackends();
+    fetchInternal (*b.writableBackend, hashes, objects);
+
+    std::vector <bool> missing (objects.size ());
+    for (std::size_t i = 0; i < objects.size (); ++i)
+        missing [i] = (objects [i] == nullptr);
+
+    fetchInternal (*b.archiveBackend, hashes, objects);
+
+    for (std::size_t i = 0; i < objects.size (); ++i)
+    {
+        if (missing [i] && objects [i] != nullptr)
+        {
+            getWritableBackend()->store (objects [i]);
+            m_negCache.erase (hashes [i]);
+        }
+    }
+}
 }
 
 }
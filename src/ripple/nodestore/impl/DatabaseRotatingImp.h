@@ -117,6 +117,9 @@ public:
     }
 
     NodeObject::Ptr fetchFrom (uint256 const& hash) override;
+    void fetchFrom (std::vector <uint256> const& hashes,
+        std::vector <NodeObject::Ptr>& objects) override;
+
     TaggedCache <uint256, NodeObject>& getPositiveCache() override
     {
         return m_cache;
@@ -23,6 +23,22 @@ namespace ripple {
 namespace NodeStore {
 
 DecodedBlob::DecodedBlob (void const* key, void const* value, int valueBytes)
+    : m_key (key)
+{
+    decode (value, valueBytes);
+}
+
+DecodedBlob::DecodedBlob (void const* key, Blob&& buffer, std::size_t offset)
+    : m_key (key)
+    , m_buffer (std::move (buffer))
+{
+    assert (offset <= m_buffer.size ());
+    decode (m_buffer.data () + offset,
+        static_cast <int> (m_buffer.size () - offset));
+}
+
+void
+DecodedBlob::decode (void const* value, int valueBytes)
 {
     /*  Data format:
 
@@ -35,7 +51,6 @@ DecodedBlob::DecodedBlob (void const* key, void const* value, int valueBytes)
     */
 
     m_success = false;
-    m_key = key;
     // VFALCO NOTE Ledger indexes should have started at 1
     m_ledgerIndex = LedgerIndex (-1);
     m_objectType = hotUNKNOWN;
@@ -82,7 +97,14 @@ NodeObject::Ptr DecodedBlob::createObject ()
 
     NodeObject::Ptr object;
 
-    if (m_success)
+    if (m_success && ! m_buffer.empty ())
+    {
+        std::size_t const offset = m_objectData - m_buffer.data ();
+
+        object = NodeObject::createObject (m_objectType, m_ledgerIndex,
+            std::move (m_buffer), offset, uint256::fromVoid (m_key));
+    }
+    else if (m_success)
     {
         Blob data(m_objectData, m_objectData + m_dataBytes);
 
@@ -41,6 +41,13 @@ public:
     /** Construct the decoded blob from raw data. */
     DecodedBlob (void const* key, void const* value, int valueBytes);
 
+    /** Construct the decoded blob from a buffer filled by a backend.
+
+        The value starts at offset within the buffer. The NodeObject made
+        by createObject takes the buffer over instead of copying the data.
+    */
+    DecodedBlob (void const* key, Blob&& buffer, std::size_t offset);
+
     /** Determine if the decoding was successful. */
     bool wasOk () const noexcept { return m_success; }
 
@@ -48,6 +55,8 @@ public:
     NodeObject::Ptr createObject ();
 
 private:
+    void decode (void const* value, int valueBytes);
+
     bool m_success;
 
     void const* m_key;
@@ -55,6 +64,7 @@ private:
     NodeObjectType m_objectType;
     unsigned char const* m_objectData;
     int m_dataBytes;
+    Blob m_buffer;
 };
 
 }
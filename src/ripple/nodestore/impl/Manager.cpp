@@ -54,6 +54,7 @@ public:
 
         add_factory (make_LevelDBFactory ());
 
+        add_factory (make_AppendLogFactory ());
         add_factory (make_MemoryFactory ());
         add_factory (make_NullFactory ());
 
@@ -25,12 +25,15 @@ NodeObject::NodeObject (
     NodeObjectType type,
     LedgerIndex ledgerIndex,
     Blob&& data,
+    std::size_t offset,
     uint256 const& hash,
     PrivateAccess)
     : mType (type)
     , mHash (hash)
     , mLedgerIndex (ledgerIndex)
+    , mOffset (offset)
 {
+    assert (offset <= data.size ());
     mData = std::move (data);
 }
 
@@ -41,7 +44,18 @@ NodeObject::Ptr NodeObject::createObject (
     uint256 const& hash)
 {
     return std::make_shared <NodeObject> (
-        type, ledgerIndex, std::move (data), hash, PrivateAccess ());
+        type, ledgerIndex, std::move (data), 0, hash, PrivateAccess ());
+}
+
+NodeObject::Ptr NodeObject::createObject (
+    NodeObjectType type,
+    LedgerIndex ledgerIndex,
+    Blob&& data,
+    std::size_t offset,
+    uint256 const& hash)
+{
+    return std::make_shared <NodeObject> (
+        type, ledgerIndex, std::move (data), offset, hash, PrivateAccess ());
 }
 
 NodeObjectType
@@ -62,10 +76,10 @@ NodeObject::getLedgerIndex () const
     return mLedgerIndex;
 }
 
-Blob const&
+const_byte_view
 NodeObject::getData () const
 {
-    return mData;
+    return const_byte_view (mData.data () + mOffset, mData.size () - mOffset);
 }
 
 bool
@@ -80,7 +94,7 @@ NodeObject::isCloneOf (NodeObject::Ptr const& other) const
     if (mLedgerIndex != other->mLedgerIndex)
         return false;
 
-    if (mData != other->mData)
+    if (getData () != other->getData ())
         return false;
 
     return true;
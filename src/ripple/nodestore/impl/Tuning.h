@@ -31,8 +31,14 @@ enum
     // Expiration time for cached nodes
     ,cacheTargetSeconds = 300
 
+    // Number of independently locked partitions in the node cache
+    ,cachePartitions = 16
+
     // Fraction of the cache one query source can take
     ,asyncDivider = 8
+
+    // Most keys one read thread fetches from the backend at once
+    ,asyncReadBatchSize = 64
 };
 
 }
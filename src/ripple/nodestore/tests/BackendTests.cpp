@@ -62,6 +62,14 @@ public:
                 expect (areBatchesEqual (batch, copy), "Should be equal");
             }
 
+            {
+                // Read it back in one batch, with missing objects
+                Batch missing;
+                createPredictableBatch (missing, numObjectsToTest / 10,
+                    seedValue + 1);
+                fetchBatchWithMissing (*backend, batch, missing);
+            }
+
             {
                 // Reorder and read the copy again
                 Batch copy;
@@ -94,6 +102,8 @@ public:
 
         testBackend ("leveldb", seedValue);
 
+        testBackend ("appendlog", seedValue);
+
     #ifdef RIPPLE_ENABLE_SQLITE_BACKEND_TESTS
         testBackend ("sqlite", seedValue);
     #endif
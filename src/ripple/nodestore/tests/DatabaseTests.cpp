@@ -23,6 +23,67 @@ namespace NodeStore {
 class NodeStoreDatabase_test : public TestBase
 {
 public:
+    // Totals the asynchronous reads reported by the database
+    struct AsyncScheduler : DummyScheduler
+    {
+        std::atomic <int> fetchCount;
+        std::atomic <int> foundCount;
+
+        AsyncScheduler ()
+            : fetchCount (0)
+            , foundCount (0)
+        {
+        }
+
+        void onFetch (FetchReport const& report) override
+        {
+            if (report.isAsync)
+            {
+                fetchCount += report.fetchCount;
+                foundCount += report.foundCount;
+            }
+        }
+    };
+
+    // Posts asynchronous reads for a batch and waits for them to finish
+    void testAsyncFetch (Manager& manager, beast::StringPairArray const& params,
+        Batch const& batch)
+    {
+        AsyncScheduler scheduler;
+        beast::Journal j;
+        int const count (batch.size ());
+
+        std::unique_ptr <Database> db (manager.make_Database (
+            "test", scheduler, j, 2, params));
+
+        for (auto const& object : batch)
+        {
+            NodeObject::Ptr found;
+            expect (! db->asyncFetch (object->getHash (), found),
+                "Should not be cached");
+        }
+
+        // Wait for the read threads, 10 seconds should be enough
+        for (int i = 0; i < 10000 &&
+                scheduler.fetchCount.load () < count; ++i)
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+
+        expect (scheduler.fetchCount.load () == count,
+            "Should fetch every object");
+        expect (scheduler.foundCount.load () == count,
+            "Should find every object");
+
+        Batch copy;
+        for (auto const& object : batch)
+        {
+            NodeObject::Ptr found;
+            if (expect (db->asyncFetch (object->getHash (), found),
+                    "Should be cached") && found != nullptr)
+                copy.push_back (found);
+        }
+        expect (areBatchesEqual (batch, copy), "Should be equal");
+    }
+
     void testImport (std::string const& destBackendType,
         std::string const& srcBackendType, std::int64_t seedValue)
     {
@@ -158,6 +219,9 @@ public:
                 expect (areBatchesEqual (batch, copy), "Should be equal");
             }
 
+            // Re-open the database and read it back in asynchronously
+            testAsyncFetch (*manager, nodeParams, batch);
+
             if (useEphemeralDatabase)
             {
                 // Verify the ephemeral db
@@ -182,6 +246,8 @@ public:
     {
         testNodeStore ("leveldb", useEphemeralDatabase, true, seedValue);
 
+        testNodeStore ("appendlog", useEphemeralDatabase, true, seedValue);
+
     #if RIPPLE_HYPERLEVELDB_AVAILABLE
         testNodeStore ("hyperleveldb", useEphemeralDatabase, true, seedValue);
     #endif
@@ -201,6 +267,8 @@ public:
     {
         testImport ("leveldb", "leveldb", seedValue);
 
+        testImport ("appendlog", "appendlog", seedValue);
+
     #if RIPPLE_ROCKSDB_AVAILABLE
         testImport ("rocksdb", "rocksdb", seedValue);
     #endif
@@ -152,6 +152,44 @@ public:
         }
     }
 
+    // Fetch a batch in key order, with objects that were never stored
+    void fetchBatchWithMissing (Backend& backend, Batch const& batch,
+        Batch const& missing)
+    {
+        Batch all (batch);
+        all.insert (all.end (), missing.begin (), missing.end ());
+        std::sort (all.begin (), all.end (), NodeObject::LessThan ());
+
+        std::vector <void const*> keys;
+        for (auto const& object : all)
+            keys.push_back (object->getHash ().cbegin ());
+
+        std::vector <NodeObject::Ptr> objects;
+        std::vector <Status> const status (backend.fetchBatch (keys, &objects));
+
+        if (! expect (status.size () == all.size () &&
+                objects.size () == all.size (), "Wrong result size"))
+            return;
+
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < all.size (); ++i)
+        {
+            if (status [i] == ok)
+            {
+                ++found;
+                expect (objects [i] != nullptr && objects [i]->isCloneOf (
+                    all [i]), "Should be equal");
+            }
+            else
+            {
+                expect (status [i] == notFound, "Should be notFound");
+                expect (objects [i] == nullptr, "Should be null");
+            }
+        }
+
+        expect (found == batch.size (), "Should find every stored object");
+    }
+
     void fetchMissing(Backend& backend, Batch const& batch)
     {
         for (int i = 0; i < batch.size (); ++i)
@@ -172,7 +210,7 @@ public:
         {
             NodeObject::Ptr const object (batch [i]);
 
-            Blob data (object->getData ());
+            Blob data (object->getData ().begin (), object->getData ().end ());
 
             db.store (object->getType (),
                       object->getLedgerIndex (),
@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/basics/AllocationCounter.h>
 #include <limits>
 #include <beast/Config.h>
 
@@ -225,16 +226,20 @@ public:
         return (status == ok) || (status == notFound);
     };
 
-    void testFetch(backend_ptr& backend, NodeFactory& factory,
-                   check_func f)
+    // Returns the number of heap allocations made by the fetches
+    std::uint64_t testFetch(backend_ptr& backend, NodeFactory& factory,
+                            check_func f)
     {
+        std::uint64_t allocations = 0;
         factory.reset();
         while (auto expected = factory.next())
         {
             NodeObject::Ptr got;
 
+            std::uint64_t const before = getThreadAllocations();
             Status const status =
                 backend->fetch(expected->getHash().cbegin(), &got);
+            allocations += getThreadAllocations() - before;
             expect(f(status),
                    "Wrong status for: " + to_string(expected->getHash()));
             if (status == ok)
@@ -243,6 +248,7 @@ public:
                 expect(got->isCloneOf(expected), "Should be clones");
             }
         }
+        return allocations;
     }
 
     static void testInsert(backend_ptr& backend, NodeFactory& factory)
@@ -298,7 +304,8 @@ public:
         results.emplace_back("Fetch 50/50", t.getElapsed());
 
         t.start();
-        testFetch(backend, insertFactory, checkOk);
+        std::uint64_t const allocations =
+            testFetch(backend, insertFactory, checkOk);
         results.emplace_back("Ordered Fetch", t.getElapsed());
 
         t.start();
@@ -309,6 +316,11 @@ public:
         testFetch(backend, missingFactory, checkNotFound);
         results.emplace_back("Fetch Missing", t.getElapsed());
 
+        // Every ordered fetch finds its object
+        if (isCountingAllocations())
+            results.emplace_back("Allocs/Fetch",
+                double(allocations) / numObjects);
+
         return results;
     }
 
@@ -327,11 +339,14 @@ public:
         // 'num_objects' defaults to '100000'
         // 'num_runs' defaults to '3'
         // defaultArguments serves as an example.
+        // Allocations per fetch are reported when RIPPLE_COUNT_ALLOCATIONS
+        // is set in BeastConfig.h.
 
         std::string defaultArguments =
             "type=rocksdb,open_files=2000,filter_bits=12,cache_mb=256"
             "file_size_mb=8,file_size_mult=2,num_objects=100000,num_runs=3;"
-            "type=hyperleveldb,num_objects=100000,num_runs=3";
+            "type=hyperleveldb,num_objects=100000,num_runs=3;"
+            "type=appendlog,num_objects=100000,num_runs=3";
 
         auto args = arg();
 
@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/app/misc/SigVerifier.h>
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/basics/UptimeTimer.h>
 #include <ripple/core/JobQueue.h>
@@ -1376,15 +1377,26 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMTransaction> const& m)
             }
         }
 
-        if (getApp().getJobQueue().getJobCount(jtTRANSACTION) > 100)
+        if (getApp().getJobQueue().getJobCount(jtTRANSACTION) > 100 ||
+                getApp().getSigVerifier().size() > 1000)
             p_journal_.info << "Transaction queue is full";
         else if (getApp().getLedgerMaster().getValidatedLedgerAge() > 240)
             p_journal_.trace << "No new transactions until synchronized";
-        else
+        else if (flags & SF_SIGGOOD)
             getApp().getJobQueue ().addJob (jtTRANSACTION,
                 "recvTransaction->checkTransaction",
                 std::bind(beast::weak_fn(&PeerImp::checkTransaction,
                 shared_from_this()), std::placeholders::_1, flags, stx));
+        else
+        {
+            std::weak_ptr <PeerImp> weak = shared_from_this();
+            getApp().getSigVerifier().verify (stx,
+                [weak, flags](STTx::pointer const& stx, bool good)
+                {
+                    if (auto peer = weak.lock())
+                        peer->onVerifiedTransaction (flags, stx, good);
+                });
+        }
     }
     catch (...)
     {
@@ -1886,11 +1898,10 @@ void
 PeerImp::doFetchPack (const std::shared_ptr<protocol::TMGetObjectByHash>& packet)
 {
     // VFALCO TODO Invert this dependency using an observer and shared state object.
-    // Don't queue fetch pack jobs if we're under load or we already have
-    // some queued.
-    if (getApp().getFeeTrack ().isLoadedLocal () ||
-        (getApp().getLedgerMaster().getValidatedLedgerAge() > 40) ||
-        (getApp().getJobQueue().getJobCount(jtPACK) > 10))
+    // Don't queue fetch pack jobs if we already have some queued. The job
+    // checks the load itself, since packs that were already built can
+    // still be sent when we are too busy to build new ones.
+    if (getApp().getJobQueue().getJobCount(jtPACK) > 10)
     {
         p_journal_.info << "Too busy to make fetch pack";
         return;
@@ -1983,6 +1994,22 @@ PeerImp::checkTransaction (Job&, int flags,
     }
 }
 
+// Called from the SigVerifier's jobs
+void
+PeerImp::onVerifiedTransaction (int flags, STTx::pointer const& stx,
+    bool good)
+{
+    if (! good)
+        return charge (Resource::feeInvalidSignature);
+
+    // Applying may wait on the open ledger, so it gets its own job
+    // rather than holding up the verifier
+    getApp().getJobQueue ().addJob (jtTRANSACTION,
+        "recvTransaction->checkTransaction",
+        std::bind(beast::weak_fn(&PeerImp::checkTransaction,
+        shared_from_this()), std::placeholders::_1, flags | SF_SIGGOOD, stx));
+}
+
 // Called from our JobQueue
 void
 PeerImp::checkPropose (Job& job,
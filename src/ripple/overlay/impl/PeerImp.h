@@ -449,6 +449,9 @@ private:
     void
     checkTransaction (Job&, int flags, STTx::pointer stx);
 
+    void
+    onVerifiedTransaction (int flags, STTx::pointer const& stx, bool good);
+
     void
     checkPropose (Job& job,
         std::shared_ptr<protocol::TMProposeSet> const& packet,
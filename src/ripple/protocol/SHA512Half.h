@@ -0,0 +1,90 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_SHA512HALF_H_INCLUDED
+#define RIPPLE_PROTOCOL_SHA512HALF_H_INCLUDED
+
+#include <ripple/basics/byte_view.h>
+#include <ripple/types/base_uint.h>
+#include <openssl/sha.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace ripple {
+
+/** Incrementally computes the first half of a SHA-512 digest.
+
+    The pieces of a hashed object are fed in order, so a prefixed object
+    can be hashed without first copying it into a contiguous buffer.
+    Integers are added in big-endian order, like Serializer does.
+
+    @ingroup protocol
+*/
+class SHA512Half
+{
+public:
+    SHA512Half ();
+
+    /** Starts a hash with a four byte prefix, usually a HashPrefix. */
+    explicit
+    SHA512Half (std::uint32_t prefix);
+
+    SHA512Half (SHA512Half const&) = delete;
+    SHA512Half& operator= (SHA512Half const&) = delete;
+
+    void add (void const* data, std::size_t size);
+
+    void add (const_byte_view data)
+    {
+        add (data.data (), data.size ());
+    }
+
+    void add (Blob const& data)
+    {
+        add (data.data (), data.size ());
+    }
+
+    void add32 (std::uint32_t i);
+
+    void add256 (uint256 const& i)
+    {
+        add (i.begin (), i.size ());
+    }
+
+    /** Returns the digest. The hasher may not be used afterwards. */
+    uint256 finish ();
+
+    /** Computes the digests of several independent messages.
+
+        Runs of messages with the same length are hashed together, several
+        at a time, when the CPU supports AVX2 or AVX-512. Other messages
+        are hashed one at a time. Batches of inner nodes benefit the most,
+        since all inner nodes have the same length.
+    */
+    static
+    void batch (const_byte_view const* messages, uint256* digests,
+        std::size_t count);
+
+private:
+    SHA512_CTX ctx_;
+};
+
+} // ripple
+
+#endif
@@ -37,6 +37,19 @@ public:
     */
     STParsedJSONObject (std::string const& name, Json::Value const& json);
 
+    /** Parses a JSON document directly into an STObject.
+        The rules are the same as for a Json::Value, but no Json::Value is
+        built for the document: the STObject is assembled while the text
+        in [begin, end) is scanned.
+        Exceptions:
+            Does not throw.
+        @param name The name of the JSON field, used in diagnostics.
+        @param begin The start of the JSON text.
+        @param end One past the end of the JSON text.
+    */
+    STParsedJSONObject (std::string const& name,
+        char const* begin, char const* end);
+
     STParsedJSONObject () = delete;
     STParsedJSONObject (STParsedJSONObject const&) = delete;
     STParsedJSONObject& operator= (STParsedJSONObject const&) = delete;
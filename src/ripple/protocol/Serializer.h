@@ -61,6 +61,12 @@ public:
     {
         ;
     }
+    Serializer (void const* data, std::size_t size) :
+        mData (static_cast <unsigned char const*> (data),
+            static_cast <unsigned char const*> (data) + size)
+    {
+        ;
+    }
 
     // assemble functions
     int add8 (unsigned char byte);
@@ -0,0 +1,258 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/json/json_parser.h>
+#include <ripple/json/json_reader.h>
+#include <ripple/json/to_string.h>
+#include <ripple/protocol/STArray.h>
+#include <ripple/protocol/STParsedJSON.h>
+#include <ripple/protocol/STTx.h>
+#include <beast/module/core/maths/Random.h>
+#include <beast/unit_test/suite.h>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace ripple {
+
+/** Measures the throughput of reading JSON-RPC requests.
+
+    Each request submits a payment carrying an issued currency amount and
+    a memo. The requests are read with Json::Reader and with Json::Parser,
+    both into a Json::Value and as bare parse events, and the tx_json of
+    each is parsed into an STObject both through a Json::Value and
+    directly from the text.
+
+    Parameters, for example:
+
+        num_tx=1000,passes=20
+*/
+class JsonParser_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    // Visits every value without building anything
+    struct NullHandler : Json::ParseHandler
+    {
+        std::size_t count = 0;
+
+        bool onNull () override { ++count; return true; }
+        bool onBool (bool) override { ++count; return true; }
+        bool onInt (Json::Value::Int) override { ++count; return true; }
+        bool onUInt (Json::Value::UInt) override { ++count; return true; }
+        bool onDouble (double) override { ++count; return true; }
+        bool onString (char const*, std::size_t) override
+            { ++count; return true; }
+        bool onObjectBegin () override { ++count; return true; }
+        bool onKey (char const*, std::size_t) override { return true; }
+        bool onObjectEnd () override { return true; }
+        bool onArrayBegin () override { ++count; return true; }
+        bool onArrayEnd () override { return true; }
+    };
+
+    beast::Random r_;
+
+    template <class T>
+    T random ()
+    {
+        T t;
+        for (auto& c : t)
+            c = static_cast<unsigned char> (r_.nextInt (256));
+        return t;
+    }
+
+    Blob randomBlob (std::size_t size)
+    {
+        Blob b (size);
+        for (auto& c : b)
+            c = static_cast<unsigned char> (r_.nextInt (256));
+        return b;
+    }
+
+    std::unique_ptr <STTx> makeTx ()
+    {
+        Account const issuer = random <Account> ();
+
+        auto tx = std::make_unique <STTx> (ttPAYMENT);
+        tx->setFieldAccount (sfAccount, random <Account> ());
+        tx->setFieldAccount (sfDestination, random <Account> ());
+        tx->setFieldAmount (sfAmount, STAmount (Issue (to_currency ("USD"),
+            issuer), std::uint64_t (r_.nextInt (1000000) + 1), -2));
+        tx->setFieldAmount (sfFee, STAmount (10));
+        tx->setFieldU32 (sfSequence, r_.nextInt (100000));
+        tx->setFieldU32 (sfFlags, 0x80000000);
+        tx->setFieldVL (sfSigningPubKey, randomBlob (33));
+        tx->setFieldVL (sfTxnSignature, randomBlob (71));
+
+        STObject memo (sfMemo);
+        memo.setFieldVL (sfMemoType, strCopy ("text/plain"));
+        memo.setFieldVL (sfMemoData, randomBlob (64));
+        STArray memos (sfMemos);
+        memos.push_back (memo);
+        tx->setFieldArray (sfMemos, memos);
+
+        return tx;
+    }
+
+    template <class Function>
+    double measure (std::size_t passes, Function f)
+    {
+        auto const start = clock_type::now ();
+        for (std::size_t pass = 0; pass < passes; ++pass)
+            f ();
+        return std::chrono::duration <double> (
+            clock_type::now () - start).count () / passes;
+    }
+
+    void report (std::string const& name, double seconds,
+        std::size_t count, std::size_t bytes)
+    {
+        std::stringstream ss;
+        ss << std::setprecision (2) << std::fixed;
+        ss << std::left << std::setw (10) << name << (seconds * 1000) <<
+            " ms, " << std::setprecision (0) << (count / seconds) <<
+                " docs/s, " << std::setprecision (1) <<
+                    (bytes / seconds / 1000000) << " MB/s";
+        log << ss.str ();
+    }
+
+    void run ()
+    {
+        auto params = parseDelimitedKeyValueString (arg (), ',');
+
+        std::size_t numTx = 1000;
+        if (! params["num_tx"].isEmpty ())
+            numTx = params["num_tx"].getIntValue ();
+
+        std::size_t passes = 20;
+        if (! params["passes"].isEmpty ())
+            passes = params["passes"].getIntValue ();
+
+        testcase ("parse requests");
+
+        std::vector <std::unique_ptr <STTx>> txs;
+        std::vector <std::string> txTexts;
+        std::vector <std::string> requests;
+        std::size_t txBytes = 0;
+        std::size_t requestBytes = 0;
+
+        for (std::size_t i = 0; i < numTx; ++i)
+        {
+            txs.push_back (makeTx ());
+
+            Json::Value tx = txs.back ()->getJson (0);
+            tx.removeMember ("hash");
+            txTexts.push_back (to_string (tx));
+            txBytes += txTexts.back ().size ();
+
+            Json::Value request (Json::objectValue);
+            request["id"] = static_cast <Json::UInt> (i);
+            request["command"] = "submit";
+            request["fail_hard"] = false;
+            request["tx_json"] = tx;
+            requests.push_back (to_string (request));
+            requestBytes += requests.back ().size ();
+        }
+
+        std::vector <Json::Value> read (numTx);
+        double const reader = measure (passes, [&]()
+        {
+            Json::Reader reader;
+            for (std::size_t i = 0; i < numTx; ++i)
+                reader.parse (requests[i], read[i]);
+        });
+
+        std::vector <Json::Value> parsed (numTx);
+        double const parser = measure (passes, [&]()
+        {
+            Json::Parser parser;
+            for (std::size_t i = 0; i < numTx; ++i)
+                parser.parse (requests[i], parsed[i]);
+        });
+
+        expect (parsed == read, "Parser and Reader disagree");
+
+        std::size_t values = 0;
+        double const events = measure (passes, [&]()
+        {
+            Json::Parser parser;
+            NullHandler handler;
+            for (auto const& request : requests)
+                parser.parse (request.data (),
+                    request.data () + request.size (), handler);
+            values = handler.count;
+        });
+
+        expect (values != 0);
+
+        std::vector <std::unique_ptr <STObject>> objects (numTx);
+
+        auto const mismatches = [&]()
+        {
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < numTx; ++i)
+            {
+                if (! objects[i] || objects[i]->getSerializer ().peekData () !=
+                        txs[i]->getSerializer ().peekData ())
+                    ++count;
+                objects[i].reset ();
+            }
+            return count;
+        };
+
+        double const fromValue = measure (passes, [&]()
+        {
+            Json::Reader reader;
+            Json::Value value;
+            for (std::size_t i = 0; i < numTx; ++i)
+            {
+                reader.parse (txTexts[i], value);
+                STParsedJSONObject parsed ("tx_json", value);
+                objects[i] = std::move (parsed.object);
+            }
+        });
+
+        expect (mismatches () == 0, "Objects changed through a Json::Value");
+
+        double const direct = measure (passes, [&]()
+        {
+            for (std::size_t i = 0; i < numTx; ++i)
+            {
+                std::string const& text = txTexts[i];
+                STParsedJSONObject parsed ("tx_json",
+                    text.data (), text.data () + text.size ());
+                objects[i] = std::move (parsed.object);
+            }
+        });
+
+        expect (mismatches () == 0, "Objects changed by parsing text directly");
+
+        report ("reader", reader, numTx, requestBytes);
+        report ("parser", parser, numTx, requestBytes);
+        report ("events", events, numTx, requestBytes);
+        report ("st value", fromValue, numTx, txBytes);
+        report ("st direct", direct, numTx, txBytes);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(JsonParser,ripple_data,ripple);
+
+} // ripple
@@ -0,0 +1,57 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/protocol/SHA512Half.h>
+
+namespace ripple {
+
+SHA512Half::SHA512Half ()
+{
+    SHA512_Init (&ctx_);
+}
+
+SHA512Half::SHA512Half (std::uint32_t prefix)
+{
+    SHA512_Init (&ctx_);
+    add32 (prefix);
+}
+
+void SHA512Half::add (void const* data, std::size_t size)
+{
+    SHA512_Update (&ctx_, data, size);
+}
+
+void SHA512Half::add32 (std::uint32_t i)
+{
+    unsigned char be[4];
+    be[0] = static_cast<unsigned char> (i >> 24);
+    be[1] = static_cast<unsigned char> ((i >> 16) & 0xff);
+    be[2] = static_cast<unsigned char> ((i >> 8) & 0xff);
+    be[3] = static_cast<unsigned char> (i & 0xff);
+    add (be, sizeof (be));
+}
+
+uint256 SHA512Half::finish ()
+{
+    uint256 j[2];
+    SHA512_Final (reinterpret_cast<unsigned char*> (&j[0]), &ctx_);
+    return j[0];
+}
+
+} // ripple
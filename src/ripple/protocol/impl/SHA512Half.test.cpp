@@ -0,0 +1,305 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/SHA512Half.h>
+#include <ripple/protocol/Serializer.h>
+#include <beast/module/core/maths/Random.h>
+#include <beast/unit_test/suite.h>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace ripple {
+
+class SHA512Half_test : public beast::unit_test::suite
+{
+public:
+    void testKnownDigest ()
+    {
+        testcase ("known digest");
+
+        std::string const abc ("abc");
+        SHA512Half h;
+        h.add (abc.data (), abc.size ());
+
+        // First half of the SHA-512 digest of "abc" from FIPS 180-2
+        expect (to_string (h.finish ()) ==
+            "DDAF35A193617ABACC417349AE20413112E6FA4E89A97EA20A9EEEE64B55D39A");
+    }
+
+    void testIncremental ()
+    {
+        testcase ("incremental");
+
+        beast::Random r (42);
+        Blob data (300);
+        for (auto& c : data)
+            c = static_cast<unsigned char> (r.nextInt (256));
+
+        for (std::size_t split = 0; split <= data.size (); split += 7)
+        {
+            SHA512Half h;
+            h.add (data.data (), split);
+            h.add (data.data () + split, data.size () - split);
+            expect (h.finish () == Serializer::getSHA512Half (data));
+        }
+
+        uint256 tag;
+        tag.SetHex ("B92891FE4EF6CEE585FDC6FDA0E09EB4D386363158EC3321B8123E5A772C6CA8");
+
+        Serializer s;
+        s.add32 (HashPrefix::leafNode);
+        s.addRaw (data);
+        s.add256 (tag);
+
+        SHA512Half h (HashPrefix::leafNode);
+        h.add (data);
+        h.add256 (tag);
+        expect (h.finish () == s.getSHA512Half ());
+
+        expect (Serializer::getPrefixHash (HashPrefix::leafNode, data) ==
+            Serializer::getSHA512Half (s.peekData ().data (),
+                s.getLength () - 32));
+    }
+
+    void testBatch ()
+    {
+        testcase ("batch");
+
+        beast::Random r (7);
+
+        // Equal lengths around the block and padding boundaries, as well as
+        // runs which are broken up by messages of other lengths.
+        std::vector <std::size_t> sizes;
+        for (std::size_t size : {0, 1, 111, 112, 127, 128, 239, 240, 516})
+            sizes.insert (sizes.end (), 9, size);
+        for (int i = 0; i < 40; ++i)
+            sizes.push_back (r.nextInt (600));
+        for (int i = 0; i < 20; ++i)
+            sizes.push_back ((i % 5 == 4) ? 515 : 516);
+
+        std::vector <Blob> data;
+        for (auto size : sizes)
+        {
+            Blob b (size);
+            for (auto& c : b)
+                c = static_cast<unsigned char> (r.nextInt (256));
+            data.push_back (std::move (b));
+        }
+
+        std::vector <const_byte_view> messages;
+        for (auto const& b : data)
+            messages.emplace_back (b.data (), b.data () + b.size ());
+
+        std::vector <uint256> digests (messages.size ());
+        SHA512Half::batch (messages.data (), digests.data (), messages.size ());
+
+        for (std::size_t i = 0; i < data.size (); ++i)
+            expect (digests[i] == Serializer::getSHA512Half (data[i]),
+                "Batch digest mismatch");
+    }
+
+    void run ()
+    {
+        testKnownDigest ();
+        testIncremental ();
+        testBatch ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SHA512Half,ripple_data,ripple);
+
+//------------------------------------------------------------------------------
+
+/** Measures how many SHAMap leaf hashes are computed per second.
+
+    A leaf hash covers a prefix, the item data and the item tag. It is
+    computed by copying the pieces into a Serializer first, as leaves used
+    to be hashed, and by streaming them through SHA512Half.
+
+    Parameters, for example:
+
+        num_leaves=1000000,item_size=120
+*/
+class LeafHash_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    struct Leaf
+    {
+        uint256 tag;
+        Blob data;
+    };
+
+    template <class Hash>
+    void measure (std::string const& name, std::vector <Leaf> const& leaves,
+        uint256& digest, Hash hash)
+    {
+        auto const start = clock_type::now ();
+
+        // Chain the hashes so none of them can be skipped
+        digest.zero ();
+        for (auto const& leaf : leaves)
+            digest ^= hash (leaf);
+
+        double const seconds = std::chrono::duration <double> (
+            clock_type::now () - start).count ();
+
+        std::stringstream ss;
+        ss << std::setprecision (0) << std::fixed;
+        ss << std::left << std::setw (10) << name <<
+            (leaves.size () / seconds) << " leaves/s";
+        log << ss.str ();
+    }
+
+    void run ()
+    {
+        auto params = parseDelimitedKeyValueString (arg (), ',');
+
+        std::size_t numLeaves = 1000000;
+        if (! params["num_leaves"].isEmpty ())
+            numLeaves = params["num_leaves"].getIntValue ();
+
+        std::size_t itemSize = 120;
+        if (! params["item_size"].isEmpty ())
+            itemSize = params["item_size"].getIntValue ();
+
+        testcase ("leaf hash");
+
+        beast::Random r;
+        std::vector <Leaf> leaves (numLeaves);
+        for (auto& leaf : leaves)
+        {
+            for (auto& c : leaf.tag)
+                c = static_cast<unsigned char> (r.nextInt (256));
+            leaf.data.resize (itemSize);
+            for (auto& c : leaf.data)
+                c = static_cast<unsigned char> (r.nextInt (256));
+        }
+
+        uint256 buffered;
+        measure ("buffered", leaves, buffered, [](Leaf const& leaf)
+        {
+            Serializer s (leaf.data.size () + (256 + 32) / 8);
+            s.add32 (HashPrefix::leafNode);
+            s.addRaw (leaf.data);
+            s.add256 (leaf.tag);
+            return s.getSHA512Half ();
+        });
+
+        uint256 streamed;
+        measure ("streamed", leaves, streamed, [](Leaf const& leaf)
+        {
+            SHA512Half h (HashPrefix::leafNode);
+            h.add (leaf.data);
+            h.add256 (leaf.tag);
+            return h.finish ();
+        });
+
+        expect (streamed == buffered, "Hash mismatch");
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(LeafHash,bench,ripple);
+
+//------------------------------------------------------------------------------
+
+/** Measures how many inner nodes are hashed per second.
+
+    Inner nodes are hashed one at a time and with SHA512Half::batch, which
+    hashes several at once when the CPU supports AVX2 or AVX-512.
+
+    Parameters, for example:
+
+        num_nodes=1000000
+*/
+class InnerNodeHash_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    void report (std::string const& name, std::size_t count,
+        clock_type::time_point start)
+    {
+        double const seconds = std::chrono::duration <double> (
+            clock_type::now () - start).count ();
+
+        std::stringstream ss;
+        ss << std::setprecision (0) << std::fixed;
+        ss << std::left << std::setw (10) << name <<
+            (count / seconds) << " nodes/s";
+        log << ss.str ();
+    }
+
+    void run ()
+    {
+        auto params = parseDelimitedKeyValueString (arg (), ',');
+
+        std::size_t numNodes = 1000000;
+        if (! params["num_nodes"].isEmpty ())
+            numNodes = params["num_nodes"].getIntValue ();
+
+        testcase ("inner node hash");
+
+        // A prefix followed by 16 child hashes, as in a full inner node
+        std::size_t const nodeSize = 4 + 16 * 32;
+
+        beast::Random r;
+        Blob data (numNodes * nodeSize);
+        for (auto& c : data)
+            c = static_cast<unsigned char> (r.nextInt (256));
+
+        std::vector <const_byte_view> messages;
+        messages.reserve (numNodes);
+        for (std::size_t i = 0; i < numNodes; ++i)
+        {
+            auto const p = data.data () + i * nodeSize;
+            messages.emplace_back (p, p + nodeSize);
+        }
+
+        std::vector <uint256> single (numNodes);
+        auto start = clock_type::now ();
+        for (std::size_t i = 0; i < numNodes; ++i)
+        {
+            SHA512Half h;
+            h.add (messages[i]);
+            single[i] = h.finish ();
+        }
+        report ("single", numNodes, start);
+
+        // Flushing a map hashes one level of a subtree at a time
+        std::size_t const batchSize = 64;
+
+        std::vector <uint256> batched (numNodes);
+        start = clock_type::now ();
+        for (std::size_t i = 0; i < numNodes; i += batchSize)
+            SHA512Half::batch (&messages[i], &batched[i],
+                std::min (batchSize, numNodes - i));
+        report ("batch", numNodes, start);
+
+        expect (batched == single, "Hash mismatch");
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(InnerNodeHash,bench,ripple);
+
+} // ripple
@@ -0,0 +1,284 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/protocol/SHA512Half.h>
+#include <cstring>
+
+// Several messages of the same length are hashed together, one message
+// per 64-bit vector lane, using the compiler's generic vector extensions.
+// The lane code is compiled for AVX2 (4 lanes) and AVX-512 (8 lanes) and
+// chosen at run time. Other compilers and CPUs hash one message at a time.
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define RIPPLE_SHA512_LANES 1
+#else
+#define RIPPLE_SHA512_LANES 0
+#endif
+
+namespace ripple {
+
+#if RIPPLE_SHA512_LANES
+
+namespace detail {
+
+static std::uint64_t const sha512K[80] =
+{
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL,
+    0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL,
+    0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL,
+    0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+    0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL,
+    0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL,
+    0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL,
+    0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+    0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL,
+    0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL,
+    0x92722c851482353bULL, 0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL,
+    0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL,
+    0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL,
+    0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL,
+    0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL, 0x748f82ee5defb2fcULL,
+    0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL,
+    0xc67178f2e372532bULL, 0xca273eceea26619cULL, 0xd186b8c721c0c207ULL,
+    0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL,
+    0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
+    0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL,
+    0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static std::uint64_t const sha512Init[8] =
+{
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL,
+    0xa54ff53a5f1d36f1ULL, 0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+    0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static inline std::uint64_t loadBigEndian (std::uint8_t const* p)
+{
+    std::uint64_t v = 0;
+    for (int i = 0; i < 8; ++i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static inline void storeBigEndian (std::uint8_t* p, std::uint64_t v)
+{
+    for (int i = 7; i >= 0; --i)
+    {
+        p[i] = static_cast<std::uint8_t> (v);
+        v >>= 8;
+    }
+}
+
+// One 64-bit word from each of the messages hashed together
+template <int Lanes>
+struct LaneVector;
+
+template <>
+struct LaneVector <4>
+{
+    typedef std::uint64_t type __attribute__ ((vector_size (32)));
+};
+
+template <>
+struct LaneVector <8>
+{
+    typedef std::uint64_t type __attribute__ ((vector_size (64)));
+};
+
+#define RIPPLE_ROR(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+// Hashes Lanes messages of `size` bytes each. This is inlined into the
+// per-instruction-set entry points below, which decide the code generated.
+template <int Lanes>
+inline void hashLanes (std::uint8_t const* const* messages, std::size_t size,
+    uint256* digests)
+{
+    typedef typename LaneVector <Lanes>::type V;
+
+    // The padded tail of each message takes one or two blocks
+    std::size_t const fullBlocks = size / 128;
+    std::size_t const rest = size % 128;
+    std::size_t const tailBlocks = (rest + 17 > 128) ? 2 : 1;
+
+    std::uint8_t tails[Lanes][256];
+    for (int i = 0; i < Lanes; ++i)
+    {
+        std::uint8_t* tail = tails[i];
+        std::memset (tail, 0, sizeof (tails[i]));
+        std::memcpy (tail, messages[i] + fullBlocks * 128, rest);
+        tail[rest] = 0x80;
+        // Lengths are below 2^61 bytes, so the top 64 bits stay zero
+        storeBigEndian (tail + tailBlocks * 128 - 8,
+            static_cast<std::uint64_t> (size) * 8);
+    }
+
+    V state[8];
+    for (int j = 0; j < 8; ++j)
+        for (int i = 0; i < Lanes; ++i)
+            state[j][i] = sha512Init[j];
+
+    for (std::size_t block = 0; block < fullBlocks + tailBlocks; ++block)
+    {
+        // Transpose the block of each message into vectors of words
+        std::uint64_t words[16][Lanes];
+        for (int i = 0; i < Lanes; ++i)
+        {
+            std::uint8_t const* p = (block < fullBlocks)
+                ? messages[i] + block * 128
+                : tails[i] + (block - fullBlocks) * 128;
+
+            for (int t = 0; t < 16; ++t)
+                words[t][i] = loadBigEndian (p + t * 8);
+        }
+
+        V w[80];
+        std::memcpy (w, words, sizeof (words));
+
+        for (int t = 16; t < 80; ++t)
+        {
+            V const s0 = RIPPLE_ROR (w[t - 15], 1) ^
+                RIPPLE_ROR (w[t - 15], 8) ^ (w[t - 15] >> 7);
+            V const s1 = RIPPLE_ROR (w[t - 2], 19) ^
+                RIPPLE_ROR (w[t - 2], 61) ^ (w[t - 2] >> 6);
+            w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+        }
+
+        V a = state[0], b = state[1], c = state[2], d = state[3];
+        V e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (int t = 0; t < 80; ++t)
+        {
+            V const s1 = RIPPLE_ROR (e, 14) ^ RIPPLE_ROR (e, 18) ^
+                RIPPLE_ROR (e, 41);
+            V const ch = g ^ (e & (f ^ g));
+            V const t1 = h + s1 + ch + sha512K[t] + w[t];
+            V const s0 = RIPPLE_ROR (a, 28) ^ RIPPLE_ROR (a, 34) ^
+                RIPPLE_ROR (a, 39);
+            V const maj = (a & b) | (c & (a | b));
+            V const t2 = s0 + maj;
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+
+    // The first half of the digest is the first four state words
+    for (int i = 0; i < Lanes; ++i)
+        for (int j = 0; j < 4; ++j)
+            storeBigEndian (digests[i].begin () + j * 8, state[j][i]);
+}
+
+#undef RIPPLE_ROR
+
+__attribute__ ((target ("avx2"), flatten))
+static void hashLanesAVX2 (std::uint8_t const* const* messages,
+    std::size_t size, uint256* digests)
+{
+    hashLanes <4> (messages, size, digests);
+}
+
+__attribute__ ((target ("avx512f"), flatten))
+static void hashLanesAVX512 (std::uint8_t const* const* messages,
+    std::size_t size, uint256* digests)
+{
+    hashLanes <8> (messages, size, digests);
+}
+
+static int laneCount ()
+{
+    static int const lanes = []
+    {
+        __builtin_cpu_init ();
+        if (__builtin_cpu_supports ("avx512f"))
+            return 8;
+        if (__builtin_cpu_supports ("avx2"))
+            return 4;
+        return 1;
+    }();
+    return lanes;
+}
+
+} // detail
+
+#endif
+
+void SHA512Half::batch (const_byte_view const* messages, uint256* digests,
+    std::size_t count)
+{
+    std::size_t i = 0;
+
+#if RIPPLE_SHA512_LANES
+    int const lanes = detail::laneCount ();
+
+    while (lanes > 1 && i + lanes <= count)
+    {
+        std::size_t const size = messages[i].size ();
+
+        std::uint8_t const* group[8];
+        int n = 0;
+        while (n < lanes && messages[i + n].size () == size)
+        {
+            group[n] = messages[i + n].data ();
+            ++n;
+        }
+
+        if (n < lanes)
+        {
+            // Lengths differ, hash the first message on its own
+            SHA512Half h;
+            h.add (messages[i]);
+            digests[i] = h.finish ();
+            ++i;
+            continue;
+        }
+
+        if (lanes == 8)
+            detail::hashLanesAVX512 (group, size, digests + i);
+        else
+            detail::hashLanesAVX2 (group, size, digests + i);
+
+        i += lanes;
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        SHA512Half h;
+        h.add (messages[i]);
+        digests[i] = h.finish ();
+    }
+}
+
+} // ripple
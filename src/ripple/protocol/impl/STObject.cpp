@@ -25,6 +25,7 @@
 #include <ripple/protocol/STArray.h>
 #include <ripple/protocol/STObject.h>
 #include <ripple/protocol/STParsedJSON.h>
+#include <ripple/protocol/SHA512Half.h>
 #include <beast/module/core/text/LexicalCast.h>
 #include <beast/unit_test/suite.h>
 #include <beast/cxx14/memory.h> // <memory>
@@ -455,17 +456,21 @@ bool STObject::isEquivalent (const STBase& t) const
 uint256 STObject::getHash (std::uint32_t prefix) const
 {
     Serializer s;
-    s.add32 (prefix);
     add (s, true);
-    return s.getSHA512Half ();
+
+    SHA512Half h (prefix);
+    h.add (s.peekData ());
+    return h.finish ();
 }
 
 uint256 STObject::getSigningHash (std::uint32_t prefix) const
 {
     Serializer s;
-    s.add32 (prefix);
     add (s, false);
-    return s.getSHA512Half ();
+
+    SHA512Half h (prefix);
+    h.add (s.peekData ());
+    return h.finish ();
 }
 
 int STObject::getFieldIndex (SField::ref field) const
@@ -847,9 +852,12 @@ Json::Value STObject::getJson (int options) const
         if (it.getSType () != STI_NOTPRESENT)
         {
             auto const& n = it.getFName ();
-            auto key = n.hasName () ? std::string(n.getJsonName ()) :
-                    std::to_string (index);
-            ret[key] = it.getJson (options);
+
+            // Field names are static, so they are used as keys in place
+            if (n.hasName ())
+                ret[n.getJsonName ()] = it.getJson (options);
+            else
+                ret[std::to_string (index)] = it.getJson (options);
         }
     }
     return ret;
@@ -916,6 +924,7 @@ public:
         testSerialization();
         testParseJSONArray();
         testParseJSONArrayWithInvalidChildrenObjects();
+        testParseJSONText();
     }
 
     bool parseJSONString (std::string const& json, Json::Value& to)
@@ -985,6 +994,57 @@ public:
         }
     }
 
+    void testParseJSONText ()
+    {
+        testcase ("parse json text");
+
+        // Parsing the text directly must agree with parsing a Json::Value
+        std::string const documents[] = {
+            "{\"Template\":[{\"ModifiedNode\":{\"Sequence\":1}}]}",
+            "{\"TransactionType\":\"Payment\","
+                "\"Account\":\"rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh\","
+                "\"Amount\":{\"currency\":\"USD\",\"value\":\"1.5\","
+                    "\"issuer\":\"rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh\"},"
+                "\"Fee\":\"10\",\"Flags\":2147483648,\"Sequence\":1,"
+                "\"Memos\":[{\"Memo\":{\"MemoData\":\"0A0B\"}}]}",
+            "{\"Template\":[{\"ModifiedNode\":{\"Sequence\":1},"
+                "\"DeletedNode\":{\"Sequence\":1}}]}",
+            "{\"Template\":[{\"Sequence\":1}]}",
+            "{\"Template\":[1]}",
+            "{\"Memos\":{}}",
+            "{\"Memo\":1}",
+            "{\"Sequence\":\"x\"}",
+            "{\"Unknown\":1}",
+        };
+
+        for (auto const& json : documents)
+        {
+            Json::Value jsonObject;
+            unexpected (!parseJSONString (json, jsonObject), json);
+
+            STParsedJSONObject const fromValue ("test", jsonObject);
+            STParsedJSONObject const fromText ("test",
+                json.data (), json.data () + json.size ());
+
+            if (fromValue.object)
+            {
+                expect (fromText.object && to_string (
+                    fromText.object->getJson (0)) == to_string (
+                        fromValue.object->getJson (0)), json);
+            }
+            else
+            {
+                expect (!fromText.object, json);
+                expect (fromText.error == fromValue.error, json);
+            }
+        }
+
+        std::string const duplicate ("{\"Sequence\":1,\"Sequence\":2}");
+        STParsedJSONObject const parsed ("test",
+            duplicate.data (), duplicate.data () + duplicate.size ());
+        expect (!parsed.object && parsed.error.isObject (), duplicate);
+    }
+
     void testSerialization ()
     {
         testcase ("serialization");
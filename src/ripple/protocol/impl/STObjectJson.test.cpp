@@ -0,0 +1,241 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/json/json_reader.h>
+#include <ripple/json/to_string.h>
+#include <ripple/protocol/LedgerFormats.h>
+#include <ripple/protocol/STArray.h>
+#include <ripple/protocol/STParsedJSON.h>
+#include <ripple/protocol/STTx.h>
+#include <beast/module/core/maths/Random.h>
+#include <beast/unit_test/suite.h>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace ripple {
+
+/** Measures converting a ledger's worth of transactions to JSON and back.
+
+    Each transaction is a payment whose metadata modifies two account
+    roots. Every step of an RPC round trip is timed separately: building
+    the Json::Value, writing it as text, reading the text, and parsing the
+    Json::Value back into serialized objects.
+
+    Parameters, for example:
+
+        num_tx=1000,passes=20
+*/
+class STObjectJson_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    struct Item
+    {
+        std::unique_ptr <STTx> tx;
+        STArray nodes;
+        STObject meta;
+
+        Item () : meta (sfTransactionMetaData) {}
+    };
+
+    beast::Random r_;
+
+    template <class T>
+    T random ()
+    {
+        T t;
+        for (auto& c : t)
+            c = static_cast<unsigned char> (r_.nextInt (256));
+        return t;
+    }
+
+    Blob randomBlob (std::size_t size)
+    {
+        Blob b (size);
+        for (auto& c : b)
+            c = static_cast<unsigned char> (r_.nextInt (256));
+        return b;
+    }
+
+    STObject makeNode (Account const& account, std::uint32_t sequence)
+    {
+        STObject node (sfModifiedNode);
+        node.setFieldU16 (sfLedgerEntryType, ltACCOUNT_ROOT);
+        node.setFieldH256 (sfLedgerIndex, random <uint256> ());
+        node.setFieldH256 (sfPreviousTxnID, random <uint256> ());
+        node.setFieldU32 (sfPreviousTxnLgrSeq, r_.nextInt (1000000));
+
+        STObject finalFields (sfFinalFields);
+        finalFields.setFieldAccount (sfAccount, account);
+        finalFields.setFieldAmount (sfBalance, STAmount (r_.nextInt64 () &
+            0xFFFFFFFFFFFF));
+        finalFields.setFieldU32 (sfFlags, 0);
+        finalFields.setFieldU32 (sfOwnerCount, r_.nextInt (10));
+        finalFields.setFieldU32 (sfSequence, sequence);
+        node.addObject (finalFields);
+
+        STObject previousFields (sfPreviousFields);
+        previousFields.setFieldAmount (sfBalance, STAmount (r_.nextInt64 () &
+            0xFFFFFFFFFFFF));
+        node.addObject (previousFields);
+
+        return node;
+    }
+
+    void makeItem (Item& item, std::uint32_t index)
+    {
+        Account const account = random <Account> ();
+        Account const destination = random <Account> ();
+        std::uint32_t const sequence = r_.nextInt (100000);
+
+        item.tx = std::make_unique <STTx> (ttPAYMENT);
+        STTx& tx = *item.tx;
+        tx.setFieldAccount (sfAccount, account);
+        tx.setFieldAccount (sfDestination, destination);
+        tx.setFieldAmount (sfAmount, STAmount (r_.nextInt (1000000) + 1));
+        tx.setFieldAmount (sfFee, STAmount (10));
+        tx.setFieldU32 (sfSequence, sequence);
+        tx.setFieldU32 (sfFlags, 0);
+        tx.setFieldVL (sfSigningPubKey, randomBlob (33));
+        tx.setFieldVL (sfTxnSignature, randomBlob (71));
+
+        item.nodes = STArray (sfAffectedNodes);
+        item.nodes.push_back (makeNode (account, sequence + 1));
+        item.nodes.push_back (makeNode (destination, r_.nextInt (100000)));
+
+        item.meta.setFieldU8 (sfTransactionResult, 0);
+        item.meta.setFieldU32 (sfTransactionIndex, index);
+        item.meta.addObject (item.nodes);
+    }
+
+    template <class Function>
+    double measure (std::size_t passes, Function f)
+    {
+        auto const start = clock_type::now ();
+        for (std::size_t pass = 0; pass < passes; ++pass)
+            f ();
+        return std::chrono::duration <double> (
+            clock_type::now () - start).count () / passes;
+    }
+
+    void report (std::string const& name, double seconds, std::size_t count)
+    {
+        std::stringstream ss;
+        ss << std::setprecision (2) << std::fixed;
+        ss << std::left << std::setw (10) << name << (seconds * 1000) <<
+            " ms per ledger, " << std::setprecision (0) <<
+                (count / seconds) << " tx/s";
+        log << ss.str ();
+    }
+
+    void run ()
+    {
+        auto params = parseDelimitedKeyValueString (arg (), ',');
+
+        std::size_t numTx = 1000;
+        if (! params["num_tx"].isEmpty ())
+            numTx = params["num_tx"].getIntValue ();
+
+        std::size_t passes = 20;
+        if (! params["passes"].isEmpty ())
+            passes = params["passes"].getIntValue ();
+
+        testcase ("json round trip");
+
+        std::vector <Item> items (numTx);
+        for (std::size_t i = 0; i < items.size (); ++i)
+            makeItem (items[i], i);
+
+        // As a ledger is returned by RPC: each transaction with its metadata
+        Json::Value ledger (Json::arrayValue);
+        double const toJson = measure (passes, [&]()
+        {
+            Json::Value txs (Json::arrayValue);
+            for (auto const& item : items)
+            {
+                Json::Value& tx = txs.append (item.tx->getJson (0));
+                tx["metaData"] = item.meta.getJson (0);
+            }
+            ledger.swap (txs);
+        });
+
+        std::string text;
+        double const write = measure (passes, [&]()
+        {
+            text = to_string (ledger);
+        });
+
+        Json::Value parsed;
+        double const read = measure (passes, [&]()
+        {
+            Json::Reader reader;
+            parsed = Json::Value ();
+            reader.parse (text, parsed);
+        });
+
+        // Unsigned fields read back as signed, so compare the text.
+        if (! expect (to_string (parsed) == text, "Reading changed the JSON"))
+            return;
+
+        // Parse back into serialized objects, and check they are unchanged.
+        std::size_t mismatches = 0;
+        double const fromJson = measure (passes, [&]()
+        {
+            mismatches = 0;
+            for (std::size_t i = 0; i < items.size (); ++i)
+            {
+                Json::Value tx = parsed[static_cast <Json::UInt> (i)];
+                Json::Value const meta = tx.removeMember ("metaData");
+                tx.removeMember ("hash");
+
+                STParsedJSONObject const parsedTx ("tx", tx);
+                STParsedJSONArray const parsedNodes (
+                    "AffectedNodes", meta["AffectedNodes"]);
+
+                if (! parsedTx.object || ! parsedNodes.array ||
+                    parsedTx.object->getSerializer ().peekData () !=
+                        items[i].tx->getSerializer ().peekData ())
+                {
+                    ++mismatches;
+                    continue;
+                }
+
+                Serializer original, roundTrip;
+                items[i].nodes.add (original);
+                parsedNodes.array->add (roundTrip);
+                if (original.peekData () != roundTrip.peekData ())
+                    ++mismatches;
+            }
+        });
+
+        expect (mismatches == 0, "Objects changed by a round trip");
+
+        report ("to json", toJson, numTx);
+        report ("write", write, numTx);
+        report ("read", read, numTx);
+        report ("from json", fromJson, numTx);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(STObjectJson,ripple_data,ripple);
+
+} // ripple
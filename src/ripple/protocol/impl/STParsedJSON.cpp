@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/basics/StringUtilities.h>
+#include <ripple/json/json_parser.h>
 #include <ripple/protocol/STInteger.h>
 #include <ripple/rpc/ErrorCodes.h> // VFALCO Questionable dependency
 #include <beast/module/core/text/LexicalCast.h>
@@ -111,6 +112,13 @@ static Json::Value string_expected (std::string const& object,
         "Field '" + make_name (object, field) + "' must be a string.");
 }
 
+static Json::Value duplicate_field (std::string const& object,
+    std::string const& field)
+{
+    return RPC::make_error (rpcINVALID_PARAMS,
+        "Field '" + make_name (object, field) + "' appears twice.");
+}
+
 static Json::Value too_deep (std::string const& object)
 {
     return RPC::make_error (rpcINVALID_PARAMS,
@@ -842,6 +850,418 @@ static bool parseArray (
     return true;
 }
 
+//------------------------------------------------------------------------------
+
+// Builds an STObject from the events of a Json::Parser, applying the same
+// rules as parseObject and parseArray without first building a Json::Value
+// for the document. Only the values of leaf fields are collected into a
+// Json::Value, which is then handed to parseLeaf.
+//
+// Members are visited in document order rather than sorted order, so when a
+// document has several errors the one reported may differ.
+class STObjectBuilder : public Json::ParseHandler
+{
+public:
+    STObjectBuilder (std::string const& name, Json::Value& error)
+        : name_ (name)
+        , error_ (error)
+        , capture_ (0)
+        , builder_ (leaf_)
+    {
+    }
+
+    std::unique_ptr <STObject> object;
+
+    bool onNull () override
+    {
+        if (capture_ != 0)
+            return builder_.onNull ();
+        leaf_ = Json::Value ();
+        return scalar ();
+    }
+
+    bool onBool (bool value) override
+    {
+        if (capture_ != 0)
+            return builder_.onBool (value);
+        leaf_ = value;
+        return scalar ();
+    }
+
+    bool onInt (Json::Value::Int value) override
+    {
+        if (capture_ != 0)
+            return builder_.onInt (value);
+        leaf_ = value;
+        return scalar ();
+    }
+
+    bool onUInt (Json::Value::UInt value) override
+    {
+        if (capture_ != 0)
+            return builder_.onUInt (value);
+        leaf_ = value;
+        return scalar ();
+    }
+
+    bool onDouble (double value) override
+    {
+        if (capture_ != 0)
+            return builder_.onDouble (value);
+        leaf_ = value;
+        return scalar ();
+    }
+
+    bool onString (char const* data, std::size_t size) override
+    {
+        if (capture_ != 0)
+            return builder_.onString (data, size);
+        leaf_ = Json::Value (data, data + size);
+        return scalar ();
+    }
+
+    bool onObjectBegin () override;
+    bool onKey (char const* data, std::size_t size) override;
+    bool onObjectEnd () override;
+    bool onArrayBegin () override;
+    bool onArrayEnd () override;
+
+private:
+    struct Frame
+    {
+        enum Kind
+        {
+            objectFrame,    // The fields of an STObject
+            arrayFrame,     // The elements of an STArray
+            elementFrame    // The single key object wrapping an element
+        };
+
+        Frame (Kind kind_, SField::ref field_, std::string name_, int depth_)
+            : kind (kind_)
+            , field (&field_)
+            , name (std::move (name_))
+            , depth (depth_)
+            , member (nullptr)
+            , index (0)
+        {
+        }
+
+        Kind kind;
+        SField::ptr field;
+        std::string name;
+        int depth;
+
+        // The member being parsed, for objects and elements
+        std::string key;
+        SField::ptr member;
+
+        boost::ptr_vector <STBase> data;
+        std::unique_ptr <STArray> array;
+        std::unique_ptr <STObject> child;
+
+        // The position of this element, or of the next one in the array
+        Json::UInt index;
+
+        std::string elementName () const
+        {
+            return name + ".[" + std::to_string (index) + "]." + key;
+        }
+    };
+
+    bool scalar ();
+    bool push (Frame::Kind kind, SField::ref field, std::string name,
+        int depth);
+    bool finishLeaf ();
+
+    std::string const& name_;
+    Json::Value& error_;
+    std::vector <std::unique_ptr <Frame>> frames_;
+    int capture_;
+    Json::Value leaf_;
+    Json::ValueBuilder builder_;
+};
+
+bool STObjectBuilder::push (Frame::Kind kind, SField::ref field,
+    std::string name, int depth)
+{
+    if (depth > maxDepth)
+    {
+        error_ = too_deep (name);
+        return false;
+    }
+
+    frames_.push_back (std::make_unique <Frame> (
+        kind, field, std::move (name), depth));
+    return true;
+}
+
+bool STObjectBuilder::scalar ()
+{
+    if (frames_.empty ())
+    {
+        error_ = not_an_object (name_);
+        return false;
+    }
+
+    Frame& top = *frames_.back ();
+
+    switch (top.kind)
+    {
+    case Frame::objectFrame:
+        switch (top.member->fieldType)
+        {
+        case STI_OBJECT:
+        case STI_TRANSACTION:
+        case STI_LEDGERENTRY:
+        case STI_VALIDATION:
+            error_ = not_an_object (top.name, top.key);
+            return false;
+
+        case STI_ARRAY:
+            error_ = not_an_array (make_name (top.name, top.key));
+            return false;
+
+        default:
+            return finishLeaf ();
+        }
+
+    case Frame::arrayFrame:
+        error_ = singleton_expected (top.name, top.index);
+        return false;
+
+    case Frame::elementFrame:
+        error_ = not_an_object (top.elementName ());
+        return false;
+    }
+
+    return false;
+}
+
+bool STObjectBuilder::finishLeaf ()
+{
+    Frame& top = *frames_.back ();
+
+    std::unique_ptr <STBase> serTyp =
+        parseLeaf (top.name, top.key, top.field, leaf_, error_);
+
+    if (!serTyp)
+        return false;
+
+    top.data.push_back (serTyp.release ());
+    return true;
+}
+
+bool STObjectBuilder::onObjectBegin ()
+{
+    if (capture_ != 0)
+    {
+        ++capture_;
+        return builder_.onObjectBegin ();
+    }
+
+    if (frames_.empty ())
+        return push (Frame::objectFrame, sfGeneric, name_, 0);
+
+    Frame& top = *frames_.back ();
+
+    switch (top.kind)
+    {
+    case Frame::objectFrame:
+        switch (top.member->fieldType)
+        {
+        case STI_OBJECT:
+        case STI_TRANSACTION:
+        case STI_LEDGERENTRY:
+        case STI_VALIDATION:
+            return push (Frame::objectFrame, *top.member,
+                top.name + "." + top.key, top.depth + 1);
+
+        case STI_ARRAY:
+            error_ = not_an_array (make_name (top.name, top.key));
+            return false;
+
+        default:
+            // Leaf fields such as amounts may themselves be objects
+            capture_ = 1;
+            return builder_.onObjectBegin ();
+        }
+
+    case Frame::arrayFrame:
+        frames_.push_back (std::make_unique <Frame> (
+            Frame::elementFrame, *top.field, top.name, top.depth));
+        frames_.back ()->index = top.index;
+        return true;
+
+    case Frame::elementFrame:
+        return push (Frame::objectFrame, *top.member,
+            top.elementName (), top.depth + 1);
+    }
+
+    return false;
+}
+
+bool STObjectBuilder::onKey (char const* data, std::size_t size)
+{
+    if (capture_ != 0)
+        return builder_.onKey (data, size);
+
+    Frame& top = *frames_.back ();
+
+    if (top.kind == Frame::elementFrame && top.member != nullptr)
+    {
+        error_ = singleton_expected (top.name, top.index);
+        return false;
+    }
+
+    top.key.assign (data, size);
+
+    SField::ref field = SField::getField (top.key);
+
+    if (field == sfInvalid)
+    {
+        error_ = unknown_field (top.name, top.key);
+        return false;
+    }
+
+    if (top.kind == Frame::objectFrame)
+    {
+        for (auto const& item : top.data)
+        {
+            if (item.getFName () == field)
+            {
+                error_ = duplicate_field (top.name, top.key);
+                return false;
+            }
+        }
+    }
+
+    top.member = &field;
+    return true;
+}
+
+bool STObjectBuilder::onObjectEnd ()
+{
+    if (capture_ != 0)
+    {
+        if (! builder_.onObjectEnd ())
+            return false;
+        return (--capture_ != 0) || finishLeaf ();
+    }
+
+    std::unique_ptr <Frame> top = std::move (frames_.back ());
+    frames_.pop_back ();
+
+    if (top->kind == Frame::elementFrame)
+    {
+        if (top->member == nullptr)
+        {
+            error_ = singleton_expected (top->name, top->index);
+            return false;
+        }
+
+        Frame& parent = *frames_.back ();
+        parent.array->push_back (*top->child);
+        ++parent.index;
+        return true;
+    }
+
+    std::unique_ptr <STObject> sub_object =
+        std::make_unique <STObject> (*top->field, top->data);
+
+    if (frames_.empty ())
+    {
+        object = std::move (sub_object);
+        return true;
+    }
+
+    Frame& parent = *frames_.back ();
+
+    if (parent.kind == Frame::elementFrame)
+    {
+        if (sub_object->getFName ().fieldType != STI_OBJECT)
+        {
+            error_ = invalid_data (top->name);
+            return false;
+        }
+
+        parent.child = std::move (sub_object);
+        return true;
+    }
+
+    parent.data.push_back (sub_object.release ());
+    return true;
+}
+
+bool STObjectBuilder::onArrayBegin ()
+{
+    if (capture_ != 0)
+    {
+        ++capture_;
+        return builder_.onArrayBegin ();
+    }
+
+    if (frames_.empty ())
+    {
+        error_ = not_an_object (name_);
+        return false;
+    }
+
+    Frame& top = *frames_.back ();
+
+    switch (top.kind)
+    {
+    case Frame::objectFrame:
+        switch (top.member->fieldType)
+        {
+        case STI_OBJECT:
+        case STI_TRANSACTION:
+        case STI_LEDGERENTRY:
+        case STI_VALIDATION:
+            error_ = not_an_object (top.name, top.key);
+            return false;
+
+        case STI_ARRAY:
+            if (! push (Frame::arrayFrame, *top.member,
+                    top.name + "." + top.key, top.depth + 1))
+                return false;
+            frames_.back ()->array =
+                std::make_unique <STArray> (*top.member);
+            return true;
+
+        default:
+            // Leaf fields such as paths may themselves be arrays
+            capture_ = 1;
+            return builder_.onArrayBegin ();
+        }
+
+    case Frame::arrayFrame:
+        error_ = singleton_expected (top.name, top.index);
+        return false;
+
+    case Frame::elementFrame:
+        error_ = not_an_object (top.elementName ());
+        return false;
+    }
+
+    return false;
+}
+
+bool STObjectBuilder::onArrayEnd ()
+{
+    if (capture_ != 0)
+    {
+        if (! builder_.onArrayEnd ())
+            return false;
+        return (--capture_ != 0) || finishLeaf ();
+    }
+
+    std::unique_ptr <Frame> top = std::move (frames_.back ());
+    frames_.pop_back ();
+
+    frames_.back ()->data.push_back (top->array.release ());
+    return true;
+}
+
 } // STParsedJSONDetail
 
 //------------------------------------------------------------------------------
@@ -854,6 +1274,28 @@ STParsedJSONObject::STParsedJSONObject (
     parseObject (name, json, sfGeneric, 0, object, error);
 }
 
+STParsedJSONObject::STParsedJSONObject (
+    std::string const& name,
+    char const* begin,
+    char const* end)
+{
+    using namespace STParsedJSONDetail;
+
+    try
+    {
+        STObjectBuilder builder (name, error);
+
+        if (Json::Parser ().parse (begin, end, builder))
+            object = std::move (builder.object);
+        else if (error.isNull ())
+            error = invalid_data (name);
+    }
+    catch (...)
+    {
+        error = invalid_data (name);
+    }
+}
+
 //------------------------------------------------------------------------------
 
 STParsedJSONArray::STParsedJSONArray (
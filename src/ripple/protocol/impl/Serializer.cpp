@@ -19,6 +19,7 @@
 
 #include <ripple/basics/Log.h>
 #include <ripple/protocol/Serializer.h>
+#include <ripple/protocol/SHA512Half.h>
 #include <beast/unit_test/suite.h>
 #include <openssl/ripemd.h>
 #include <openssl/pem.h>
@@ -345,35 +346,23 @@ uint256 Serializer::getSHA512Half (int size) const
 
 uint256 Serializer::getSHA512Half (const_byte_view v)
 {
-    uint256 j[2];
-    SHA512 (v.data(), v.size(),
-        reinterpret_cast<unsigned char*> (j));
-    return j[0];
+    SHA512Half h;
+    h.add (v);
+    return h.finish ();
 }
 
 uint256 Serializer::getSHA512Half (const unsigned char* data, int len)
 {
-    uint256 j[2];
-    SHA512 (data, len, (unsigned char*) j);
-    return j[0];
+    SHA512Half h;
+    h.add (data, len);
+    return h.finish ();
 }
 
 uint256 Serializer::getPrefixHash (std::uint32_t prefix, const unsigned char* data, int len)
 {
-    char be_prefix[4];
-    be_prefix[0] = static_cast<unsigned char> (prefix >> 24);
-    be_prefix[1] = static_cast<unsigned char> ((prefix >> 16) & 0xff);
-    be_prefix[2] = static_cast<unsigned char> ((prefix >> 8) & 0xff);
-    be_prefix[3] = static_cast<unsigned char> (prefix & 0xff);
-
-    uint256 j[2];
-    SHA512_CTX ctx;
-    SHA512_Init (&ctx);
-    SHA512_Update (&ctx, &be_prefix[0], 4);
-    SHA512_Update (&ctx, data, len);
-    SHA512_Final (reinterpret_cast<unsigned char*> (&j[0]), &ctx);
-
-    return j[0];
+    SHA512Half h (prefix);
+    h.add (data, len);
+    return h.finish ();
 }
 
 int Serializer::addVL (Blob const& vector)
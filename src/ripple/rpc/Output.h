@@ -20,6 +20,9 @@
 #ifndef RIPPLED_RIPPLE_BASICS_TYPES_OUTPUT_H
 #define RIPPLED_RIPPLE_BASICS_TYPES_OUTPUT_H
 
+#include <cstddef>
+#include <string>
+
 namespace ripple {
 
 class Output
@@ -29,6 +32,21 @@ public:
     virtual ~Output() = default;
 };
 
+/** An Output that appends to a string. */
+class StringOutput : public Output
+{
+public:
+    explicit StringOutput (std::string& s) : s_ (s) {}
+
+    void output (char const* data, size_t length) override
+    {
+        s_.append (data, length);
+    }
+
+private:
+    std::string& s_;
+};
+
 } // ripple
 
 #endif
@@ -28,6 +28,13 @@ namespace ripple {
 
 class NetworkOPs;
 
+namespace RPC {
+struct Handler;
+namespace New {
+class Object;
+}
+}
+
 class RPCHandler
 {
 public:
@@ -45,7 +52,44 @@ public:
         Role role,
         Resource::Charge& loadType);
 
+    /** Execute a command, writing the result into an object.
+
+        Commands which support it write their result directly, without
+        building it as a Json::Value first. Returns true if the result was
+        written. Otherwise returns false, and `result` holds the value
+        doCommand would have returned; anything written to the object
+        must be discarded.
+    */
+    bool writeCommand (
+        Json::Value const& request,
+        Role role,
+        Resource::Charge& loadType,
+        RPC::New::Object& object,
+        Json::Value& result);
+
+    /** Like writeCommand, for a JSON-RPC method and params.
+        The "status" field is written along with the result.
+    */
+    bool writeRpcCommand (
+        std::string const& command,
+        Json::Value const& params,
+        Role role,
+        Resource::Charge& loadType,
+        RPC::New::Object& object,
+        Json::Value& result);
+
 private:
+    // Returns an error if the command can't be run now, otherwise null.
+    Json::Value checkCommand (
+        Json::Value const& request,
+        Role role,
+        RPC::Handler const*& handler);
+
+    Json::Value runCommand (
+        RPC::Handler const& handler,
+        Json::Value const& request,
+        Resource::Charge& loadType);
+
     NetworkOPs& netOps_;
     InfoSub::pointer infoSub_;
 
@@ -89,6 +89,10 @@ Json::Value doWalletSeed            (RPC::Context&);
 Json::Value doWalletUnlock          (RPC::Context&);
 Json::Value doWalletVerify          (RPC::Context&);
 
+// These write their result as it is computed, see Handler::WriteMethod.
+Json::Value writeLedger             (RPC::Context&, RPC::New::Object&);
+Json::Value writeLedgerData         (RPC::Context&, RPC::New::Object&);
+
 } // ripple
 
 #endif
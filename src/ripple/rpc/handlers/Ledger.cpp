@@ -18,34 +18,40 @@
 //==============================================================================
 
 #include <ripple/core/LoadFeeTrack.h>
+#include <ripple/rpc/impl/JsonObject.h>
 #include <ripple/server/Role.h>
 
 namespace ripple {
 
-// ledger [id|index|current|closed] [full]
-// {
-//    ledger: 'current' | 'closed' | <uint256> | <number>,  // optional
-//    full: true | false    // optional, defaults to false.
-// }
-Json::Value doLedger (RPC::Context& context)
+namespace {
+
+// The open and closed ledgers, when no ledger is requested.
+Json::Value getLedgerSummary ()
 {
-    if (!context.params.isMember ("ledger")
-        && !context.params.isMember ("ledger_hash")
-        && !context.params.isMember ("ledger_index"))
-    {
-        Json::Value ret (Json::objectValue), current (Json::objectValue),
-                closed (Json::objectValue);
+    Json::Value ret (Json::objectValue), current (Json::objectValue),
+            closed (Json::objectValue);
 
-        getApp().getLedgerMaster ().getCurrentLedger ()->addJson (current, 0);
-        getApp().getLedgerMaster ().getClosedLedger ()->addJson (closed, 0);
+    getApp().getLedgerMaster ().getCurrentLedger ()->addJson (current, 0);
+    getApp().getLedgerMaster ().getClosedLedger ()->addJson (closed, 0);
 
-        ret["open"] = current;
-        ret["closed"] = closed;
+    ret["open"] = current;
+    ret["closed"] = closed;
 
-        return ret;
-    }
+    return ret;
+}
+
+bool isLedgerRequested (Json::Value const& params)
+{
+    return params.isMember ("ledger")
+        || params.isMember ("ledger_hash")
+        || params.isMember ("ledger_index");
+}
 
-    Ledger::pointer     lpLedger;
+// Looks up the requested ledger and the options to show it with.
+// Returns an error and leaves ledger null on failure.
+Json::Value lookupLedgerOptions (
+    RPC::Context& context, Ledger::pointer& lpLedger, int& iOptions)
+{
     Json::Value jvResult = RPC::lookupLedger (
         context.params, lpLedger, context.netOps);
 
@@ -60,7 +66,7 @@ Json::Value doLedger (RPC::Context& context)
             && context.params["accounts"].asBool ();
     bool bExpand = context.params.isMember ("expand")
             && context.params["expand"].asBool ();
-    int     iOptions        = (bFull ? LEDGER_JSON_FULL : 0)
+    iOptions                = (bFull ? LEDGER_JSON_FULL : 0)
                               | (bExpand ? LEDGER_JSON_EXPAND : 0)
                               | (bTransactions ? LEDGER_JSON_DUMP_TXRP : 0)
                               | (bAccounts ? LEDGER_JSON_DUMP_STATE : 0);
@@ -72,6 +78,7 @@ Json::Value doLedger (RPC::Context& context)
         {
             // Until some sane way to get full ledgers has been implemented,
             // disallow retrieving all state nodes.
+            lpLedger.reset ();
             return rpcError (rpcNO_PERMISSION);
         }
 
@@ -79,15 +86,96 @@ Json::Value doLedger (RPC::Context& context)
             context.role != Role::ADMIN)
         {
             WriteLog (lsDEBUG, Peer) << "Too busy to give full ledger";
+            lpLedger.reset ();
             return rpcError(rpcTOO_BUSY);
         }
         context.loadType = Resource::feeHighBurdenRPC;
     }
 
+    return jvResult;
+}
+
+// Writes one of the arrays of Ledger::getJson, an element at a time.
+void writeLedgerArray (
+    RPC::New::Object& object,
+    std::string const& key,
+    Ledger const& ledger,
+    int options,
+    bool (Ledger::*visit) (int,
+        std::function<void (Json::Value const&)> const&) const)
+{
+    std::unique_ptr <RPC::New::Array> array;
+
+    bool const included = (ledger.*visit) (options,
+        [&](Json::Value const& element)
+        {
+            if (!array)
+                array.reset (new RPC::New::Array (object.makeArray (key)));
+            array->append (element);
+        });
+
+    if (included && !array)
+        object.set (key, Json::Value (Json::arrayValue));
+}
+
+} // namespace
+
+// ledger [id|index|current|closed] [full]
+// {
+//    ledger: 'current' | 'closed' | <uint256> | <number>,  // optional
+//    full: true | false    // optional, defaults to false.
+// }
+Json::Value doLedger (RPC::Context& context)
+{
+    if (!isLedgerRequested (context.params))
+        return getLedgerSummary ();
+
+    Ledger::pointer lpLedger;
+    int iOptions = 0;
+    Json::Value jvResult = lookupLedgerOptions (context, lpLedger, iOptions);
+
+    if (!lpLedger)
+        return jvResult;
 
     lpLedger->addJson (jvResult, iOptions);
 
     return jvResult;
 }
 
+// Same as doLedger, but a ledger dump is written out a transaction or state
+// entry at a time rather than collected into one large Json::Value.
+Json::Value writeLedger (RPC::Context& context, RPC::New::Object& result)
+{
+    if (!isLedgerRequested (context.params))
+        return getLedgerSummary ();
+
+    Ledger::pointer lpLedger;
+    int iOptions = 0;
+    Json::Value jvResult = lookupLedgerOptions (context, lpLedger, iOptions);
+
+    if (!lpLedger)
+        return jvResult;
+
+    int const dumps = LEDGER_JSON_FULL
+        | LEDGER_JSON_DUMP_TXRP | LEDGER_JSON_DUMP_STATE;
+
+    if (!(iOptions & dumps))
+    {
+        // Only the header was asked for.
+        lpLedger->addJson (jvResult, iOptions);
+        return jvResult;
+    }
+
+    RPC::New::copyFrom (result, jvResult);
+
+    auto ledger = result.makeObject ("ledger");
+    RPC::New::copyFrom (ledger, lpLedger->getHeaderJson (iOptions));
+    writeLedgerArray (ledger, "transactions", *lpLedger, iOptions,
+        &Ledger::visitTransactionsJson);
+    writeLedgerArray (ledger, "accountState", *lpLedger, iOptions,
+        &Ledger::visitStateJson);
+
+    return Json::Value ();
+}
+
 } // ripple
@@ -17,102 +17,176 @@
 */
 //==============================================================================
 
+#include <ripple/rpc/impl/JsonObject.h>
 #include <ripple/server/Role.h>
 
 namespace ripple {
 
-// Get state nodes from a ledger
-//   Inputs:
-//     limit:        integer, maximum number of entries
-//     marker:       opaque, resume point
-//     binary:       boolean, format
-//   Outputs:
-//     ledger_hash:  chosen ledger's hash
-//     ledger_index: chosen ledger's index
-//     state:        array of state nodes
-//     marker:       resume point, if any
-Json::Value doLedgerData (RPC::Context& context)
+namespace {
+
+struct LedgerDataRequest
+{
+    Ledger::pointer ledger;
+    uint256 resumePoint;
+    bool isBinary = false;
+    int limit = -1;
+};
+
+// Parses the request. Returns false if it is invalid, with the error in
+// jvResult. Otherwise jvResult holds the fields describing the ledger.
+bool parseLedgerData (
+    RPC::Context& context, LedgerDataRequest& request, Json::Value& jvResult)
 {
     int const BINARY_PAGE_LENGTH = 2048;
     int const JSON_PAGE_LENGTH = 256;
 
-    Ledger::pointer lpLedger;
-
-    Json::Value jvResult = RPC::lookupLedger (
-        context.params, lpLedger, context.netOps);
-    if (!lpLedger)
-        return jvResult;
+    jvResult = RPC::lookupLedger (
+        context.params, request.ledger, context.netOps);
+    if (!request.ledger)
+        return false;
 
-    uint256 resumePoint;
     if (context.params.isMember ("marker"))
     {
         Json::Value const& jMarker = context.params["marker"];
-        if (!jMarker.isString ())
-            return RPC::expected_field_error ("marker", "valid");
-        if (!resumePoint.SetHex (jMarker.asString ()))
-            return RPC::expected_field_error ("marker", "valid");
+        if (!jMarker.isString () ||
+            !request.resumePoint.SetHex (jMarker.asString ()))
+        {
+            jvResult = RPC::expected_field_error ("marker", "valid");
+            return false;
+        }
     }
 
-    bool isBinary = false;
     if (context.params.isMember ("binary"))
     {
         Json::Value const& jBinary = context.params["binary"];
         if (!jBinary.isBool ())
-            return RPC::expected_field_error ("binary", "bool");
-        isBinary = jBinary.asBool ();
+        {
+            jvResult = RPC::expected_field_error ("binary", "bool");
+            return false;
+        }
+        request.isBinary = jBinary.asBool ();
     }
 
-    int limit = -1;
-    int maxLimit = isBinary ? BINARY_PAGE_LENGTH : JSON_PAGE_LENGTH;
+    int maxLimit = request.isBinary ? BINARY_PAGE_LENGTH : JSON_PAGE_LENGTH;
 
     if (context.params.isMember ("limit"))
     {
         Json::Value const& jLimit = context.params["limit"];
         if (!jLimit.isIntegral ())
-            return RPC::expected_field_error ("limit", "integer");
+        {
+            jvResult = RPC::expected_field_error ("limit", "integer");
+            return false;
+        }
 
-        limit = jLimit.asInt ();
+        request.limit = jLimit.asInt ();
     }
 
-    if ((limit < 0) || ((limit > maxLimit) && (context.role != Role::ADMIN)))
-        limit = maxLimit;
+    if ((request.limit < 0) ||
+        ((request.limit > maxLimit) && (context.role != Role::ADMIN)))
+    {
+        request.limit = maxLimit;
+    }
 
-    jvResult["ledger_hash"] = to_string (lpLedger->getHash());
-    jvResult["ledger_index"] = std::to_string( lpLedger->getLedgerSeq ());
+    jvResult["ledger_hash"] = to_string (request.ledger->getHash());
+    jvResult["ledger_index"] = std::to_string(
+        request.ledger->getLedgerSeq ());
+    return true;
+}
 
-    Json::Value& nodes = (jvResult["state"] = Json::arrayValue);
-    SHAMap& map = *(lpLedger->peekAccountStateMap ());
+// Calls add with each state node in the requested page. Returns true and
+// sets marker if the page ends before the map does.
+template <class Add>
+bool visitLedgerData (LedgerDataRequest& request, uint256& marker, Add add)
+{
+    SHAMap& map = *(request.ledger->peekAccountStateMap ());
+    uint256 resumePoint = request.resumePoint;
+    int limit = request.limit;
 
     for (;;)
     {
        SHAMapItem::pointer item = map.peekNextItem (resumePoint);
        if (!item)
-           break;
+           return false;
        resumePoint = item->getTag();
 
        if (limit-- <= 0)
        {
-           --resumePoint;
-           jvResult["marker"] = to_string (resumePoint);
-           break;
+           marker = --resumePoint;
+           return true;
        }
 
-       if (isBinary)
+       if (request.isBinary)
        {
-           Json::Value& entry = nodes.append (Json::objectValue);
+           Json::Value entry (Json::objectValue);
            entry["data"] = strHex (
                item->peekData().begin(), item->peekData().size());
            entry["index"] = to_string (item->getTag ());
+           add (entry);
        }
        else
        {
            SLE sle (item->peekSerializer(), item->getTag ());
-           Json::Value& entry = nodes.append (sle.getJson (0));
+           Json::Value entry = sle.getJson (0);
            entry["index"] = to_string (item->getTag ());
+           add (entry);
        }
     }
+}
+
+} // namespace
+
+// Get state nodes from a ledger
+//   Inputs:
+//     limit:        integer, maximum number of entries
+//     marker:       opaque, resume point
+//     binary:       boolean, format
+//   Outputs:
+//     ledger_hash:  chosen ledger's hash
+//     ledger_index: chosen ledger's index
+//     state:        array of state nodes
+//     marker:       resume point, if any
+Json::Value doLedgerData (RPC::Context& context)
+{
+    LedgerDataRequest request;
+    Json::Value jvResult;
+    if (!parseLedgerData (context, request, jvResult))
+        return jvResult;
+
+    Json::Value& nodes = (jvResult["state"] = Json::arrayValue);
+
+    uint256 marker;
+    if (visitLedgerData (request, marker,
+        [&nodes](Json::Value const& entry) { nodes.append (entry); }))
+    {
+        jvResult["marker"] = to_string (marker);
+    }
 
     return jvResult;
 }
 
+// Same as doLedgerData, but each state node is written out as it is read
+// rather than collected into one large Json::Value.
+Json::Value writeLedgerData (RPC::Context& context, RPC::New::Object& result)
+{
+    LedgerDataRequest request;
+    Json::Value jvResult;
+    if (!parseLedgerData (context, request, jvResult))
+        return jvResult;
+
+    RPC::New::copyFrom (result, jvResult);
+
+    uint256 marker;
+    bool more;
+    {
+        auto nodes = result.makeArray ("state");
+        more = visitLedgerData (request, marker,
+            [&nodes](Json::Value const& entry) { nodes.append (entry); });
+    }
+
+    if (more)
+        result["marker"] = to_string (marker);
+
+    return Json::Value ();
+}
+
 } // ripple
@@ -56,12 +56,12 @@ HandlerTable HANDLERS({
     {   "internal",             &doInternal,            Role::ADMIN,   NO_CONDITION     },
     {   "feature",              &doFeature,             Role::ADMIN,   NO_CONDITION     },
     {   "fetch_info",           &doFetchInfo,           Role::ADMIN,   NO_CONDITION     },
-    {   "ledger",               &doLedger,              Role::USER,  NEEDS_NETWORK_CONNECTION  },
+    {   "ledger",               &doLedger,              Role::USER,  NEEDS_NETWORK_CONNECTION, &writeLedger  },
     {   "ledger_accept",        &doLedgerAccept,        Role::ADMIN,   NEEDS_CURRENT_LEDGER  },
     {   "ledger_cleaner",       &doLedgerCleaner,       Role::ADMIN,   NEEDS_NETWORK_CONNECTION  },
     {   "ledger_closed",        &doLedgerClosed,        Role::USER,  NEEDS_CLOSED_LEDGER   },
     {   "ledger_current",       &doLedgerCurrent,       Role::USER,  NEEDS_CURRENT_LEDGER  },
-    {   "ledger_data",          &doLedgerData,          Role::USER,  NEEDS_CURRENT_LEDGER  },
+    {   "ledger_data",          &doLedgerData,          Role::USER,  NEEDS_CURRENT_LEDGER, &writeLedgerData  },
     {   "ledger_entry",         &doLedgerEntry,         Role::USER,  NEEDS_CURRENT_LEDGER  },
     {   "ledger_header",        &doLedgerHeader,        Role::USER,  NEEDS_CURRENT_LEDGER  },
     {   "ledger_request",       &doLedgerRequest,       Role::ADMIN,   NO_CONDITION     },
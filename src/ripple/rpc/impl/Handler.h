@@ -26,6 +26,10 @@
 namespace ripple {
 namespace RPC {
 
+namespace New {
+class Object;
+}
+
 // Under what condition can we call this RPC?
 enum Condition {
     NO_CONDITION     = 0,
@@ -38,10 +42,18 @@ struct Handler
 {
     typedef Json::Value (*Method) (Context&);
 
+    /** Writes the result to an object as it is computed, instead of
+        building it. Returns a null value if the result was written.
+        Otherwise returns the result to use instead, such as an error, and
+        anything written to the object is discarded.
+    */
+    typedef Json::Value (*WriteMethod) (Context&, New::Object&);
+
     const char* name_;
     Method method_;
     Role role_;
     RPC::Condition condition_;
+    WriteMethod writeMethod_;
 };
 
 const Handler* getHandler(std::string name);
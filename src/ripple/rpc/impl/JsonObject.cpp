@@ -80,6 +80,14 @@ Array& Array::append (Scalar value)
     return *this;
 }
 
+Array& Array::append (Json::Value const& value)
+{
+    checkWritable ("append");
+    if (writer_)
+        writer_->append (value);
+    return *this;
+}
+
 //------------------------------------------------------------------------------
 
 Object::Root::Root (Writer& w) : Object (nullptr, &w)
@@ -98,6 +106,14 @@ Object& Object::set (std::string const& key, Scalar value)
     return *this;
 }
 
+Object& Object::set (std::string const& key, Json::Value const& value)
+{
+    checkWritable ("set");
+    if (writer_)
+        writer_->set (key, value);
+    return *this;
+}
+
 Object Object::makeObject (std::string const& key)
 {
     checkWritable ("Object::makeObject");
@@ -142,6 +158,16 @@ Object::Proxy Object::operator[] (std::string const& key)
     return {*this, key};
 }
 
+//------------------------------------------------------------------------------
+
+void copyFrom (Object& object, Json::Value const& value)
+{
+    assert (value.isObject ());
+
+    for (auto i = value.begin (); i != value.end (); ++i)
+        object.set (i.memberName (), *i);
+}
+
 } // New
 } // RPC
 } // ripple
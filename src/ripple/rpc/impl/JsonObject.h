@@ -20,6 +20,8 @@
 #ifndef RIPPLED_RIPPLE_RPC_IMPL_JSONCOLLECTIONS_H
 #define RIPPLED_RIPPLE_RPC_IMPL_JSONCOLLECTIONS_H
 
+#include <ripple/json/json_value.h>
+
 namespace ripple {
 namespace RPC {
 namespace New {
@@ -195,6 +197,9 @@ public:
     template <typename Scalar>
     Object& set (std::string const& key, Scalar);
 
+    /** Set a Json::Value of any type in the Object for a key. */
+    Object& set (std::string const& key, Json::Value const&);
+
     // Detail class and method used to implement operator[].
     class Proxy;
     Proxy operator[] (std::string const& key);
@@ -241,6 +246,9 @@ public:
     template <typename Scalar>
     Array& append (Scalar);
 
+    /** Append a Json::Value of any type to the Array. */
+    Array& append (Json::Value const&);
+
     /** Append a new Object and return it.
 
         This Array is disabled until that sub-object is destroyed.
@@ -280,6 +288,11 @@ public:
     }
 };
 
+//------------------------------------------------------------------------------
+
+/** Set each member of a Json::Value object in an Object. */
+void copyFrom (Object&, Json::Value const&);
+
 } // New
 } // RPC
 } // ripple
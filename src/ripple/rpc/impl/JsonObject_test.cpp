@@ -145,6 +145,32 @@ public:
             "\"obj2\":{\"h\":\"w\",\"f\":false}}");
     }
 
+    void testJsonValue ()
+    {
+        setup ("Json::Value");
+
+        {
+            Json::Value header (Json::objectValue);
+            header["ledger_index"] = 3;
+
+            Json::Value entry (Json::objectValue);
+            entry["index"] = "A1";
+            entry["flags"] = 0;
+
+            Object::Root root (*writer_);
+            copyFrom (root, header);
+            root.makeArray ("state")
+                    .append (entry)
+                    .append (Json::Value ("B2"));
+            root.set ("empty", Json::Value (Json::arrayValue));
+        }
+
+        expectResult (
+            "{\"ledger_index\":3,"
+            "\"state\":[{\"flags\":0,\"index\":\"A1\"},\"B2\"],"
+            "\"empty\":[]}");
+    }
+
     template <typename Functor>
     void expectException (Functor f)
     {
@@ -230,6 +256,8 @@ public:
         testSubs ();
         testSubsShort ();
 
+        testJsonValue ();
+
         testFailureObject ();
         testFailureArray ();
         testKeyFailure ();
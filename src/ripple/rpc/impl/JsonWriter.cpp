@@ -252,6 +252,15 @@ void Writer::output (Type t)
     impl_->output (s.data(), s.size());
 }
 
+void Writer::output (Json::Value const& value)
+{
+    impl_->markStarted ();
+    Json::streamValue (value, [this](void const* data, std::size_t size)
+    {
+        impl_->output (static_cast <char const*> (data), size);
+    });
+}
+
 void Writer::finishAll ()
 {
     impl_->finishAll ();
@@ -274,6 +283,21 @@ void Writer::set (std::string const& tag, Type t)
     output (t);
 }
 
+void Writer::append (Json::Value const& value)
+{
+    impl_->nextCollectionEntry (array, "append");
+    output (value);
+}
+
+void Writer::set (std::string const& tag, Json::Value const& value)
+{
+    check (!tag.empty(), "Tag can't be empty");
+
+    impl_->nextCollectionEntry (object, "set");
+    impl_->writeObjectTag (tag);
+    output (value);
+}
+
 void Writer::startRoot (CollectionType type)
 {
     check (impl_->empty(), "stack_ not empty() in start");
@@ -21,6 +21,7 @@
 #define RIPPLED_RIPPLE_BASICS_TYPES_JSONWRITER_H
 
 #include <ripple/basics/ToString.h>
+#include <ripple/json/json_value.h>
 #include <ripple/rpc/Output.h>
 
 namespace ripple {
@@ -171,6 +172,16 @@ public:
     template <typename Scalar>
     void set (std::string const& key, Scalar value);
 
+    /** Append a Json::Value of any type to an array.
+
+        This is how results which are already built as a Json::Value, such
+        as one ledger entry, are written into a larger streamed result.
+     */
+    void append (Json::Value const&);
+
+    /** Add a key, Json::Value assignment to an object. */
+    void set (std::string const& key, Json::Value const&);
+
     // You won't need to call anything below here until you are writing single
     // items (numbers, strings, bools, null) to a JSON stream.
 
@@ -184,6 +195,9 @@ public:
     template <typename Scalar>
     void output (Scalar t);
 
+    /** Output a Json::Value in compact form. */
+    void output (Json::Value const&);
+
 private:
     class Impl;
     std::unique_ptr <Impl> impl_;
@@ -25,6 +25,7 @@
 #include <ripple/rpc/impl/Tuning.h>
 #include <ripple/rpc/impl/Context.h>
 #include <ripple/rpc/impl/Handler.h>
+#include <ripple/rpc/impl/JsonObject.h>
 
 namespace ripple {
 
@@ -34,16 +35,13 @@ RPCHandler::RPCHandler (NetworkOPs& netOps, InfoSub::pointer infoSub)
 {
 }
 
-// Provide the JSON-RPC "result" value.
-//
-// JSON-RPC provides a method and an array of params. JSON-RPC is used as a
-// transport for a command and a request object. The command is the method. The
-// request object is supplied as the first element of the params.
-Json::Value RPCHandler::doRpcCommand (
-    const std::string& strMethod,
+// Extract the request object from JSON-RPC params.
+// Returns an error, or a null value if the request is valid.
+static
+Json::Value getRpcRequest (
+    std::string const& strMethod,
     Json::Value const& jvParams,
-    Role role,
-    Resource::Charge& loadType)
+    Json::Value& params)
 {
     WriteLog (lsTRACE, RPCHandler)
         << "doRpcCommand:" << strMethod << ":" << jvParams;
@@ -51,7 +49,7 @@ Json::Value RPCHandler::doRpcCommand (
     if (!jvParams.isArray () || jvParams.size () > 1)
         return logRPCError (rpcError (rpcINVALID_PARAMS));
 
-    Json::Value params = jvParams.size () ? jvParams[0u]
+    params = jvParams.size () ? jvParams[0u]
         : Json::Value (Json::objectValue);
 
     if (!params.isObject ())
@@ -59,10 +57,14 @@ Json::Value RPCHandler::doRpcCommand (
 
     // Provide the JSON-RPC method as the field "command" in the request.
     params[jss::command] = strMethod;
+    return Json::Value ();
+}
 
-    Json::Value jvResult = doCommand (params, role, loadType);
-
-    // Always report "status".  On an error report the request as received.
+// Always report "status".  On an error report the request as received.
+static
+Json::Value const& addRpcStatus (
+    Json::Value& jvResult, Json::Value const& params)
+{
     if (jvResult.isMember ("error"))
     {
         jvResult[jss::status] = jss::error;
@@ -76,10 +78,53 @@ Json::Value RPCHandler::doRpcCommand (
     return logRPCError (jvResult);
 }
 
-Json::Value RPCHandler::doCommand (
-    const Json::Value& params,
+// Provide the JSON-RPC "result" value.
+//
+// JSON-RPC provides a method and an array of params. JSON-RPC is used as a
+// transport for a command and a request object. The command is the method. The
+// request object is supplied as the first element of the params.
+Json::Value RPCHandler::doRpcCommand (
+    const std::string& strMethod,
+    Json::Value const& jvParams,
     Role role,
     Resource::Charge& loadType)
+{
+    Json::Value params;
+    Json::Value jvResult = getRpcRequest (strMethod, jvParams, params);
+    if (!jvResult.isNull ())
+        return jvResult;
+
+    jvResult = doCommand (params, role, loadType);
+    return addRpcStatus (jvResult, params);
+}
+
+bool RPCHandler::writeRpcCommand (
+    std::string const& strMethod,
+    Json::Value const& jvParams,
+    Role role,
+    Resource::Charge& loadType,
+    RPC::New::Object& object,
+    Json::Value& jvResult)
+{
+    Json::Value params;
+    jvResult = getRpcRequest (strMethod, jvParams, params);
+    if (!jvResult.isNull ())
+        return false;
+
+    if (writeCommand (params, role, loadType, object, jvResult))
+    {
+        object.set ("status", Json::Value ("success"));
+        return true;
+    }
+
+    addRpcStatus (jvResult, params);
+    return false;
+}
+
+Json::Value RPCHandler::checkCommand (
+    const Json::Value& params,
+    Role role,
+    RPC::Handler const*& handler)
 {
     if (role != Role::ADMIN)
     {
@@ -103,7 +148,7 @@ Json::Value RPCHandler::doCommand (
 
     role_ = role;
 
-    auto handler = RPC::getHandler(strCommand);
+    handler = RPC::getHandler(strCommand);
 
     if (!handler)
         return rpcError (rpcUNKNOWN_COMMAND);
@@ -135,12 +180,20 @@ Json::Value RPCHandler::doCommand (
         return rpcError (rpcNO_CLOSED);
     }
 
+    return Json::Value ();
+}
+
+Json::Value RPCHandler::runCommand (
+    RPC::Handler const& handler,
+    const Json::Value& params,
+    Resource::Charge& loadType)
+{
     try
     {
         LoadEvent::autoptr ev = getApp().getJobQueue().getLoadEventAP(
-            jtGENERIC, "cmd:" + strCommand);
+            jtGENERIC, std::string ("cmd:") + handler.name_);
         RPC::Context context {params, loadType, netOps_, infoSub_, role_};
-        auto result = handler->method_(context);
+        auto result = handler.method_(context);
         assert (result.isObject());
         return result;
     }
@@ -155,4 +208,55 @@ Json::Value RPCHandler::doCommand (
     }
 }
 
+Json::Value RPCHandler::doCommand (
+    const Json::Value& params,
+    Role role,
+    Resource::Charge& loadType)
+{
+    RPC::Handler const* handler = nullptr;
+    Json::Value result = checkCommand (params, role, handler);
+    if (!result.isNull ())
+        return result;
+
+    return runCommand (*handler, params, loadType);
+}
+
+bool RPCHandler::writeCommand (
+    const Json::Value& params,
+    Role role,
+    Resource::Charge& loadType,
+    RPC::New::Object& object,
+    Json::Value& result)
+{
+    RPC::Handler const* handler = nullptr;
+    result = checkCommand (params, role, handler);
+    if (!result.isNull ())
+        return false;
+
+    if (!handler->writeMethod_)
+    {
+        result = runCommand (*handler, params, loadType);
+        return false;
+    }
+
+    try
+    {
+        LoadEvent::autoptr ev = getApp().getJobQueue().getLoadEventAP(
+            jtGENERIC, std::string ("cmd:") + handler->name_);
+        RPC::Context context {params, loadType, netOps_, infoSub_, role_};
+        result = handler->writeMethod_(context, object);
+    }
+    catch (std::exception& e)
+    {
+        WriteLog (lsINFO, RPCHandler) << "Caught throw: " << e.what ();
+
+        if (loadType == Resource::feeReferenceRPC)
+            loadType = Resource::feeExceptionRPC;
+
+        result = rpcError (rpcINTERNAL);
+    }
+
+    return result.isNull ();
+}
+
 } // ripple
@@ -24,10 +24,13 @@
 #include <ripple/basics/Log.h>
 #include <ripple/basics/make_SSLContext.h>
 #include <ripple/core/JobQueue.h>
+#include <ripple/json/json_parser.h>
 #include <ripple/server/make_Server.h>
 #include <ripple/overlay/Overlay.h>
 #include <ripple/resource/Manager.h>
 #include <ripple/resource/Fees.h>
+#include <ripple/rpc/impl/JsonObject.h>
+#include <ripple/rpc/impl/JsonWriter.h>
 #include <beast/crypto/base64.h>
 #include <beast/cxx14/algorithm.h> // <algorithm>
 #include <beast/http/rfc2616.h>
@@ -210,9 +213,9 @@ ServerHandlerImp::processRequest (HTTP::Port const& port,
 {
     Json::Value jsonRPC;
     {
-        Json::Reader reader;
+        Json::Parser parser;
         if ((request.size () > 1000000) ||
-            ! reader.parse (request, jsonRPC) ||
+            ! parser.parse (request, jsonRPC) ||
             jsonRPC.isNull () ||
             ! jsonRPC.isObject ())
         {
@@ -285,13 +288,31 @@ ServerHandlerImp::processRequest (HTTP::Port const& port,
 
     m_journal.debug << "Query: " << strMethod << params;
 
-    Json::Value const result (rpcHandler.doRpcCommand (
-        strMethod, params, role, loadType));
-    m_journal.debug << "Reply: " << result;
+    // Commands that support it write their result straight into the
+    // response text, so large results are never held as a Json::Value.
+    Json::Value result;
+    bool written;
+    {
+        StringOutput output (response);
+        RPC::New::Writer writer (output);
+        RPC::New::Object::Root root (writer);
+        auto object = root.makeObject ("result");
+        written = rpcHandler.writeRpcCommand (
+            strMethod, params, role, loadType, object, result);
+    }
 
     usage.charge (loadType);
 
-    response = JSONRPCReply (result, Json::Value (), id);
+    if (written)
+    {
+        m_journal.debug << "Reply: " << response.size () << " bytes";
+        response += "\n";
+    }
+    else
+    {
+        m_journal.debug << "Reply: " << result;
+        response = JSONRPCReply (result, Json::Value (), id);
+    }
 
     return createResponse (200, response);
 }
@@ -61,6 +61,7 @@
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/AcceptedLedgerTx.h>
 #include <ripple/app/ledger/AcceptedLedger.h>
+#include <ripple/app/ledger/TxnDBWriter.h>
 #include <ripple/app/ledger/LedgerEntrySet.h>
 #include <ripple/app/ledger/DirectoryEntryIterator.h>
 #include <ripple/app/ledger/OrderBookIterator.h>
@@ -27,3 +27,4 @@
 #include <ripple/app/shamap/SHAMapSyncFilters.cpp>
 #include <ripple/app/ledger/LedgerCleaner.cpp>
 #include <ripple/app/ledger/LedgerMaster.cpp>
+#include <ripple/app/ledger/tests/LedgerReplay.test.cpp>
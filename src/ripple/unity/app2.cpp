@@ -38,3 +38,6 @@
 #include <ripple/app/shamap/RadixMapTest.h>
 #include <ripple/app/shamap/RadixMapTest.cpp>
 #include <ripple/app/shamap/FetchPackTests.cpp>
+#include <ripple/app/shamap/TreeNodeMemoryTests.cpp>
+#include <ripple/app/shamap/FlushTimingTests.cpp>
+#include <ripple/app/shamap/ReadTimingTests.cpp>
@@ -22,6 +22,7 @@
 #include <ripple/unity/app.h>
 
 #include <ripple/app/ledger/Ledger.cpp>
+#include <ripple/app/ledger/TxnDBWriter.cpp>
 #include <ripple/app/shamap/SHAMapDelta.cpp>
 #include <ripple/app/shamap/SHAMapNodeID.cpp>
 #include <ripple/app/shamap/SHAMapTreeNode.cpp>
@@ -25,4 +25,9 @@
 #include <ripple/app/ledger/LedgerHistory.cpp>
 #include <ripple/app/tx/TransactionAcquire.cpp>
 #include <ripple/app/tx/LocalTxs.cpp>
+#include <ripple/app/misc/SigVerifier.cpp>
+#include <ripple/app/misc/AccountTxPaging.cpp>
 #include <ripple/app/misc/NetworkOPs.cpp>
+
+#include <ripple/app/misc/tests/AccountTxPaging.test.cpp>
+#include <ripple/app/misc/tests/SigVerifier.test.cpp>
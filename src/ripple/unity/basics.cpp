@@ -23,6 +23,7 @@
 
 #include <BeastConfig.h>
 
+#include <ripple/basics/impl/AllocationCounter.cpp>
 #include <ripple/basics/impl/BasicConfig.cpp>
 #include <ripple/basics/impl/CheckLibraryVersions.cpp>
 #include <ripple/basics/impl/CountedObject.cpp>
@@ -25,3 +25,4 @@
 #include <ripple/core/impl/LoadMonitor.cpp>
 #include <ripple/core/impl/Job.cpp>
 #include <ripple/core/impl/JobQueue.cpp>
+#include <ripple/core/tests/JobQueue.test.cpp>
@@ -41,6 +41,7 @@
 #define JSON_ASSERT_MESSAGE( condition, message ) if (!( condition )) throw std::runtime_error( message );
 
 #include <ripple/json/impl/json_reader.cpp>
+#include <ripple/json/impl/json_parser.cpp>
 #include <ripple/json/impl/json_value.cpp>
 #include <ripple/json/impl/json_writer.cpp>
 #include <ripple/json/impl/to_string.cpp>
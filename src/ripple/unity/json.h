@@ -46,6 +46,7 @@
 #include <ripple/json/json_features.h>
 #include <ripple/json/json_value.h>
 #include <ripple/json/json_reader.h>
+#include <ripple/json/json_parser.h>
 #include <ripple/json/to_string.h>
 
 #include <ripple/json/JsonPropertyStream.h>
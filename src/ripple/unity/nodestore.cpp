@@ -35,6 +35,8 @@
 #include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
 #include <ripple/nodestore/impl/BatchWriter.h>
+#include <ripple/nodestore/backend/AppendLogFactory.h>
+#include <ripple/nodestore/backend/AppendLogFactory.cpp>
 #include <ripple/nodestore/backend/HyperDBFactory.h>
 #include <ripple/nodestore/backend/HyperDBFactory.cpp>
 #include <ripple/nodestore/backend/LevelDBFactory.h>
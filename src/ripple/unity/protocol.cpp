@@ -30,6 +30,8 @@
 #include <ripple/protocol/impl/LedgerFormats.cpp>
 #include <ripple/protocol/impl/RippleAddress.cpp>
 #include <ripple/protocol/impl/Serializer.cpp>
+#include <ripple/protocol/impl/SHA512Half.cpp>
+#include <ripple/protocol/impl/SHA512HalfBatch.cpp>
 #include <ripple/protocol/impl/SOTemplate.cpp>
 #include <ripple/protocol/impl/TER.cpp>
 #include <ripple/protocol/impl/TxFormats.cpp>
@@ -51,3 +53,6 @@
 
 // VFALCO Should be in a tests dir
 #include <ripple/protocol/impl/STAmount.test.cpp>
+#include <ripple/protocol/impl/SHA512Half.test.cpp>
+#include <ripple/protocol/impl/STObjectJson.test.cpp>
+#include <ripple/protocol/impl/JsonParser.test.cpp>
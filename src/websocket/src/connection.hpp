@@ -328,7 +328,21 @@ public:
         
         return m_write_buffer;
     }
-    
+
+    /// Get number of messages in the outgoing send queue
+    /**
+     * Visibility: public
+     * State: Valid from any state.
+     * Concurrency: callable from any thread
+     *
+     * @return The current number of messages waiting to be written.
+     */
+    size_t buffered_messages() const {
+        boost::lock_guard<boost::recursive_mutex> lock(m_lock);
+
+        return m_write_queue.size();
+    }
+
     /// Get library fail code
     /**
      * Returns the internal WS++ fail code. This code starts at a value of